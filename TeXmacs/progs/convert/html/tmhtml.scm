@@ -1861,7 +1861,15 @@
         (ahash-with tmhtml-env :preformatted #f
           (ahash-with tmhtml-env :left-margin 0
             (ahash-with tmhtml-env :right-margin 0
-              (tmhtml x))))))))
+              (tmhtml-with-snippets (lambda () (tmhtml x))))))))))
+
+(define (tmhtml-with-snippets thunk)
+  ;; typeset all formulas which are exported as images in a single batch
+  (if (or (not tmhtml-images?) (== tmhtml-image-root-string "image")) (thunk)
+      (dynamic-wind
+          (lambda () (begin-snippets))
+          thunk
+          (lambda () (end-snippets)))))
 
 (define (tmhtml x)
   ;; Main conversion function.
@@ -42,6 +42,11 @@
   (:check-mark "v" debug-get)
   (debug-set s (not (debug-get s))))
 
+(tm-define (debug-toggle-trace)
+  (:synopsis "Toggle the recording of a trace of the timings")
+  (:check-mark "v" trace-busy?)
+  (if (trace-busy?) (trace-stop) (trace-start)))
+
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; Memory
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -70,7 +75,15 @@
       ("History" (show-history))
       ("Memory usage" (show-meminfo)))
   (-> "Timings"
-      ("All" (bench-print-all)))
+      ("All" (bench-print-all))
+      ---
+      ("Record trace" (debug-toggle-trace))
+      ("Export trace" (choose-file trace-export "Export trace" ""))
+      ---
+      ("Key latencies" (display (latency-report)))
+      ("Reset key latencies" (latency-reset))
+      ("Record keys" (choose-file latency-record-start "Record keys" ""))
+      ("Stop recording keys" (latency-record-stop)))
   (-> "Memory"
       ("Memory usage" (show-meminfo))
       ("Collect garbage" (gc))
@@ -197,6 +197,8 @@
 (lazy-define (utils plugins plugin-cmd) pre-serialize verbatim-serialize)
 (lazy-define (utils test test-convert) delayed-quit
              build-manual build-ref-suite run-test-suite)
+(lazy-define (utils test test-latency) latency-replay)
+(lazy-define (utils test test-bench) bench-run)
 (use-modules (utils library smart-table))
 (use-modules (utils plugins plugin-convert))
 (use-modules (utils misc markup-funcs))
@@ -81,6 +81,22 @@
 "texmacs-memory"
 "bench-print"
 "bench-print-all"
+"bench-time"
+"bench-reset"
+"bench-reset-all"
+"trace-start"
+"trace-stop"
+"trace-busy?"
+"trace-export"
+"trace-summary"
+"latency-reset"
+"latency-count"
+"latency-percentile"
+"latency-histogram"
+"latency-bucket-limits"
+"latency-report"
+"latency-record-start"
+"latency-record-stop"
 "system-wait"
 "get-show-kbd"
 "set-show-kbd"
@@ -703,6 +719,9 @@
 "buffer-import"
 "buffer-load"
 "buffer-export"
+"buffer-autosave"
+"background-save-status"
+"background-save-wait"
 "buffer-save"
 "tree-import-loaded"
 "tree-import"
@@ -963,6 +982,7 @@
 "cell-del-format"
 "table-test"
 "key-press"
+"replay-key-press"
 "raw-emulate-keyboard"
 "complete-try?"
 "get-input-mode"
@@ -1107,6 +1127,9 @@
 "print"
 "print-pages"
 "print-snippet"
+"print-snippets"
+"begin-snippets"
+"end-snippets"
 "graphics-file-to-clipboard"
 "export-postscript"
 "export-pages-postscript"
@@ -362,11 +362,25 @@
        (== (most-recent-suffix name) "#")))
 
 (define (autosave-remove name)
+  (background-save-wait)
   (when (url-exists? (url-glue name "~"))
     (url-remove (url-glue name "~")))
   (when (url-exists? (url-glue name "#"))
     (url-remove (url-glue name "#"))))
 
+(define (autosave-report aname vname)
+  ;; the file is written in the background; report when it is done
+  (delayed
+    (:pause 250)
+    (with status (background-save-status aname)
+      (cond ((== status 1) (autosave-report aname vname))
+            ((== status -1)
+             (set-message `(concat "Failed to auto-save " ,vname)
+                          "Auto-save file"))
+            (else
+             (set-temporary-message `(concat "Auto-saved " ,vname)
+                                    "Auto-save file" 2500))))))
+
 (tm-define (autosave-buffer name)
   (when (and (buffer-modified-since-autosave? name)
              (url-autosave name "~"))
@@ -381,6 +395,13 @@
              (when (not (rescue-mode?))
                (set-message `(concat "Warning: " ,vname " not auto-saved")
                             "Auto-save file")))
+            ((and (== fm "texmacs") (not (rescue-mode?)))
+             (if (buffer-autosave name aname)
+                 (set-message `(concat "Failed to auto-save " ,vname)
+                              "Auto-save file")
+                 (begin
+                   (buffer-pretend-autosaved name)
+                   (autosave-report aname vname))))
             ((buffer-export name aname fm)
              (when (not (rescue-mode?))
                (set-message `(concat "Failed to auto-save " ,vname)
@@ -0,0 +1,113 @@
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;;
+;; MODULE      : test-bench.scm
+;; DESCRIPTION : benchmarks on the documentation and the examples
+;; COPYRIGHT   : (C) 2026  the TeXmacs team
+;;
+;; This software falls under the GNU general public license version 3 or later.
+;; It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+;; in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+;;
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+(texmacs-module (utils test test-bench)
+  (:use (texmacs texmacs tm-files)))
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; Results
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+;; Each result is a list (group name milliseconds); they are written in
+;; the same JSON format as the results of the benchmarks in misc/benchmark.
+
+(define bench-results '())
+
+(define (bench-quote s)
+  (string-append "\"" (string-replace (string-replace s "\\" "\\\\")
+                                      "\"" "\\\"") "\""))
+
+(define (bench-result->json r)
+  (string-append "{\"group\":" (bench-quote (car r))
+                 ",\"name\":" (bench-quote (cadr r))
+                 ",\"metric\":\"WalltimeMilliseconds\""
+                 ",\"value\":" (number->string (caddr r))
+                 ",\"iterations\":1}"))
+
+(define (bench-results->json)
+  ;; the trace points are appended, with the loading of fonts among others
+  (let* ((l (map bench-result->json (reverse bench-results)))
+         (t (trace-summary))
+         (n (string-length t)))
+    (if (> n 4) (set! l (append l (list (substring t 2 (- n 3))))))
+    (string-append "[\n" (string-recompose l ",\n") "\n]\n")))
+
+(define (bench-timed group name thunk)
+  (let* ((start (bench-time))
+         (r (thunk)))
+    (set! bench-results
+          (cons (list group name (- (bench-time) start)) bench-results))
+    r))
+
+(define (bench-safely group name thunk)
+  ;; a failing document should not abort the whole suite
+  (catch #t
+    (lambda () (bench-timed group name thunk))
+    (lambda args
+      (display* "TeXmacs] Benchmark " group " failed on " name "\n")
+      #f)))
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; Benchmarks on documents
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+(define (bench-documents dir)
+  (let* ((u1 (url-append dir (url-any)))
+         (u2 (url-expand (url-complete u1 "dr")))
+         (u3 (url-append u2 (url-wildcard "*.tm")))
+         (u4 (url-expand (url-complete u3 "fr"))))
+    (sort (map url->system (url->list u4)) string<=?)))
+
+(define (bench-name u)
+  (url->system (url-delta (url-append "$TEXMACS_PATH" "dummy") u)))
+
+(define (bench-typeset u pdf)
+  ;; load, typeset and print a document in an auxiliary buffer
+  (let* ((name (bench-name u))
+         (t (bench-safely "load" name (lambda () (tree-import u "texmacs"))))
+         (prev (current-buffer))
+         (aux "* Benchmark *"))
+    (when (tree? t)
+      (aux-set-document aux t)
+      (aux-set-master aux u)
+      (switch-to-buffer (aux-name aux))
+      (bench-safely "typeset" name
+                    (lambda () (update-current-buffer) (update-forced)))
+      (bench-safely "pdf-export" name (lambda () (print-to-file pdf)))
+      (if prev (switch-to-buffer prev)))
+    t))
+
+(define (bench-latex u t)
+  ;; round trip through LaTeX
+  (let* ((name (bench-name u))
+         (s (bench-safely "latex-export" name
+                          (lambda () (convert t "texmacs-tree"
+                                              "latex-document")))))
+    (when (string? s)
+      (bench-safely "latex-import" name
+                    (lambda () (convert s "latex-document" "texmacs-tree"))))))
+
+(tm-define (bench-run out)
+  (:synopsis "Run the benchmarks on the documents and save the results to @out")
+  (let* ((tmp (url-temp-dir))
+         (pdf (url-append tmp "bench.pdf"))
+         (docs (bench-documents (url-append "$TEXMACS_PATH" "doc")))
+         (examples (bench-documents (url-append "$TEXMACS_PATH" "examples"))))
+    (set! bench-results '())
+    (for (doc docs)
+      (bench-typeset (system->url doc) pdf))
+    (for (example examples)
+      (with t (bench-typeset (system->url example) pdf)
+        (if (tree? t) (bench-latex (system->url example) t))))
+    (string-save (bench-results->json)
+                 (if (url-rooted? out) out (url-append (getenv "PWD") out)))))
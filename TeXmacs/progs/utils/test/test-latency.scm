@@ -0,0 +1,56 @@
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;;
+;; MODULE      : test-latency.scm
+;; DESCRIPTION : replaying key scripts for measuring key press latencies
+;; COPYRIGHT   : (C) 2026  the TeXmacs team
+;;
+;; This software falls under the GNU general public license version 3 or later.
+;; It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+;; in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+;;
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+(texmacs-module (utils test test-latency)
+  (:use (texmacs texmacs tm-files)))
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; Key scripts
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+;; Each line of a key script holds the delay in milliseconds since the
+;; previous key, followed by the key, as recorded by latency-record-start.
+;; Empty lines and lines starting with ';' are ignored.  The delays are
+;; not reproduced: the keys are replayed as fast as possible.
+
+(define (script-line->key l)
+  (let* ((s (string-trim-spaces l))
+         (i (string-index s #\space)))
+    (cond ((or (== s "") (string-starts? s ";")) #f)
+          (i (string-trim-spaces (substring s i (string-length s))))
+          (else s))))
+
+(define (script-keys u)
+  (list-filter (map script-line->key (string-decompose (string-load u) "\n"))
+               (lambda (k) (and k (!= k "")))))
+
+(define (latency-url name)
+  (if (url-rooted? name) name
+      (url-append (getenv "PWD") name)))
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; Replaying key scripts
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+(tm-define (latency-replay doc script . opts)
+  (:synopsis "Replay the keys of @script on @doc and report the latencies")
+  (let* ((doc* (latency-url doc))
+         (keys (script-keys (latency-url script))))
+    (load-buffer doc* :strict)
+    (latency-reset)
+    (for (key keys)
+      (replay-key-press key))
+    (with r (latency-report)
+      (if (nnull? opts)
+          (string-save r (latency-url (car opts)))
+          (display r)))))
@@ -0,0 +1,60 @@
+
+/******************************************************************************
+* MODULE     : tm_convert_benchmark.cpp
+* DESCRIPTION: Benchmarks for parsing and serializing TeXmacs documents
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "convert.hpp"
+#include "file.hpp"
+
+class BenchTmConvert: public QObject {
+  Q_OBJECT
+
+  string source;
+  tree   doc;
+
+private slots:
+  void initTestCase ();
+  void bench_parse ();
+  void bench_serialize ();
+  void bench_scheme_serialize ();
+};
+
+void
+BenchTmConvert::initTestCase () {
+  // the largest document of the documentation, with many macros
+  url u ("$TEXMACS_PATH/doc/devel/scheme/api/glue-auto-doc.en.tm");
+  QVERIFY (!load_string (u, source, false));
+  doc= texmacs_document_to_tree (source);
+  QVERIFY (!is_func (doc, TMERROR));
+}
+
+void
+BenchTmConvert::bench_parse () {
+  tree t;
+  QBENCHMARK { t= texmacs_document_to_tree (source); }
+  QVERIFY (t == doc);
+}
+
+void
+BenchTmConvert::bench_serialize () {
+  string s;
+  QBENCHMARK { s= tree_to_texmacs (doc); }
+  QVERIFY (N(s) > N(source) / 2);
+}
+
+void
+BenchTmConvert::bench_scheme_serialize () {
+  string s;
+  QBENCHMARK { s= tree_to_scheme (doc); }
+  QVERIFY (N(s) > 0);
+}
+
+QTEST_MAIN(BenchTmConvert)
+#include "tm_convert_benchmark.moc"
@@ -0,0 +1,108 @@
+
+/******************************************************************************
+* MODULE     : analyze_benchmark.cpp
+* DESCRIPTION: Benchmarks for searching and replacing in strings
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "analyze.hpp"
+
+static string
+sample_text (int n) {
+  string line= "\\section{Introduction} Some text, with $x^2+y^2$ math; ";
+  string r;
+  while (N(r) < n) r << line;
+  return r;
+}
+
+class BenchAnalyze: public QObject {
+  Q_OBJECT
+
+  string text;
+
+private slots:
+  void initTestCase ();
+  void bench_search_forwards_short ();
+  void bench_search_forwards_long ();
+  void bench_search_forwards_multi ();
+  void bench_search_backwards ();
+  void bench_occurs_missing ();
+  void bench_count_occurrences ();
+  void bench_replace ();
+  void bench_tokenize ();
+};
+
+void
+BenchAnalyze::initTestCase () {
+  text= sample_text (1 << 20);
+}
+
+void
+BenchAnalyze::bench_search_forwards_short () {
+  int r= 0;
+  QBENCHMARK { r= search_forwards ("$", N(text) / 2, text); }
+  QVERIFY (r >= 0);
+}
+
+void
+BenchAnalyze::bench_search_forwards_long () {
+  string s= text * "\\end{document}";
+  DI r= 0;
+  QBENCHMARK { r= search_forwards ("\\end{document}", s); }
+  QCOMPARE (r, N(text));
+}
+
+void
+BenchAnalyze::bench_search_forwards_multi () {
+  string s= text * "\\begin{abstract}";
+  array<string> what;
+  what << string ("\\begin{abstract}") << string ("\\chapter")
+       << string ("\\part");
+  DI r= 0;
+  QBENCHMARK { r= search_forwards (what, 0, s); }
+  QCOMPARE (r, N(text));
+}
+
+void
+BenchAnalyze::bench_search_backwards () {
+  string s= "\\documentclass{article}" * text;
+  int r= 0;
+  QBENCHMARK { r= search_backwards ("\\documentclass", s); }
+  QCOMPARE (r, 0);
+}
+
+void
+BenchAnalyze::bench_occurs_missing () {
+  bool r= true;
+  QBENCHMARK { r= occurs ("\\subsubsection", text); }
+  QVERIFY (!r);
+}
+
+void
+BenchAnalyze::bench_count_occurrences () {
+  int r= 0;
+  QBENCHMARK { r= count_occurrences ("math", text); }
+  QVERIFY (r > 0);
+}
+
+void
+BenchAnalyze::bench_replace () {
+  string r;
+  QBENCHMARK { r= replace (text, "$", "\\$"); }
+  QVERIFY (N(r) > N(text));
+}
+
+void
+BenchAnalyze::bench_tokenize () {
+  array<string> r;
+  QBENCHMARK { r= tokenize (text, ";"); }
+  QVERIFY (N(r) > 1);
+}
+
+QTEST_MAIN(BenchAnalyze)
+#include "analyze_benchmark.moc"
@@ -0,0 +1,82 @@
+
+/******************************************************************************
+* MODULE     : glyph_shrink_benchmark.cpp
+* DESCRIPTION: Benchmarks for shrinking glyphs for anti-aliasing
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "bitmap_font.hpp"
+
+static glyph
+sample_glyph (int c, int size) {
+  // a rough letter shape with stems, bowls and some noise
+  int w= size/2 + (c * 7) % (size/2), h= size - (c % 5) * size / 16;
+  glyph gl (w, h, 0, (3 * h) / 4);
+  for (int j=0; j<h; j++)
+    for (int i=0; i<w; i++) {
+      int u= 2*i - w, v= 2*j - h;
+      bool stem= (i < w/6) || ((c & 1) && i > w - w/6);
+      bool bowl= (c & 2) && abs (u*u + v*v - w*w/2) < w*w/6;
+      bool bar = (c & 4) && abs (v) < h/12;
+      bool dust= ((i * 31 + j * 17 + c) % 97) == 0;
+      if (stem || bowl || bar || dust) gl->set_1 (i, j, 1);
+    }
+  return gl;
+}
+
+static array<glyph>
+sample_font (int size) {
+  array<glyph> a;
+  for (int c=0; c<256; c++) a << sample_glyph (c, size);
+  return a;
+}
+
+class BenchGlyphShrink: public QObject {
+  Q_OBJECT
+
+  array<glyph> font;
+
+  void shrink_font (int factor);
+
+private slots:
+  void initTestCase ();
+  void bench_shrink_2 ();
+  void bench_shrink_3 ();
+  void bench_shrink_4 ();
+  void bench_shrink_5 ();
+  void bench_shrink_8 ();
+};
+
+void
+BenchGlyphShrink::initTestCase () {
+  // glyphs rendered at 600 dpi for a 10pt font
+  font= sample_font (84);
+}
+
+void
+BenchGlyphShrink::shrink_font (int factor) {
+  int total= 0;
+  QBENCHMARK {
+    total= 0;
+    for (int c=0; c<N(font); c++) {
+      SI xo, yo;
+      glyph gl= shrink (font[c], factor, factor, xo, yo, 1.0);
+      total += gl->width * gl->height;
+    }
+  }
+  QVERIFY (total > 0);
+}
+
+void BenchGlyphShrink::bench_shrink_2 () { shrink_font (2); }
+void BenchGlyphShrink::bench_shrink_3 () { shrink_font (3); }
+void BenchGlyphShrink::bench_shrink_4 () { shrink_font (4); }
+void BenchGlyphShrink::bench_shrink_5 () { shrink_font (5); }
+void BenchGlyphShrink::bench_shrink_8 () { shrink_font (8); }
+
+QTEST_MAIN(BenchGlyphShrink)
+#include "glyph_shrink_benchmark.moc"
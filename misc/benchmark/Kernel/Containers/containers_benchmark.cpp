@@ -0,0 +1,154 @@
+
+/******************************************************************************
+* MODULE     : containers_benchmark.cpp
+* DESCRIPTION: Benchmarks for hashmaps, arrays and strings
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "hashmap.hpp"
+#include "iterator.hpp"
+#include "merge_sort.hpp"
+
+static array<string>
+sample_keys (int n) {
+  // tag names and environment variables, as found in documents
+  array<string> a;
+  for (int i=0; i<n; i++)
+    a << (string ("key-") * as_string ((i * 7919) % 100003));
+  return a;
+}
+
+class BenchContainers: public QObject {
+  Q_OBJECT
+
+  array<string> keys;
+
+private slots:
+  void initTestCase ();
+  void bench_hashmap_insert ();
+  void bench_hashmap_lookup ();
+  void bench_hashmap_iterate ();
+  void bench_array_append ();
+  void bench_array_access ();
+  void bench_array_sort ();
+  void bench_string_append ();
+  void bench_string_compare ();
+  void bench_string_as_string ();
+};
+
+void
+BenchContainers::initTestCase () {
+  keys= sample_keys (10000);
+}
+
+void
+BenchContainers::bench_hashmap_insert () {
+  DI n= 0;
+  QBENCHMARK {
+    hashmap<string,int> h (0);
+    for (int i=0; i<N(keys); i++) h (keys[i])= i;
+    n= N(h);
+  }
+  QCOMPARE (n, N(keys));
+}
+
+void
+BenchContainers::bench_hashmap_lookup () {
+  hashmap<string,int> h (-1);
+  for (int i=0; i<N(keys); i++) h (keys[i])= i;
+  DI found= 0;
+  QBENCHMARK {
+    found= 0;
+    for (int i=0; i<N(keys); i++)
+      if (h->contains (keys[i]) && h[keys[i]] == i) found++;
+  }
+  QCOMPARE (found, N(keys));
+}
+
+void
+BenchContainers::bench_hashmap_iterate () {
+  hashmap<string,int> h (0);
+  for (int i=0; i<N(keys); i++) h (keys[i])= i;
+  DI n= 0;
+  QBENCHMARK {
+    n= 0;
+    iterator<string> it= iterate (h);
+    while (it->busy ()) { it->next (); n++; }
+  }
+  QCOMPARE (n, N(keys));
+}
+
+void
+BenchContainers::bench_array_append () {
+  int n= 0;
+  QBENCHMARK {
+    array<int> a;
+    for (int i=0; i<100000; i++) a << i;
+    n= N(a);
+  }
+  QCOMPARE (n, 100000);
+}
+
+void
+BenchContainers::bench_array_access () {
+  array<int> a (100000);
+  for (int i=0; i<N(a); i++) a[i]= i;
+  long long sum= 0;
+  QBENCHMARK {
+    sum= 0;
+    for (int i=0; i<N(a); i++) sum += a[i];
+  }
+  QCOMPARE (sum, 4999950000LL);
+}
+
+void
+BenchContainers::bench_array_sort () {
+  array<string> a;
+  QBENCHMARK {
+    a= copy (keys);
+    merge_sort (a);
+  }
+  for (int i=1; i<N(a); i++) QVERIFY (a[i-1] <= a[i]);
+}
+
+void
+BenchContainers::bench_string_append () {
+  int n= 0;
+  QBENCHMARK {
+    string s;
+    for (int i=0; i<N(keys); i++) s << keys[i] << ' ';
+    n= N(s);
+  }
+  QVERIFY (n > N(keys));
+}
+
+void
+BenchContainers::bench_string_compare () {
+  array<string> other;
+  for (int i=0; i<N(keys); i++) other << copy (keys[i]);
+  DI same= 0;
+  QBENCHMARK {
+    same= 0;
+    for (int i=0; i<N(keys); i++)
+      if (keys[i] == other[i] && !(keys[i] < other[i])) same++;
+  }
+  QCOMPARE (same, N(keys));
+}
+
+void
+BenchContainers::bench_string_as_string () {
+  int n= 0;
+  QBENCHMARK {
+    n= 0;
+    for (int i=0; i<N(keys); i++) n += N(as_string (i * 31));
+  }
+  QVERIFY (n > 0);
+}
+
+QTEST_MAIN(BenchContainers)
+#include "containers_benchmark.moc"
@@ -0,0 +1,74 @@
+
+/******************************************************************************
+* MODULE     : tfm_benchmark.cpp
+* DESCRIPTION: Benchmarks for loading TeX font metrics
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "load_tfm.hpp"
+#include "file.hpp"
+#include "analyze.hpp"
+
+class BenchTfm: public QObject {
+  Q_OBJECT
+
+  url dir;
+  array<string> names;
+
+private slots:
+  void initTestCase ();
+  void bench_load_tfm ();
+  void bench_execute ();
+};
+
+void
+BenchTfm::initTestCase () {
+  // the metrics of the European Computer Modern fonts shipped with TeXmacs
+  dir= url ("$TEXMACS_PATH/fonts/tfm/ec");
+  bool error_flag= false;
+  array<string> a= read_directory (dir, error_flag);
+  QVERIFY (!error_flag);
+  for (int i=0; i<N(a); i++)
+    if (ends (a[i], ".tfm")) names << a[i];
+  QVERIFY (N(names) > 0);
+}
+
+void
+BenchTfm::bench_load_tfm () {
+  int n= 0;
+  QBENCHMARK {
+    n= 0;
+    for (int i=0; i<N(names); i++) {
+      string family= names[i] (0, N(names[i]) - 4);
+      tex_font_metric tfm= load_tfm (dir * names[i], family, 10);
+      n += tfm->ec + 1 - tfm->bc;
+      tm_delete (tfm.rep);
+    }
+  }
+  QVERIFY (n > 0);
+}
+
+void
+BenchTfm::bench_execute () {
+  // ligatures and kerning for a paragraph of text
+  tex_font_metric tfm= load_tfm (dir * "ecrm10.tfm", "ecrm", 10);
+  string s= "Office ``affluence'' --- AVAW, fjord; To Ty Yo. ";
+  while (N(s) < 1000) s << s;
+  int n= N(s), m= 0;
+  array<int> str (n), buf (2*n + 32), ker (2*n + 32);
+  for (int i=0; i<n; i++) str[i]= (int) (unsigned char) s[i];
+  QBENCHMARK {
+    m= N(buf);
+    tfm->execute (A(str), n, A(buf), A(ker), m);
+  }
+  QVERIFY (m > 0 && m <= n);
+  tm_delete (tfm.rep);
+}
+
+QTEST_MAIN(BenchTfm)
+#include "tfm_benchmark.moc"
@@ -0,0 +1,117 @@
+
+###############################################################################
+#
+# MODULE      : texmacs_bench.cmake
+# DESCRIPTION : Run the benchmarks and collect their results in JSON format
+# COPYRIGHT   : (C) 2026  the TeXmacs team
+#
+# This software falls under the GNU general public license version 3 or later.
+# It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+# in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+#
+###############################################################################
+
+# Invoked by the texmacs_bench target (see CMakeLists.txt) as
+#   cmake -DBENCH_NAMES=a|b|... -DBENCH_DIR=... -DBENCH_WORK=...
+#         -DBENCH_SYSTEM=... -DTEXMACS_BINARY=... -DTEXMACS_PATH=...
+#         -DTEXMACS_VERSION=... -DOUTPUT=... -P texmacs_bench.cmake
+#
+# Each result is an object with the fields group, name, metric, value and
+# iterations, where value is the cost of a single iteration.  The micro
+# benchmarks are the QtTest benchmarks in this directory; the macro
+# benchmarks are run by 'texmacs -bench' (see utils/test/test-bench.scm).
+# TeXmacs is started with an empty home directory, so that the results
+# do not depend on the preferences and the caches of the user.
+
+cmake_minimum_required (VERSION 3.13)
+
+set (ENV{TEXMACS_PATH} ${TEXMACS_PATH})
+set (ENV{TEXMACS_HOME_PATH} ${BENCH_WORK}/home)
+file (REMOVE_RECURSE ${BENCH_WORK})
+file (MAKE_DIRECTORY ${BENCH_WORK}/home)
+
+set (_results "")
+set (_failures 0)
+
+function (bench_append _entry)
+  if (_results STREQUAL "")
+    set (_results "${_entry}" PARENT_SCOPE)
+  else ()
+    set (_results "${_results},\n${_entry}" PARENT_SCOPE)
+  endif ()
+endfunction ()
+
+### --------------------------------------------------------------------
+### Micro benchmarks: convert the XML output of QtTest
+### --------------------------------------------------------------------
+
+string (REPLACE "|" ";" BENCH_NAMES "${BENCH_NAMES}")
+foreach (_name ${BENCH_NAMES})
+  message (STATUS "Running ${_name}")
+  set (_xml ${BENCH_WORK}/${_name}.xml)
+  execute_process (
+    COMMAND ${BENCH_DIR}/${_name} -o ${_xml},xml
+    WORKING_DIRECTORY ${BENCH_WORK}
+    RESULT_VARIABLE _status
+  )
+  if (NOT _status EQUAL 0)
+    message (WARNING "${_name} failed (${_status})")
+    math (EXPR _failures "${_failures} + 1")
+  endif ()
+  if (EXISTS ${_xml})
+    file (STRINGS ${_xml} _lines)
+    set (_function "")
+    foreach (_line ${_lines})
+      if (_line MATCHES "<TestFunction name=\"([^\"]*)\"")
+        set (_function ${CMAKE_MATCH_1})
+      elseif (_line MATCHES "<BenchmarkResult metric=\"([^\"]*)\" tag=\"([^\"]*)\" value=\"([^\"]*)\" iterations=\"([^\"]*)\"")
+        set (_metric ${CMAKE_MATCH_1})
+        set (_tag "${CMAKE_MATCH_2}")
+        set (_value ${CMAKE_MATCH_3})
+        set (_iterations ${CMAKE_MATCH_4})
+        set (_test ${_function})
+        if (NOT _tag STREQUAL "")
+          set (_test "${_function}:${_tag}")
+        endif ()
+        bench_append ("{\"group\":\"${_name}\",\"name\":\"${_test}\",\"metric\":\"${_metric}\",\"value\":${_value},\"iterations\":${_iterations}}")
+      endif ()
+    endforeach ()
+  endif ()
+endforeach ()
+
+### --------------------------------------------------------------------
+### Macro benchmarks: typesetting, exports and imports of documents
+### --------------------------------------------------------------------
+
+message (STATUS "Running ${TEXMACS_BINARY} -bench")
+set (_json ${BENCH_WORK}/documents.json)
+execute_process (
+  COMMAND ${TEXMACS_BINARY} -bench ${_json}
+  WORKING_DIRECTORY ${BENCH_WORK}
+  RESULT_VARIABLE _status
+)
+if (EXISTS ${_json})
+  file (READ ${_json} _documents)
+  string (REGEX REPLACE "^\\[\n" "" _documents "${_documents}")
+  string (REGEX REPLACE "\n\\]\n$" "" _documents "${_documents}")
+  if (NOT _documents STREQUAL "")
+    bench_append ("${_documents}")
+  endif ()
+else ()
+  message (WARNING "texmacs -bench failed (${_status})")
+  math (EXPR _failures "${_failures} + 1")
+endif ()
+
+### --------------------------------------------------------------------
+### Output
+### --------------------------------------------------------------------
+
+string (TIMESTAMP _date "%Y-%m-%dT%H:%M:%SZ" UTC)
+file (WRITE ${OUTPUT}
+  "{\"suite\":\"texmacs_bench\",\"version\":\"${TEXMACS_VERSION}\",\n"
+  "\"system\":\"${BENCH_SYSTEM}\",\"date\":\"${_date}\",\n"
+  "\"results\":[\n${_results}\n]}\n")
+message (STATUS "Benchmark results written to ${OUTPUT}")
+if (_failures GREATER 0)
+  message (FATAL_ERROR "${_failures} benchmark(s) failed")
+endif ()
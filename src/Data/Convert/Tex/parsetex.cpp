@@ -12,6 +12,7 @@
 #include "Tex/convert_tex.hpp"
 #include "converter.hpp"
 #include "wencoding.hpp"
+#include "string_scan.hpp"
 
 extern bool textm_class_flag;
 
@@ -142,6 +143,22 @@ test_macro (string s, int i, string name) {
     (N(s) == i + N(name) || !is_tex_alpha (s[i+N(name)]));
 }
 
+static bool
+test_macro (string s, int i, array<string> names) {
+  // Equivalent to a disjunction of test_macro over all names,
+  // but the spaces are only skipped once
+  int n= N(s);
+  while (i < n && s[i] == ' ') i++;
+  if (i + 1 >= n) return false;
+  for (int j=0; j<N(names); j++) {
+    int k= N(names[j]);
+    if (names[j][1] == s[i+1] && test (s, i, names[j]) &&
+        (n == i + k || !is_tex_alpha (s[i+k])))
+      return true;
+  }
+  return false;
+}
+
 bool
 test_env (string s, int i, string name, bool end= false) {
   string tok= end? "\\end":"\\begin";
@@ -1683,9 +1700,23 @@ latex_parser::parse (string s, int change) {
 
   // We first cut the string into pieces at strategic places
   // This reduces the risk that the parser gets confused
+  static array<string> sectional;
+  static array<string> inclusions;
+  if (N(sectional) == 0) {
+    sectional << string ("\\part") << string ("\\chapter")
+               << string ("\\section") << string ("\\subsection")
+               << string ("\\subsubsection") << string ("\\paragraph")
+               << string ("\\subparagraph") << string ("\\nextbib")
+               << string ("\\newcommand") << string ("\\def");
+    inclusions << string ("\\input") << string ("\\include")
+               << string ("\\includeonly") << string ("\\usepackage");
+  }
   array<string> a;
   int i, start=0, cut=0, n= N(s), count= 0;
-  for (i=0; i<n; i++)
+  for (i=0; i<n; i++) {
+    // only newlines, backslashes and braces are of interest here
+    i= find_chars (as_buffer (s), n, i, "\n\\{}", 4);
+    if (i < 0) { i= n; break; }
     if (s[i]=='\n' || (s[i] == '\\' && test (s, i, "\\nextbib"))) {
       while ((i<n) && is_space (s[i])) i++;
       if (test (s, i, "%%%%%%%%%% Start TeXmacs macros\n")) {
@@ -1698,16 +1729,7 @@ latex_parser::parse (string s, int change) {
       else if (test_macro (s, i, "\\nextbib") || (count == 0 &&
                 (test_env   (s, i, "document")        ||
                  test_env   (s, i, "abstract")        ||
-                 test_macro (s, i, "\\part")          ||
-                 test_macro (s, i, "\\chapter")       ||
-                 test_macro (s, i, "\\section")       ||
-                 test_macro (s, i, "\\subsection")    ||
-                 test_macro (s, i, "\\subsubsection") ||
-                 test_macro (s, i, "\\paragraph")     ||
-                 test_macro (s, i, "\\subparagraph")  ||
-                 test_macro (s, i, "\\nextbib")       ||
-                 test_macro (s, i, "\\newcommand")    ||
-                 test_macro (s, i, "\\def")))) {
+                 test_macro (s, i, sectional)))) {
         a << s (start, i);
         start= i;
         while (i < n && test_macro (s, i, "\\nextbib")) {
@@ -1716,10 +1738,7 @@ latex_parser::parse (string s, int change) {
           start= i;
         }
       }
-      else if (test_macro (s, i, "\\input")       ||
-               test_macro (s, i, "\\include")     ||
-               test_macro (s, i, "\\includeonly") ||
-               test_macro (s, i, "\\usepackage")) {
+      else if (test_macro (s, i, inclusions)) {
         cut= i;
         string suffix= ".tex";
         if (test_macro (s, i, "\\usepackage")) suffix= ".sty";
@@ -1753,6 +1772,7 @@ latex_parser::parse (string s, int change) {
       count++;
     else if ((i == 0 || s[i-1] != '\\') && s[i] == '}')
       count--;
+  }
   a << s (start, i);
 
   // We now parse each of the pieces
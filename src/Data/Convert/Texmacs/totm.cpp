@@ -14,10 +14,21 @@
 
 /******************************************************************************
 * Conversion of TeXmacs trees to the present TeXmacs string format
+*******************************************************************************
+* The output is streamed: only the tail of the current line is kept in buf,
+* since cr may still have to escape its trailing spaces and br has to know
+* whether the line is empty.  Complete lines are passed on to the output
+* stream as soon as they are finished, and very long lines are passed on
+* by pieces.  Pending tokens in tmp are not split, since write_return may
+* still insert a line before them.
 ******************************************************************************/
 
+#define TM_WRITER_CHUNK 16384
+
 struct tm_writer {
-  string  buf;       // the resulting string
+  tm_ostream out;    // where the result is written to
+  string  buf;       // not yet written part of the current line
+  bool    blank;     // written part of the current line only has spaces
   string  spc;       // "" or " "
   string  tmp;       // not yet flushed characters
   int     mode;      // normal: 0, verbatim: 1, mathematics: 2
@@ -27,12 +38,15 @@ struct tm_writer {
   bool    spc_flag;  // true if last printed character was a space or CR
   bool    ret_flag;  // true if last printed character was a CR
 
-  tm_writer ():
-    buf (""), spc (""), tmp (""), mode (0),
+  tm_writer (tm_ostream out2):
+    out (out2), buf (""), blank (true), spc (""), tmp (""), mode (0),
     tab (0), xpos (0), spc_flag (true), ret_flag (true) {}
 
+  void emit (int n);
+  void ship ();
   void cr ();
   void flush ();
+  void finish ();
   void write_space ();
   void write_return ();
   void write (string s, bool flag= true, bool encode_space= false);
@@ -42,6 +56,28 @@ struct tm_writer {
   void write (tree t);
 };
 
+void
+tm_writer::emit (int n) {
+  // write the first n characters of buf to the output stream
+  if (n <= 0) return;
+  for (int i=0; i<n; i++)
+    if (buf[i] == '\n') blank= true;
+    else if (buf[i] != ' ') blank= false;
+  out->write (&buf[0], n);
+  buf= buf (n, N(buf));
+}
+
+void
+tm_writer::ship () {
+  // write buf except for the trailing spaces which cr may have to escape,
+  // together with the two characters which precede them
+  int i, n= N(buf);
+  for (i=n-1; i>=0; i--)
+    if ((buf[i] != ' ') || ((i>0) && (buf[i-1] == '\\')))
+      break;
+  emit (i-1);
+}
+
 void
 tm_writer::cr () {
   int i, n= N(buf);
@@ -54,6 +90,7 @@ tm_writer::cr () {
     for (i=0; i<n; i++) buf << "\\ ";
   }
   buf << '\n';
+  emit (N(buf));
   for (i=0; i<min(tab,20); i++) buf << ' ';
   xpos= min(tab,20);
 }
@@ -105,6 +142,14 @@ tm_writer::flush () {
   }
   spc= "";
   tmp= "";
+  if (N(buf) >= TM_WRITER_CHUNK) ship ();
+}
+
+void
+tm_writer::finish () {
+  flush ();
+  emit (N(buf));
+  out->flush ();
 }
 
 void
@@ -177,12 +222,12 @@ tm_writer::br (int indent) {
   tab += indent;
   for (i=N(buf)-1; i>=0; i--) {
     if (buf[i] == '\n') return;
-    if (buf[i] != ' ') {
-      cr ();
-      spc_flag= true;
-      ret_flag= false;
-      return;
-    }
+    if (buf[i] != ' ') break;
+  }
+  if (i >= 0 || !blank) {
+    cr ();
+    spc_flag= true;
+    ret_flag= false;
   }
 }
 
@@ -316,24 +361,32 @@ tm_writer::write (tree t) {
 * Conversion of TeXmacs trees to TeXmacs strings
 ******************************************************************************/
 
+static tree
+texmacs_normalize_style (tree t) {
+  if (is_snippet (t)) return t;
+  int i, n= N(t);
+  tree r (t, n);
+  for (i=0; i<n; i++)
+    if (is_compound (t[i], "style", 1)) {
+      tree style= t[i][0];
+      if (is_func (style, TUPLE, 1)) style= style[0];
+      r[i]= copy (t[i]);
+      r[i][0]= style;
+    }
+    else r[i]= t[i];
+  return r;
+}
+
+void
+tree_to_texmacs (tree t, tm_ostream out) {
+  tm_writer tmw (out);
+  tmw.write (texmacs_normalize_style (t));
+  tmw.finish ();
+}
+
 string
 tree_to_texmacs (tree t) {
-  if (!is_snippet (t)) {
-    int i, n= N(t);
-    tree r (t, n);
-    for (i=0; i<n; i++)
-      if (is_compound (t[i], "style", 1)) {
-        tree style= t[i][0];
-        if (is_func (style, TUPLE, 1)) style= style[0];
-        r[i]= copy (t[i]);
-        r[i][0]= style;
-      }
-      else r[i]= t[i];
-    t= r;
-  }
-
-  tm_writer tmw;
-  tmw.write (t);
-  tmw.flush ();
-  return tmw.buf;
+  string r;
+  tree_to_texmacs (t, string_ostream (r));
+  return r;
 }
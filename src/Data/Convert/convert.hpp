@@ -40,6 +40,7 @@ scheme_tree compute_index (url u);
 tree   texmacs_to_tree (string s);
 tree   texmacs_document_to_tree (string s);
 string tree_to_texmacs (tree t);
+void   tree_to_texmacs (tree t, tm_ostream out);
 tree   extract (tree doc, string attr);
 tree   extract_document (tree doc);
 tree   change_doc_attr (tree doc, string attr, tree val);
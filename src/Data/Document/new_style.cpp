@@ -13,6 +13,8 @@
 #include "file.hpp"
 #include "data_cache.hpp"
 #include "convert.hpp"
+#include "iterator.hpp"
+#include "tm_configure.hpp"
 #include "../../Typeset/env.hpp"
 
 /******************************************************************************
@@ -27,6 +29,7 @@ struct style_data_rep {
   drd_info drd_void;
   hashmap<tree,hashmap<string,tree> > style_cached;
   hashmap<tree,drd_info> drd_cached;
+  hashmap<tree,tree> style_deps;
 
   style_data_rep ():
     style_cache (hashmap<string,tree> (UNINIT)),
@@ -35,7 +38,8 @@ struct style_data_rep {
     style_void (UNINIT),
     drd_void ("void"),
     style_cached (style_void),
-    drd_cached (drd_void) {}
+    drd_cached (drd_void),
+    style_deps (tree (TUPLE)) {}
 };
 
 static style_data_rep* sd= NULL;
@@ -46,6 +50,8 @@ init_style_data () {
 }
 
 extern hashmap<string,tree> style_tree_cache;
+extern hashmap<string,string> style_tree_hash;
+string style_package_hash (string package);
 hashmap<string,bool> hidden_packages (false);
 
 /******************************************************************************
@@ -73,6 +79,53 @@ preprocess_style (tree st, url name) {
   return r;
 }
 
+/******************************************************************************
+* Style packages on which a style depends
+*******************************************************************************
+* While computing the environment of a style, we record the style packages
+* which are loaded, together with a hash of their contents.  These hashes
+* are saved along with the environment in the cache on disk, so that the
+* cached environment can be reused by any document with the same style,
+* for as long as none of the underlying packages changed.
+******************************************************************************/
+
+static bool style_recording= false;
+static hashmap<string,string> style_recorded ("");
+
+void
+style_note_package (string package, string h) {
+  if (style_recording) style_recorded (package)= h;
+}
+
+static tree
+recorded_dependencies () {
+  tree deps (TUPLE);
+  iterator<string> it= iterate (style_recorded);
+  while (it->busy ()) {
+    string package= it->next ();
+    deps << tree (TUPLE, package, style_recorded [package]);
+  }
+  return deps;
+}
+
+static bool
+valid_dependencies (tree deps) {
+  if (!is_tuple (deps)) return false;
+  for (int i=0; i<N(deps); i++) {
+    if (!is_tuple (deps[i]) || N(deps[i]) != 2 ||
+        !is_atomic (deps[i][0]) || !is_atomic (deps[i][1])) return false;
+    if (style_package_hash (deps[i][0]->label) != deps[i][1]->label)
+      return false;
+  }
+  return true;
+}
+
+static void
+note_dependencies (tree deps) {
+  for (int i=0; i<N(deps); i++)
+    style_note_package (deps[i][0]->label, deps[i][1]->label);
+}
+
 /******************************************************************************
 * Caching style files on disk
 ******************************************************************************/
@@ -99,6 +152,7 @@ cache_file_name (tree t) {
 void
 style_invalidate_cache () {
   style_tree_cache= hashmap<string,tree> ();
+  style_tree_hash= hashmap<string,string> ("");
   hidden_packages= hashmap<string,bool> (false);
   if (sd != NULL) {
     tm_delete<style_data_rep> (sd);
@@ -109,16 +163,19 @@ style_invalidate_cache () {
 }
 
 void
-style_set_cache (tree style, hashmap<string,tree> H, tree t) {
+style_set_cache (tree style, hashmap<string,tree> H, tree t, tree deps) {
   init_style_data ();
   // cout << "set cache " << style << LF;
+  // styles computed while busy do not record any packages and are not
+  // complete, so that they should not be cached
+  if (!is_tuple (deps) || N(deps) == 0) return;
   sd->style_cache (copy (style))= H;
   sd->style_drd   (copy (style))= t;
+  sd->style_deps  (copy (style))= deps;
   url name ("$TEXMACS_HOME_PATH/system/cache", cache_file_name (style));
-  if (!exists (name)) {
-    save_string (name, tree_to_scheme (tuple ((tree) H, t)));
-    // cout << "saved " << name << LF;
-  }
+  tree p= tuple (TEXMACS_VERSION, (tree) H, t, deps);
+  save_string (name, tree_to_scheme (p));
+  // cout << "saved " << name << LF;
 }
 
 void
@@ -130,6 +187,7 @@ style_get_cache (tree style, hashmap<string,tree>& H, tree& t, bool& f) {
   if (f) {
     H= sd->style_cache [style];
     t= sd->style_drd   [style];
+    note_dependencies (sd->style_deps [style]);
   }
   else {
     string s;
@@ -137,11 +195,16 @@ style_get_cache (tree style, hashmap<string,tree>& H, tree& t, bool& f) {
     if (exists (name) && (!load_string (name, s, false))) {
       //cout << "loaded " << name << LF;
       tree p= scheme_to_tree (s);
-      H= hashmap<string,tree> (UNINIT, p[0]);
-      t= p[1];
-      sd->style_cache (copy (style))= H;
-      sd->style_drd   (copy (style))= t;
-      f= true;
+      if (is_tuple (p) && N(p) == 4 && p[0] == TEXMACS_VERSION &&
+          valid_dependencies (p[3])) {
+        H= hashmap<string,tree> (UNINIT, p[1]);
+        t= p[2];
+        sd->style_cache (copy (style))= H;
+        sd->style_drd   (copy (style))= t;
+        sd->style_deps  (copy (style))= p[3];
+        note_dependencies (p[3]);
+        f= true;
+      }
     }
   }
 }
@@ -182,9 +245,17 @@ compute_env_and_drd (tree style) {
       drd->set_environment (H);
     }
     if (!ok) {
+      bool old_recording= style_recording;
+      hashmap<string,string> old_recorded= style_recorded;
+      style_recording= true;
+      style_recorded= hashmap<string,string> ("");
       env->exec (tree (USE_PACKAGE, A (style)));
       env->read_env (H);
       drd->heuristic_init (H);
+      sd->style_deps (copy (style))= recorded_dependencies ();
+      if (old_recording) old_recorded->join (style_recorded);
+      style_recorded= old_recorded;
+      style_recording= old_recording;
     }
     sd->style_cached (style)= H;
     sd->drd_cached (style)= drd;
@@ -209,6 +280,12 @@ get_style_env (tree style) {
   }
 }
 
+tree
+get_style_deps (tree style) {
+  init_style_data ();
+  return sd->style_deps [style];
+}
+
 drd_info
 get_style_drd (tree style) {
   //cout << "get_style_drd " << style << "\n";
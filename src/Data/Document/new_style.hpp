@@ -17,12 +17,14 @@
 tree preprocess_style (tree st, url name);
 
 void style_invalidate_cache ();
-void style_set_cache (tree style, hashmap<string,tree> H, tree t);
+void style_set_cache (tree style, hashmap<string,tree> H, tree t, tree deps);
 void style_get_cache (tree style, hashmap<string,tree>& H, tree& t, bool& f);
+void style_note_package (string package, string h);
 
 bool compute_env_and_drd (tree style);
 hashmap<string,tree> get_style_env (tree style);
 drd_info get_style_drd (tree style);
+tree get_style_deps (tree style);
 tree get_document_preamble (tree t);
 drd_info get_document_drd (tree doc);
 
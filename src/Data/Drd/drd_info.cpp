@@ -21,9 +21,13 @@
 ******************************************************************************/
 
 drd_info_rep::drd_info_rep (string name2):
-  name (name2), info (tag_info ()), env (UNINIT) {}
+  name (name2), info (tag_info ()), env (UNINIT),
+  parent (NULL), generation (0) {}
 drd_info_rep::drd_info_rep (string name2, drd_info base):
-  name (name2), info (tag_info (), base->info), env (UNINIT) {}
+  name (name2), info (tag_info (), base->info), env (UNINIT),
+  parent (base.operator -> ()), generation (0) { INC_COUNT (parent); }
+drd_info_rep::~drd_info_rep () {
+  if (parent != NULL) DEC_COUNT (parent); }
 drd_info::drd_info (string name):
   rep (tm_new<drd_info_rep> (name)) {}
 drd_info::drd_info (string name, drd_info base):
@@ -48,7 +52,7 @@ drd_info_rep::set_locals (tree t) {
   int i, n= N(t);
   for (i=0; i<n; i++)
     if (is_func (t[i], ASSOCIATE, 2) && is_atomic (t[i][0]))
-      info (make_tree_label (t[i][0]->label))= tag_info (t[i][1]);
+      modify (make_tree_label (t[i][0]->label))= tag_info (t[i][1]);
   return true;
 }
 
@@ -62,33 +66,84 @@ operator << (tm_ostream& out, drd_info drd) {
   return out << "drd [" << drd->name << "]";
 }
 
+/******************************************************************************
+* Flattened access to the tag information
+*******************************************************************************
+* The tag information of a drd is spread over the layers of a relative
+* hashmap, which all have to be searched for each query.  We therefore
+* keep a dense table with the resolved information for each tree label.
+* Each modification of a drd increases its generation; since drds derived
+* from a modified drd share its layers, an entry is only valid as long as
+* the sum of the generations of the drd and of its ancestors is unchanged.
+******************************************************************************/
+
+tag_info_rep*
+drd_info_rep::resolve (tree_label l) {
+  int i, n= N(dense);
+  if (((int) l) >= n) {
+    int m= max (max (((int) l) + 1, 2*n), (int) START_EXTENSIONS);
+    dense->resize (m);
+    dense_stamp->resize (m);
+    for (i=n; i<m; i++) dense_stamp[i]= -1;
+  }
+  dense[l]= info[l];
+  dense_stamp[l]= stamp ();
+  return dense[l].operator -> ();
+}
+
+tag_info_rep*
+drd_info_rep::lookup (tree t) {
+  if (is_func (t, EXTERN) && N(t)>0 && is_atomic (t[0])) {
+    tree_label lab= make_tree_label ("extern:" * t[0]->label);
+    if (!info->contains (lab)) {
+      // only the new label changes, so that EXTERN is accessed
+      // without invalidating the table
+      tag_info ti= local (EXTERN);
+      modify (lab)= ti;
+    }
+    return lookup (lab);
+  }
+  return lookup (L(t));
+}
+
+tag_info&
+drd_info_rep::local (tree_label l) {
+  if (!info->contains (l)) info(l)= copy (info[l]);
+  return info(l);
+}
+
+tag_info&
+drd_info_rep::modify (tree_label l) {
+  generation++;
+  return local (l);
+}
+
 /******************************************************************************
 * Tag types
 ******************************************************************************/
 
 void
 drd_info_rep::set_type (tree_label l, int tp) {
-  if (info[l]->pi.freeze_type) return;
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_type) return;
+  tag_info& ti= modify (l);
   ti->pi.type= tp;
 }
 
 int
 drd_info_rep::get_type (tree_label l) {
-  return info[l]->pi.type;
+  return lookup (l)->pi.type;
 }
 
 void
 drd_info_rep::freeze_type (tree_label l) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_type) return;
+  tag_info& ti= modify (l);
   ti->pi.freeze_type= true;
 }
 
 int
 drd_info_rep::get_type (tree t) {
-  return info[L(t)]->pi.type;
+  return lookup (L(t))->pi.type;
 }
 
 /******************************************************************************
@@ -97,9 +152,8 @@ drd_info_rep::get_type (tree t) {
 
 void
 drd_info_rep::set_arity (tree_label l, int arity, int extra, int am, int cm) {
-  if (info[l]->pi.freeze_arity) return;
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_arity) return;
+  tag_info& ti= modify (l);
   ti->pi.arity_mode= am;
   ti->pi.child_mode= cm;
   if (am != ARITY_VAR_REPEAT) {
@@ -120,46 +174,46 @@ drd_info_rep::set_arity (tree_label l, int arity, int extra, int am, int cm) {
 
 int
 drd_info_rep::get_arity_mode (tree_label l) {
-  return info[l]->pi.arity_mode;
+  return lookup (l)->pi.arity_mode;
 }
 
 int
 drd_info_rep::get_child_mode (tree_label l) {
-  return info[l]->pi.child_mode;
+  return lookup (l)->pi.child_mode;
 }
 
 int
 drd_info_rep::get_arity_base (tree_label l) {
-  return info[l]->pi.arity_base;
+  return lookup (l)->pi.arity_base;
 }
 
 int
 drd_info_rep::get_arity_extra (tree_label l) {
-  return info[l]->pi.arity_extra;
+  return lookup (l)->pi.arity_extra;
 }
 
 int
 drd_info_rep::get_nr_indices (tree_label l) {
-  return N(info[l]->ci);
+  return N(lookup (l)->ci);
 }
 
 void
 drd_info_rep::freeze_arity (tree_label l) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_arity) return;
+  tag_info& ti= modify (l);
   ti->pi.freeze_arity= true;
 }
 
 int
 drd_info_rep::get_old_arity (tree_label l) {
-  tag_info ti= info[l];
+  tag_info_rep* ti= lookup (l);
   if (ti->pi.arity_mode != ARITY_NORMAL) return -1;
   else return ((int) ti->pi.arity_base) + ((int) ti->pi.arity_extra);
 }
 
 int
 drd_info_rep::get_minimal_arity (tree_label l) {
-  parent_info pi= info[l]->pi;
+  parent_info pi= lookup (l)->pi;
   switch (pi.arity_mode) {
   case ARITY_NORMAL:
     return ((int) pi.arity_base) + ((int) pi.arity_extra);
@@ -173,7 +227,7 @@ drd_info_rep::get_minimal_arity (tree_label l) {
 
 int
 drd_info_rep::get_maximal_arity (tree_label l) {
-  parent_info pi= info[l]->pi;
+  parent_info pi= lookup (l)->pi;
   switch (pi.arity_mode) {
   case ARITY_NORMAL:
   case ARITY_OPTIONS:
@@ -187,7 +241,7 @@ drd_info_rep::get_maximal_arity (tree_label l) {
 
 bool
 drd_info_rep::correct_arity (tree_label l, int i) {
-  parent_info pi= info[l]->pi;
+  parent_info pi= lookup (l)->pi;
   switch (pi.arity_mode) {
   case ARITY_NORMAL:
     return i == ((int) pi.arity_base) + ((int) pi.arity_extra);
@@ -204,7 +258,7 @@ drd_info_rep::correct_arity (tree_label l, int i) {
 
 bool
 drd_info_rep::insert_point (tree_label l, int i, int n) {
-  parent_info pi= info[l]->pi;
+  parent_info pi= lookup (l)->pi;
   switch (pi.arity_mode) {
   case ARITY_NORMAL:
     return false;
@@ -229,7 +283,7 @@ drd_info_rep::is_dynamic (tree t, bool hack) {
   if (is_atomic (t)) return false;
   if (is_func (t, DOCUMENT) || is_func (t, PARA) || is_func (t, CONCAT) ||
       is_func (t, TABLE) || is_func (t, ROW)) return false;
-  return info[L(t)]->pi.arity_mode != ARITY_NORMAL;
+  return lookup (L(t))->pi.arity_mode != ARITY_NORMAL;
 }
 
 /******************************************************************************
@@ -238,39 +292,38 @@ drd_info_rep::is_dynamic (tree t, bool hack) {
 
 void
 drd_info_rep::set_border (tree_label l, int mode) {
-  if (info[l]->pi.freeze_border) return;
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_border) return;
+  tag_info& ti= modify (l);
   ti->pi.border_mode= mode;
 }
 
 int
 drd_info_rep::get_border (tree_label l) {
-  return info[l]->pi.border_mode;
+  return lookup (l)->pi.border_mode;
 }
 
 void
 drd_info_rep::freeze_border (tree_label l) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_border) return;
+  tag_info& ti= modify (l);
   ti->pi.freeze_border= true;
 }
 
 bool
 drd_info_rep::is_child_enforcing (tree t) {
-  return ((info[L(t)]->pi.border_mode & BORDER_INNER) != 0) &&
+  return ((lookup (L(t))->pi.border_mode & BORDER_INNER) != 0) &&
          (N(t) != 0);
 }
 
 bool
 drd_info_rep::is_parent_enforcing (tree t) {
-  return ((info[L(t)]->pi.border_mode & BORDER_OUTER) != 0) &&
+  return ((lookup (L(t))->pi.border_mode & BORDER_OUTER) != 0) &&
          (N(t) != 0);
 }
 
 bool
 drd_info_rep::var_without_border (tree_label l) {
-  return ((info[l]->pi.border_mode & BORDER_INNER) != 0) &&
+  return ((lookup (l)->pi.border_mode & BORDER_INNER) != 0) &&
          (!std_contains (as_string (l)));
 }
 
@@ -281,27 +334,26 @@ drd_info_rep::var_without_border (tree_label l) {
 
 void
 drd_info_rep::set_with_like (tree_label l, bool is_with_like) {
-  if (info[l]->pi.freeze_with) return;
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_with) return;
+  tag_info& ti= modify (l);
   ti->pi.with_like= is_with_like;
 }
 
 bool
 drd_info_rep::get_with_like (tree_label l) {
-  return info[l]->pi.with_like;
+  return lookup (l)->pi.with_like;
 }
 
 void
 drd_info_rep::freeze_with_like (tree_label l) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_with) return;
+  tag_info& ti= modify (l);
   ti->pi.freeze_with= true;
 }
 
 bool
 drd_info_rep::is_with_like (tree t) {
-  return info[L(t)]->pi.with_like && N(t) > 0;
+  return lookup (L(t))->pi.with_like && N(t) > 0;
 }
 
 /******************************************************************************
@@ -311,21 +363,20 @@ drd_info_rep::is_with_like (tree t) {
 
 void
 drd_info_rep::set_var_type (tree_label l, int vt) {
-  if (info[l]->pi.freeze_with) return;
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_with) return;
+  tag_info& ti= modify (l);
   ti->pi.var_type= vt;
 }
 
 int
 drd_info_rep::get_var_type (tree_label l) {
-  return info[l]->pi.var_type;
+  return lookup (l)->pi.var_type;
 }
 
 void
 drd_info_rep::freeze_var_type (tree_label l) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  if (lookup (l)->pi.freeze_with) return;
+  tag_info& ti= modify (l);
   ti->pi.freeze_with= true;
 }
 
@@ -335,14 +386,13 @@ drd_info_rep::freeze_var_type (tree_label l) {
 
 void
 drd_info_rep::set_attribute (tree_label l, string which, tree val) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info& ti= info(l);
+  tag_info& ti= modify (l);
   ti->set_attribute (which, val);
 }
 
 tree
 drd_info_rep::get_attribute (tree_label l, string which) {
-  tree val= info[l]->get_attribute (which);
+  tree val= lookup (l)->get_attribute (which);
   if ((which == "name") && (val == ""))
     return as_string (l);
   return val;
@@ -444,8 +494,7 @@ drd_info_rep::get_syntax (tree t, path p) {
 
 void
 drd_info_rep::set_type (tree_label l, int nr, int tp) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
+  tag_info& ti= modify (l);
   if (nr >= N(ti->ci)) return;
   child_info& ci= ti->ci[nr];
   if (ci.freeze_type) return;
@@ -454,27 +503,22 @@ drd_info_rep::set_type (tree_label l, int nr, int tp) {
 
 int
 drd_info_rep::get_type (tree_label l, int nr) {
-  if (nr >= N(info[l]->ci)) return TYPE_ADHOC;
-  return info[l]->ci[nr].type;
+  if (nr >= N(lookup (l)->ci)) return TYPE_ADHOC;
+  return lookup (l)->ci[nr].type;
 }
 
 void
 drd_info_rep::freeze_type (tree_label l, int nr) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
-  if (nr >= N(ti->ci)) return;
+  tag_info_rep* ri= lookup (l);
+  if (nr >= N(ri->ci) || ri->ci[nr].freeze_type) return;
+  tag_info& ti= modify (l);
   child_info& ci= ti->ci[nr];
   ci.freeze_type= true;
 }
 
 int
 drd_info_rep::get_type_child (tree t, int i) {
-  tag_info ti= info[L(t)];
-  if (is_func (t, EXTERN) && N(t)>0 && is_atomic (t[0])) {
-    tree_label lab= make_tree_label ("extern:" * t[0]->label);
-    if (info->contains(lab)) { ti= info[lab]; }
-    else { ti = info(EXTERN); info(lab)= ti; }
-  }
+  tag_info_rep* ti= lookup (t);
   int index= ti->get_index (i, N(t));
   if ((index<0) || (index>=N(ti->ci))) return TYPE_INVALID;
   int r= ti->ci[index].type;
@@ -489,8 +533,7 @@ drd_info_rep::get_type_child (tree t, int i) {
 
 void
 drd_info_rep::set_accessible (tree_label l, int nr, int is_accessible) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
+  tag_info& ti= modify (l);
   if (nr >= N(ti->ci)) return;
   child_info& ci= ti->ci[nr];
   if (ci.freeze_accessible) return;
@@ -499,33 +542,33 @@ drd_info_rep::set_accessible (tree_label l, int nr, int is_accessible) {
 
 int
 drd_info_rep::get_accessible (tree_label l, int nr) {
-  if (nr >= N(info[l]->ci)) return ACCESSIBLE_NEVER;
-  return info[l]->ci[nr].accessible;
+  if (nr >= N(lookup (l)->ci)) return ACCESSIBLE_NEVER;
+  return lookup (l)->ci[nr].accessible;
 }
 
 void
 drd_info_rep::freeze_accessible (tree_label l, int nr) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
-  if (nr >= N(ti->ci)) return;
+  tag_info_rep* ri= lookup (l);
+  if (nr >= N(ri->ci) || ri->ci[nr].freeze_accessible) return;
+  tag_info& ti= modify (l);
   child_info& ci= ti->ci[nr];
   ci.freeze_accessible= true;
 }
 
 bool
 drd_info_rep::all_accessible (tree_label l) {
-  int i, n= N(info[l]->ci);
+  int i, n= N(lookup (l)->ci);
   for (i=0; i<n; i++)
-    if (info[l]->ci[i].accessible != ACCESSIBLE_ALWAYS)
+    if (lookup (l)->ci[i].accessible != ACCESSIBLE_ALWAYS)
       return false;
   return n>0;
 }
 
 bool
 drd_info_rep::none_accessible (tree_label l) {
-  int i, n= N(info[l]->ci);
+  int i, n= N(lookup (l)->ci);
   for (i=0; i<n; i++)
-    if (info[l]->ci[i].accessible != ACCESSIBLE_NEVER)
+    if (lookup (l)->ci[i].accessible != ACCESSIBLE_NEVER)
       return false;
   return true;
 }
@@ -533,12 +576,7 @@ drd_info_rep::none_accessible (tree_label l) {
 bool
 drd_info_rep::is_accessible_child (tree t, int i) {
   //cout << "l= " << as_string (L(t)) << "\n";
-  tag_info ti= info[L(t)];
-  if (is_func (t, EXTERN) && N(t)>0 && is_atomic (t[0])) {
-    tree_label lab= make_tree_label ("extern:" * t[0]->label);
-    if (info->contains(lab)) { ti= info[lab]; }
-    else { ti = info(EXTERN); info(lab)= ti; }
-  }
+  tag_info_rep* ti= lookup (t);
   int index= ti->get_index (i, N(t));
   if ((index<0) || (index>=N(ti->ci))) {
     if (get_access_mode () == DRD_ACCESS_SOURCE)
@@ -572,8 +610,7 @@ drd_info_rep::is_accessible_path (tree t, path p) {
 
 void
 drd_info_rep::set_writability (tree_label l, int nr, int writability) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
+  tag_info& ti= modify (l);
   if (nr >= N(ti->ci)) return;
   child_info& ci= ti->ci[nr];
   if (ci.freeze_writability) return;
@@ -582,27 +619,22 @@ drd_info_rep::set_writability (tree_label l, int nr, int writability) {
 
 int
 drd_info_rep::get_writability (tree_label l, int nr) {
-  if (nr >= N(info[l]->ci)) return WRITABILITY_NORMAL;
-  return info[l]->ci[nr].writability;
+  if (nr >= N(lookup (l)->ci)) return WRITABILITY_NORMAL;
+  return lookup (l)->ci[nr].writability;
 }
 
 void
 drd_info_rep::freeze_writability (tree_label l, int nr) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
-  if (nr >= N(ti->ci)) return;
+  tag_info_rep* ri= lookup (l);
+  if (nr >= N(ri->ci) || ri->ci[nr].freeze_writability) return;
+  tag_info& ti= modify (l);
   child_info& ci= ti->ci[nr];
   ci.freeze_writability= true;
 }
 
 int
 drd_info_rep::get_writability_child (tree t, int i) {
-  tag_info ti= info[L(t)];
-  if (is_func (t, EXTERN) && N(t)>0 && is_atomic (t[0])) {
-    tree_label lab= make_tree_label ("extern:" * t[0]->label);
-    if (info->contains(lab)) { ti= info[lab]; }
-    else { ti = info(EXTERN); info(lab)= ti; }
-  }
+  tag_info_rep* ti= lookup (t);
   int index= ti->get_index (i, N(t));
   if ((index<0) || (index>=N(ti->ci))) return WRITABILITY_DISABLE;
   return ti->ci[index].writability;
@@ -634,12 +666,7 @@ drd_info_rep::get_child_long_name (tree_label l, int nr) {
 
 string
 drd_info_rep::get_child_name (tree t, int i) {
-  tag_info ti= info[L(t)];
-  if (is_func (t, EXTERN) && N(t)>0 && is_atomic (t[0])) {
-    tree_label lab= make_tree_label ("extern:" * t[0]->label);
-    if (info->contains(lab)) { ti= info[lab]; }
-    else { ti = info(EXTERN); info(lab)= ti; }
-  }
+  tag_info_rep* ti= lookup (t);
   int index= ti->get_index (i, N(t));
   if ((index<0) || (index>=N(ti->ci))) return "";
   return get_child_name (L(t), index);
@@ -647,12 +674,7 @@ drd_info_rep::get_child_name (tree t, int i) {
 
 string
 drd_info_rep::get_child_long_name (tree t, int i) {
-  tag_info ti= info[L(t)];
-  if (is_func (t, EXTERN) && N(t)>0 && is_atomic (t[0])) {
-    tree_label lab= make_tree_label ("extern:" * t[0]->label);
-    if (info->contains(lab)) { ti= info[lab]; }
-    else { ti = info(EXTERN); info(lab)= ti; }
-  }
+  tag_info_rep* ti= lookup (t);
   int index= ti->get_index (i, N(t));
   if ((index<0) || (index>=N(ti->ci))) return "";
   string r= get_child_long_name (L(t), index);
@@ -701,8 +723,7 @@ drd_info_rep::set_env (tree_label l, int nr, tree env) {
   //cout << as_string (l) << ", " << nr << " -> " << env << "\n";
   //if (as_string (l) == "session")
   //cout << as_string (l) << ", " << nr << " -> " << env << "\n";
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
+  tag_info& ti= modify (l);
   if (nr >= N(ti->ci)) return;
   child_info& ci= ti->ci[nr];
   if (ci.freeze_env) return;
@@ -711,15 +732,15 @@ drd_info_rep::set_env (tree_label l, int nr, tree env) {
 
 tree
 drd_info_rep::get_env (tree_label l, int nr) {
-  if (nr >= N(info[l]->ci)) return tree (ATTR);
-  return drd_decode (info[l]->ci[nr].env);
+  if (nr >= N(lookup (l)->ci)) return tree (ATTR);
+  return drd_decode (lookup (l)->ci[nr].env);
 }
 
 void
 drd_info_rep::freeze_env (tree_label l, int nr) {
-  if (!info->contains (l)) info(l)= copy (info[l]);
-  tag_info  & ti= info(l);
-  if (nr >= N(ti->ci)) return;
+  tag_info_rep* ri= lookup (l);
+  if (nr >= N(ri->ci) || ri->ci[nr].freeze_env) return;
+  tag_info& ti= modify (l);
   child_info& ci= ti->ci[nr];
   ci.freeze_env= true;
 }
@@ -744,7 +765,7 @@ drd_info_rep::get_env_child (tree t, int i, tree env) {
       }
     */
 
-    tag_info ti= info[L(t)];
+    tag_info_rep* ti= lookup (L(t));
     int index= ti->get_index (i, N(t));
     if ((index<0) || (index>=N(ti->ci))) return "";
     tree cenv= drd_decode (ti->ci[index].env);
@@ -21,10 +21,22 @@ public:
   string name;
   rel_hashmap<tree_label,tag_info> info;
   hashmap<string,tree> env;
+  drd_info_rep* parent;
+  int generation;
+  array<tag_info> dense;
+  array<int> dense_stamp;
+
+  inline int stamp ();
+  tag_info_rep* resolve (tree_label l);
+  tag_info& local (tree_label l);
 
 public:
   drd_info_rep (string name);
   drd_info_rep (string name, drd_info base);
+  ~drd_info_rep ();
+  inline tag_info_rep* lookup (tree_label l);
+  tag_info_rep* lookup (tree t);
+  tag_info& modify (tree_label l);
   tree get_locals ();
   bool set_locals (tree t);
   bool contains (string l);
@@ -139,6 +151,19 @@ class drd_info {
 };
 CONCRETE_CODE(drd_info);
 
+inline int
+drd_info_rep::stamp () {
+  if (parent == NULL) return generation;
+  return generation + parent->stamp ();
+}
+
+inline tag_info_rep*
+drd_info_rep::lookup (tree_label l) {
+  if (((int) l) < N(dense) && dense_stamp[l] == stamp ())
+    return dense[l].operator -> ();
+  return resolve (l);
+}
+
 tree drd_env_write (tree env, string var, tree val);
 tree drd_env_merge (tree env, tree t);
 tree drd_env_read (tree env, string var, tree val= tree (UNINIT));
@@ -82,7 +82,7 @@ static void
 init (tree_label l, string name, tag_info ti) {
   STD_CODE(name)= (int) l;
   make_tree_label (l, name);
-  std_drd->info (l)= ti;
+  std_drd->modify (l)= ti;
   std_drd->freeze_arity (l);
   std_drd->freeze_border (l);
   // std_drd->freeze_block (l);
@@ -94,7 +94,7 @@ init_var (string var, int tp, string vname= "") {
   tree_label l= make_tree_label (var);
   tag_info ti= fixed (0) -> var_parameter () -> type (tp);
   if (vname != "") ti= ti->name (vname);
-  std_drd->info (l)= ti;
+  std_drd->modify (l)= ti;
   std_drd->freeze_arity (l);
   std_drd->freeze_border (l);
 }
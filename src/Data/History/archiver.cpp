@@ -12,6 +12,8 @@
 #include "archiver.hpp"
 #include "hashset.hpp"
 #include "iterator.hpp"
+#include "analyze.hpp"
+#include "scheme.hpp"
 
 extern tree the_et;
 array<patch> singleton (patch p);
@@ -35,7 +37,8 @@ archiver_rep::archiver_rep (double author, path rp2):
   the_owner (0),
   rp (rp2),
   undo_obs (undo_observer (this)),
-  versioning (false)
+  versioning (false),
+  store ()
 {
   archs->insert ((pointer) this);
   attach_observer (subtree (the_et, rp), undo_obs);
@@ -56,6 +59,7 @@ void
 archiver_rep::clear () {
   archive= make_branches (0);
   current= make_compound (0);
+  store->clear ();
   the_owner= 0;
   depth= 0;
   last_save= -1;
@@ -175,6 +179,73 @@ cdr (patch p) {
   return child (p, 1);
 }
 
+static patch
+split_history (patch archive, int n, array<patch>& un, array<patch>& re) {
+  // split off the n most recent undo levels of a history (all if n < 0)
+  while (n != 0 && nr_undo (archive) != 0) {
+    un << car (get_undo (archive));
+    re << get_redo (archive);
+    archive= cdr (get_undo (archive));
+    n--;
+  }
+  return archive;
+}
+
+static patch
+join_history (array<patch> un, array<patch> re, patch tail) {
+  for (int i=N(un)-1; i>=0; i--)
+    tail= make_history (patch (un[i], tail), re[i]);
+  return tail;
+}
+
+static int
+history_length (patch archive) {
+  int n= 0;
+  while (nr_undo (archive) != 0) {
+    archive= cdr (get_undo (archive));
+    n++;
+  }
+  return n;
+}
+
+/******************************************************************************
+* Compact storage of older parts of the history
+*******************************************************************************
+* Only the history_window most recent undo levels are kept as patches.
+* Older levels are serialized into the history store, whose memory usage
+* is limited by the "undo memory limit" preference (in megabytes).  When
+* the store is non empty, the bottom of the live history is a placeholder
+* for the stored part, which is decoded again when the user undoes that far.
+******************************************************************************/
+
+static int history_window= 64;
+
+void
+archiver_rep::compact () {
+  if (history_length (archive) <= 2 * history_window) return;
+  array<patch> un, re;
+  patch old= split_history (archive, history_window, un, re);
+  store->push (old);
+  // limit in megabytes; the arena of the store is indexed by ints
+  DI limit= as_int (get_preference ("undo memory limit", "16"));
+  store->limit (min (max (limit, (DI) 1), (DI) 1024) << 20);
+  archive= join_history (un, re, make_branches (0));
+}
+
+void
+archiver_rep::restore (bool all) {
+  while (!store->is_empty ()) {
+    array<patch> un, re;
+    patch bot= split_history (archive, -1, un, re);
+    if (!all && N(un) >= history_window / 2) return;
+    patch old= store->pop ();
+    if (nr_redo (bot) != 0 && nr_undo (old) != 0)
+      old= make_history (get_undo (old),
+                         append_branches (get_redo (old), get_redo (bot)));
+    archive= join_history (un, re, old);
+  }
+}
+
 /******************************************************************************
 * Internal subroutines
 ******************************************************************************/
@@ -335,6 +406,7 @@ archiver_rep::confirm () {
       if (depth <= last_save) last_save= -1;
       if (depth <= last_autosave) last_autosave= -1;
       normalize ();
+      compact ();
       //show_all ();
     }
   }
@@ -342,6 +414,7 @@ archiver_rep::confirm () {
 
 bool
 archiver_rep::retract () {
+  restore ();
   if (!has_history ()) return false;
   if (the_owner != 0 && the_owner != the_author) return false;
   expose ();
@@ -383,6 +456,7 @@ archiver_rep::forget_cursor () {
 
 void
 archiver_rep::simplify () {
+  restore ();
   if (has_history () &&
       nr_undo (cdr (get_undo (archive))) == 1 &&
       nr_redo (cdr (get_undo (archive))) == 0 &&
@@ -428,6 +502,7 @@ archiver_rep::redo_possibilities () {
 path
 archiver_rep::undo_one (int i) {
   if (active ()) return path ();
+  restore ();
   if (undo_possibilities () != 0) {
     ASSERT (i == 0, "index out of range");
     patch p= car (get_undo (archive));
@@ -603,6 +678,7 @@ archiver_rep::mark_end (double m) {
     //  cout << "CONFIRM: " << current << "\n";
     confirm ();
   }
+  if (!has_marker (archive, m)) restore (true);
   archive= remove_marker (archive, m);
   depth--;
   simplify ();
@@ -622,6 +698,7 @@ archiver_rep::mark_cancel (double m) {
       return true;
     }
     if (get_author (car (get_undo (archive))) != the_author) {
+      if (!has_marker (archive, m)) restore (true);
       archive= remove_marker (archive, m);
       depth--;
       return false;
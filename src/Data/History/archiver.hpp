@@ -12,6 +12,7 @@
 #ifndef ARCHIVER_H
 #define ARCHIVER_H
 #include "patch.hpp"
+#include "history_store.hpp"
 
 void global_clear_history ();
 void global_confirm ();
@@ -28,6 +29,7 @@ class archiver_rep: public concrete_struct {
   path     rp;             // root path for document
   observer undo_obs;       // observer for undoing changes
   bool     versioning;     // true during undo and redo operations
+  history_store store;     // compact storage for the older history
 
 protected:
   void apply (patch p);
@@ -37,6 +39,8 @@ protected:
   void expose ();
   void normalize ();
   int corrected_depth ();
+  void compact ();
+  void restore (bool all= false);
 
 public:
   archiver_rep (double author, path rp);
@@ -0,0 +1,451 @@
+
+/******************************************************************************
+* MODULE     : history_store.cpp
+* DESCRIPTION: compact storage for old parts of the undo history
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "history_store.hpp"
+#include "file.hpp"
+#include "sys_utils.hpp"
+#include <string.h>
+
+/******************************************************************************
+* Reading and writing numbers
+******************************************************************************/
+
+static void
+write_number (string& s, unsigned int x) {
+  while (x >= 128) {
+    s << ((char) ((x & 127) | 128));
+    x >>= 7;
+  }
+  s << ((char) x);
+}
+
+static void
+write_signed (string& s, int x) {
+  write_number (s, (((unsigned int) x) << 1) ^ ((unsigned int) (x >> 31)));
+}
+
+static void
+write_double (string& s, double x) {
+  char buf[sizeof (double)];
+  memcpy (buf, &x, sizeof (double));
+  for (int i=0; i<(int) sizeof (double); i++) s << buf[i];
+}
+
+struct byte_reader {
+  string s;
+  int pos;
+  byte_reader (string s2): s (s2), pos (0) {}
+  unsigned int number ();
+  int signed_number ();
+  double real ();
+  string bytes (int n);
+};
+
+unsigned int
+byte_reader::number () {
+  unsigned int x= 0;
+  int shift= 0;
+  while (pos < N(s)) {
+    unsigned char c= (unsigned char) s[pos++];
+    x |= ((unsigned int) (c & 127)) << shift;
+    if (c < 128) break;
+    shift += 7;
+  }
+  return x;
+}
+
+int
+byte_reader::signed_number () {
+  unsigned int x= number ();
+  return (int) ((x >> 1) ^ (0 - (x & 1)));
+}
+
+double
+byte_reader::real () {
+  double x= 0.0;
+  ASSERT (pos + (int) sizeof (double) <= N(s), "corrupted history");
+  memcpy (&x, &s[pos], sizeof (double));
+  pos += sizeof (double);
+  return x;
+}
+
+string
+byte_reader::bytes (int n) {
+  ASSERT (pos + n <= N(s), "corrupted history");
+  string r= s (pos, pos + n);
+  pos += n;
+  return r;
+}
+
+/******************************************************************************
+* Encoding patches
+******************************************************************************/
+
+struct patch_encoder {
+  string out;
+  array<int> last;  // previously encoded path
+  void encode (tree t);
+  void encode (path p);
+  void encode (modification m);
+  void encode (patch p);
+};
+
+void
+patch_encoder::encode (tree t) {
+  write_number (out, (unsigned int) L(t));
+  if (is_atomic (t)) {
+    write_number (out, N(t->label));
+    out << t->label;
+  }
+  else {
+    int i, n= N(t);
+    write_number (out, n);
+    for (i=0; i<n; i++) encode (t[i]);
+  }
+}
+
+void
+patch_encoder::encode (path p) {
+  array<int> a;
+  for (; !is_nil (p); p= p->next) a << p->item;
+  int i, common= 0, n= min (N(a), N(last));
+  while (common < n && a[common] == last[common]) common++;
+  write_number (out, common);
+  write_number (out, N(a) - common);
+  for (i=common; i<N(a); i++) write_signed (out, a[i]);
+  last= a;
+}
+
+void
+patch_encoder::encode (modification m) {
+  write_number (out, m->k);
+  encode (m->p);
+  encode (m->t);
+}
+
+void
+patch_encoder::encode (patch p) {
+  int i, n, tp= get_type (p);
+  write_number (out, tp);
+  switch (tp) {
+  case PATCH_MODIFICATION:
+    encode (get_modification (p));
+    encode (get_inverse (p));
+    break;
+  case PATCH_COMPOUND:
+  case PATCH_BRANCH:
+    n= N(p);
+    write_number (out, n);
+    for (i=0; i<n; i++) encode (p[i]);
+    break;
+  case PATCH_BIRTH:
+    write_double (out, get_author (p));
+    write_number (out, get_birth (p)? 1: 0);
+    break;
+  case PATCH_AUTHOR:
+    write_double (out, get_author (p));
+    encode (p[0]);
+    break;
+  default:
+    FAILED ("unsupported patch type");
+  }
+}
+
+string
+encode_patch (patch p) {
+  patch_encoder enc;
+  enc.encode (p);
+  return enc.out;
+}
+
+/******************************************************************************
+* Decoding patches
+******************************************************************************/
+
+struct patch_decoder: byte_reader {
+  array<int> last;  // previously decoded path
+  patch_decoder (string s2): byte_reader (s2) {}
+  tree decode_tree ();
+  path decode_path ();
+  modification decode_modification ();
+  patch decode_patch ();
+};
+
+tree
+patch_decoder::decode_tree () {
+  tree_label l= (tree_label) number ();
+  if (l == TMSTRING) return tree (bytes (number ()));
+  int i, n= number ();
+  tree t (l, n);
+  for (i=0; i<n; i++) t[i]= decode_tree ();
+  return t;
+}
+
+path
+patch_decoder::decode_path () {
+  int i, common= number (), n= number ();
+  ASSERT (common <= N(last), "corrupted history");
+  last->resize (common + n);
+  for (i=0; i<n; i++) last[common + i]= signed_number ();
+  path p;
+  for (i=N(last)-1; i>=0; i--) p= path (last[i], p);
+  return p;
+}
+
+modification
+patch_decoder::decode_modification () {
+  modification_type k= number ();
+  path p= decode_path ();
+  tree t= decode_tree ();
+  return modification (k, p, t);
+}
+
+patch
+patch_decoder::decode_patch () {
+  int i, n, tp= number ();
+  switch (tp) {
+  case PATCH_MODIFICATION:
+    {
+      modification m= decode_modification ();
+      modification inv= decode_modification ();
+      return patch (m, inv);
+    }
+  case PATCH_COMPOUND:
+  case PATCH_BRANCH:
+    {
+      n= number ();
+      array<patch> a (n);
+      for (i=0; i<n; i++) a[i]= decode_patch ();
+      return patch (tp == PATCH_BRANCH, a);
+    }
+  case PATCH_BIRTH:
+    {
+      double author= real ();
+      bool birth= (number () != 0);
+      return patch (author, birth);
+    }
+  case PATCH_AUTHOR:
+    {
+      double author= real ();
+      patch p= decode_patch ();
+      return patch (author, p);
+    }
+  default:
+    FAILED ("corrupted history");
+    return patch ();
+  }
+}
+
+patch
+decode_patch (string s) {
+  patch_decoder dec (s);
+  return dec.decode_patch ();
+}
+
+/******************************************************************************
+* LZ77 style compression
+*******************************************************************************
+* The compressed format starts with the uncompressed length, followed by
+* a sequence of tokens.  Each token consists of a number of literal bytes
+* and a back reference (length, offset) to earlier output; a zero length
+* terminates the sequence.
+******************************************************************************/
+
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET (1 << 20)
+
+static inline unsigned int
+lz_hash (const unsigned char* b) {
+  unsigned int x;
+  memcpy (&x, b, 4);
+  return (x * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void
+lz_literals (string& r, string& s, int start, int end) {
+  write_number (r, end - start);
+  if (end > start) r << s (start, end);
+}
+
+string
+compress_bytes (string s) {
+  int n= N(s), i= 0, lit= 0;
+  string r;
+  write_number (r, n);
+  if (n >= LZ_MIN_MATCH) {
+    const unsigned char* b= (const unsigned char*) &s[0];
+    int table[1 << LZ_HASH_BITS];
+    for (int j=0; j < (1 << LZ_HASH_BITS); j++) table[j]= -1;
+    while (i + LZ_MIN_MATCH <= n) {
+      unsigned int h= lz_hash (b + i);
+      int cand= table[h];
+      table[h]= i;
+      if (cand >= 0 && i - cand <= LZ_MAX_OFFSET &&
+          memcmp (b + cand, b + i, LZ_MIN_MATCH) == 0) {
+        int len= LZ_MIN_MATCH;
+        while (i + len < n && b[cand + len] == b[i + len]) len++;
+        lz_literals (r, s, lit, i);
+        write_number (r, len);
+        write_number (r, i - cand);
+        i += len;
+        lit= i;
+      }
+      else i++;
+    }
+  }
+  lz_literals (r, s, lit, n);
+  write_number (r, 0);
+  return r;
+}
+
+string
+decompress_bytes (string s) {
+  byte_reader in (s);
+  int n= in.number ();
+  string r;
+  while (true) {
+    int nr= in.number ();
+    if (nr > 0) r << in.bytes (nr);
+    int len= in.number ();
+    if (len == 0) break;
+    int offset= in.number ();
+    int from= N(r) - offset;
+    ASSERT (from >= 0 && N(r) + len <= n, "corrupted history");
+    for (int j=0; j<len; j++) r << r[from + j];
+  }
+  ASSERT (N(r) == n, "corrupted history");
+  return r;
+}
+
+/******************************************************************************
+* History stores
+******************************************************************************/
+
+history_store_rep::history_store_rep ():
+  arena (""), start (0), spill (url_none ()), disk (0), disk_end (0) {}
+
+history_store_rep::~history_store_rep () {
+  clear ();
+}
+
+history_store::history_store ():
+  rep (tm_new<history_store_rep> ()) {}
+
+void
+history_store_rep::clear () {
+  arena= "";
+  start= array<int> ();
+  if (N(disk) > 0) remove (spill);
+  spill= url_none ();
+  disk= array<DI> ();
+  disk_end= 0;
+}
+
+bool
+history_store_rep::is_empty () {
+  return N(start) == 0 && N(disk) == 0;
+}
+
+DI
+history_store_rep::memory_size () {
+  return N(arena) + N(start) * sizeof (int);
+}
+
+int
+history_store_rep::disk_segments () {
+  return N(disk);
+}
+
+void
+history_store_rep::push (patch p) {
+  start << N(arena);
+  arena << compress_bytes (encode_patch (p));
+}
+
+patch
+history_store_rep::pop () {
+  if (N(start) == 0 && N(disk) > 0) reload ();
+  ASSERT (N(start) > 0, "history store is empty");
+  int last= N(start) - 1;
+  string s= arena (start[last], N(arena));
+  arena->resize (start[last]);
+  start->resize (last);
+  return decode_patch (decompress_bytes (s));
+}
+
+/******************************************************************************
+* Moving segments to disk and back
+******************************************************************************/
+
+bool
+history_store_rep::write_spill (string s) {
+  // write s at the end of the segments in the file; return true on error
+  string name= concretize (spill);
+  FILE* f= texmacs_fopen (name, N(disk) == 0? "wb": "r+b", false);
+  if (f == NULL) return true;
+  bool err= fseek (f, (long) disk_end, SEEK_SET) != 0;
+  if (!err) err= texmacs_fwrite (&s[0], N(s), f) != (ssize_t) N(s);
+  texmacs_fclose (f, false);
+  return err;
+}
+
+void
+history_store_rep::limit (DI max_bytes) {
+  if (memory_size () <= max_bytes || N(start) <= 1) return;
+  int i, k= 0, n= N(start);
+  while (k < n-1 && N(arena) - start[k] > max_bytes / 2) k++;
+  if (k == 0) return;
+  if (N(disk) == 0) spill= url_temp (".hist");
+  if (write_spill (arena (0, start[k]))) {
+    if (N(disk) == 0) {
+      remove (spill);
+      spill= url_none ();
+    }
+    return;
+  }
+  for (i=0; i<k; i++) disk << (disk_end + start[i]);
+  disk_end += start[k];
+  int offset= start[k];
+  arena= arena (offset, N(arena));
+  array<int> a (n - k);
+  for (i=k; i<n; i++) a[i-k]= start[i] - offset;
+  start= a;
+}
+
+void
+history_store_rep::reload () {
+  // called when the arena is empty; only read back the most recent segment
+  int last= N(disk) - 1;
+  DI len= disk_end - disk[last];
+  string s (len);
+  string name= concretize (spill);
+  FILE* f= texmacs_fopen (name, "rb", false);
+  bool err= (f == NULL);
+  if (!err) {
+    err= fseek (f, (long) disk[last], SEEK_SET) != 0;
+    if (!err) err= texmacs_fread (&s[0], len, f) != (ssize_t) len;
+    texmacs_fclose (f, false);
+  }
+  if (err) {
+    FAILED ("history lost on disk");
+    return;
+  }
+  arena= s;
+  start= array<int> (1);
+  start[0]= 0;
+  disk_end= disk[last];
+  disk->resize (last);
+  if (last == 0) {
+    remove (spill);
+    spill= url_none ();
+  }
+}
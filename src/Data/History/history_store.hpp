@@ -0,0 +1,74 @@
+
+/******************************************************************************
+* MODULE     : history_store.hpp
+* DESCRIPTION: compact storage for old parts of the undo history
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+#include "patch.hpp"
+#include "url.hpp"
+
+/******************************************************************************
+* Serialization of patches
+*******************************************************************************
+* Patches are encoded into a binary format, in which paths are stored
+* relative to the previous path and the result is compressed with a
+* simple LZ77 scheme.  Since tree labels are encoded by their numbers,
+* the encoding is only valid during the current session.
+******************************************************************************/
+
+string encode_patch (patch p);
+patch  decode_patch (string s);
+string compress_bytes (string s);
+string decompress_bytes (string s);
+
+/******************************************************************************
+* Stacks of encoded history segments
+*******************************************************************************
+* The archiver pushes older parts of its history onto a history store
+* and pops them back when the user undoes that far.  The encoded segments
+* are appended to a single arena; whenever the arena exceeds the memory
+* limit, the oldest segments are moved to a temporary file on disk.
+* The file keeps an index of the offsets of its segments, so that they
+* can be read back one by one; segments which have been read back are
+* overwritten by the next spill.
+******************************************************************************/
+
+class history_store;
+class history_store_rep: concrete_struct {
+  string     arena;     // encoded segments, from old to recent
+  array<int> start;     // start positions of the segments in the arena
+  url        spill;     // temporary file for the oldest segments
+  array<DI>  disk;      // start positions of the segments in the file
+  DI         disk_end;  // end of the last segment in the file
+
+  bool write_spill (string s);
+  void reload ();
+
+public:
+  history_store_rep ();
+  ~history_store_rep ();
+  void clear ();
+  bool is_empty ();
+  DI   memory_size ();
+  int  disk_segments ();
+  void push (patch p);
+  patch pop ();
+  void limit (DI max_bytes);
+
+  friend class history_store;
+};
+
+class history_store {
+CONCRETE(history_store);
+  history_store ();
+};
+CONCRETE_CODE(history_store);
+
+#endif // defined HISTORY_STORE_H
@@ -10,6 +10,7 @@
 ******************************************************************************/
 
 #include "analyze.hpp"
+#include "string_scan.hpp"
 #include "merge_sort.hpp"
 #include "converter.hpp"
 #include "scheme.hpp"
@@ -1196,8 +1197,19 @@ parse (string s, int& pos, SI*& a, int len) {
 
 int
 search_forwards (array<string> a, int pos, string in) {
-  int n= N(in), na= N(a);
-  while (pos <= n) {
+  int n= N(in), na= N(a), m= 0;
+  char firsts[256];
+  for (int i=0; i<na; i++)
+    if (N(a[i]) > 0) {
+      int j= 0;
+      while (j<m && firsts[j] != a[i][0]) j++;
+      if (j == m) firsts[m++]= a[i][0];
+    }
+  if (m == 0) return -1;
+  const char* s= as_buffer (in);
+  while (pos < n) {
+    pos= find_chars (s, n, pos, firsts, m);
+    if (pos < 0) return -1;
     for (int i=0; i<na; i++)
       if (N(a[i])>0 && in[pos] == a[i][0] && test (in, pos, a[i])) return pos;
     pos++;
@@ -1207,14 +1219,7 @@ search_forwards (array<string> a, int pos, string in) {
 
 int
 search_forwards (string s, int pos, string in) {
-  int k= N(s), n= N(in);
-  if (k == 0) return pos;
-  char c= s[0];
-  while (pos+k <= n) {
-    if (in[pos] == c && test (in, pos, s)) return pos;
-    pos++;
-  }
-  return -1;
+  return find_substring (as_buffer (in), N(in), pos, as_buffer (s), N(s));
 }
 
 int
@@ -1229,11 +1234,7 @@ occurs (string what, string in) {
 
 int
 search_backwards (string s, int pos, string in) {
-  while (pos >= 0) {
-    if (test (in, pos, s)) return pos;
-    pos--;
-  }
-  return -1;
+  return rfind_substring (as_buffer (in), N(in), pos, as_buffer (s), N(s));
 }
 
 int
@@ -1268,17 +1269,17 @@ overlapping (string s1, string s2) {
 
 string
 replace (string s, string what, string by) {
-  int i, n= N(s);
+  int i= 0, n= N(s), k= N(what);
+  if (k == 0) return s;
   string r;
-  for (i=0; i<n; )
-    if (test (s, i, what)) {
-      r << by;
-      i += N(what);
-    }
-    else {
-      r << s[i];
-      i++;
-    }
+  while (i < n) {
+    int j= search_forwards (what, i, s);
+    if (j < 0) j= n;
+    r << s (i, j);
+    if (j == n) break;
+    r << by;
+    i= j + k;
+  }
   return r;
 }
 
@@ -1316,16 +1317,16 @@ find_non_alpha (string s, int pos, bool forward) {
 
 array<string>
 tokenize (string s, string sep) {
-  int start=0;
+  int start= 0, k= N(sep);
   array<string> a;
-  for (int i=0; i<N(s); )
-    if (test (s, i, sep)) {
-      a << s (start, i);
-      i += N(sep);
-      start= i;
-    }
-    else i++;
-  a << s(start, N(s));
+  if (k == 0) return a << s;
+  while (true) {
+    int i= search_forwards (sep, start, s);
+    if (i < 0) break;
+    a << s (start, i);
+    start= i + k;
+  }
+  a << s (start, N(s));
   return a;
 }
 
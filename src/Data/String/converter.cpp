@@ -15,6 +15,10 @@
 #include <iconv.h>
 #endif
 #include <errno.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CONVERTER_SSSE3
+#endif
 
 RESOURCE_CODE (converter);
 
@@ -24,9 +28,7 @@ RESOURCE_CODE (converter);
 
 void
 operator << (converter c, string str) {
-  int index = 0;
-  while (index < N(str))
-    c->match(str, index);
+  c->convert (c->output, str, 0, N(str));
 }
 
 string
@@ -65,37 +67,158 @@ converter_rep::has_value(hashtree<char,string> node) {
   return node->label != nil_string;
 }
 
-inline void
-converter_rep::match (string& str, int& index) {
-  int forward = index;
-  int last_match = -1;
-  string value("");
-  bool done = false;
-  hashtree<char,string> node = ht;
-  //cout << "[";
-  while (!done && forward < N(str)) {
-    if (node->contains (str[forward])) {
-      node = node(str[forward]);
-      //printf("->%x",str[forward]);
-      if (has_value(node)) {
-        last_match = forward;
-        value = node->label;
-      }
-      forward++;
+void
+converter_rep::match (string& out, string& str, int& index, int end) {
+  const int* LO= A(lo);
+  const int* HI= A(hi);
+  const int* BASE= A(base);
+  const int* VAL= A(val);
+  const int* TRANS= A(trans);
+  int state= 0, forward= index;
+  int last_match= -1, last_val= -1;
+  while (forward < end) {
+    int c= (unsigned char) str[forward];
+    if (c < LO[state] || c >= HI[state]) break;
+    state= TRANS[BASE[state] + c - LO[state]];
+    if (state < 0) break;
+    if (VAL[state] >= 0) {
+      last_match= forward;
+      last_val  = VAL[state];
     }
-    else done = true;
+    forward++;
   }
   if (last_match==-1) {
     if (copy_unmatched)
-      output << string(str[index]);
+      out << str[index];
     index++;
   }
   else {
-    //printf(":");for(int i = 0; i < N(value);i++) printf("%x ",value[i]);
-    output << value;
+    out << values[last_val];
     index = last_match + 1;
   }
-  //cout << "]";
+}
+
+static inline void
+append_range (string& out, string& in, int start, int end) {
+  int k= N(out), n= end - start;
+  out->resize (k + n);
+  for (int i=0; i<n; i++) out[k+i]= in[start+i];
+}
+
+void
+converter_rep::convert (string& out, string& str, int start, int end) {
+  int index= start;
+  while (index < end) {
+    int run= verbatim_run (str, index, end);
+    if (run > index) {
+      append_range (out, str, index, run);
+      index= run;
+    }
+    if (index < end) match (out, str, index, end);
+  }
+}
+
+/******************************************************************************
+* Scanning for runs of bytes which translate into themselves
+******************************************************************************/
+
+#ifdef CONVERTER_SSSE3
+// Bit h of tab[l] is set whenever the byte 16*h+l is verbatim; the two
+// nibbles of each input byte thus select a row and a bit of the table.
+// Bytes with the high bit set always end the run.
+__attribute__((target("ssse3"))) static int
+verbatim_run_ssse3 (const unsigned char* s, int i, int end,
+                    const unsigned char* tab)
+{
+  const __m128i rows = _mm_loadu_si128 ((const __m128i*) tab);
+  const __m128i bits = _mm_setr_epi8 (1, 2, 4, 8, 16, 32, 64, (char) 128,
+                                      0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i low  = _mm_set1_epi8 (0x0f);
+  const __m128i zero = _mm_setzero_si128 ();
+  while (i + 16 <= end) {
+    __m128i v  = _mm_loadu_si128 ((const __m128i*) (s + i));
+    __m128i lo = _mm_and_si128 (v, low);
+    __m128i hi = _mm_and_si128 (_mm_srli_epi16 (v, 4), low);
+    __m128i row= _mm_shuffle_epi8 (rows, lo);
+    __m128i bit= _mm_shuffle_epi8 (bits, hi);
+    __m128i off= _mm_cmpeq_epi8 (_mm_and_si128 (row, bit), zero);
+    int mask= _mm_movemask_epi8 (off);
+    if (mask != 0) return i + __builtin_ctz (mask);
+    i += 16;
+  }
+  return i;
+}
+
+static bool
+has_ssse3 () {
+  static bool ok= __builtin_cpu_supports ("ssse3");
+  return ok;
+}
+#endif
+
+int
+converter_rep::verbatim_run (string& str, int index, int end, bool ascii) {
+  if (index >= end) return index;
+  const unsigned char* s= (const unsigned char*) &str[0];
+  int i= index;
+#ifdef CONVERTER_SSSE3
+  if (end - i >= 16 && has_ssse3 ())
+    i= verbatim_run_ssse3 (s, i, end, verbatim_ascii);
+#endif
+  while (i < end && verbatim[s[i]] && (s[i] < 128 || !ascii)) i++;
+  return i;
+}
+
+/******************************************************************************
+* Compilation of the dictionary into flat transition tables
+******************************************************************************/
+
+int
+converter_rep::compile (hashtree<char,string> node) {
+  int s= N(lo), l= 256, h= 0, c;
+  if (N(node) != 0)
+    for (c=0; c<256; c++)
+      if (node->contains ((char) c)) {
+        if (l == 256) l= c;
+        h= c+1;
+      }
+  if (h == 0) l= 0;
+  lo << l;
+  hi << h;
+  base << N(trans);
+  if (has_value (node)) {
+    val << N(values);
+    values << node->label;
+  }
+  else val << -1;
+  for (c=l; c<h; c++) trans << -1;
+  for (c=l; c<h; c++)
+    if (node->contains ((char) c)) {
+      int t= compile (node ((char) c));
+      trans[base[s] + c - l]= t;
+    }
+  return s;
+}
+
+void
+converter_rep::compile () {
+  lo   = array<int> ();
+  hi   = array<int> ();
+  base = array<int> ();
+  val  = array<int> ();
+  trans= array<int> ();
+  values= array<string> ();
+  (void) compile (ht);
+  for (int c=0; c<16; c++) verbatim_ascii[c]= 0;
+  for (int c=0; c<256; c++) {
+    int t= -1;
+    if (c >= lo[0] && c < hi[0]) t= trans[base[0] + c - lo[0]];
+    if (t < 0) verbatim[c]= copy_unmatched;
+    else verbatim[c]= (lo[t] == hi[t] && val[t] >= 0 &&
+                       values[val[t]] == string ((char) c));
+    if (verbatim[c] && c < 128)
+      verbatim_ascii[c & 15] |= (unsigned char) (1 << (c >> 4));
+  }
 }
 
 void
@@ -315,6 +438,11 @@ utf8_to_cork (string input) {
   string output;
   for (i=0; i<n; ) {
     start= i;
+    i= conv->verbatim_run (input, i, n, true);
+    if (i > start) {
+      append_range (output, input, start, i);
+      continue;
+    }
     unsigned int code= decode_from_utf8 (input, i);
     string s= input (start, i);
     string r= apply (conv, s);
@@ -332,6 +460,11 @@ sourcecode_to_cork (string input) {
   string output;
   for (i=0; i<n; ) {
     start= i;
+    i= conv->verbatim_run (input, i, n, true);
+    if (i > start) {
+      append_range (output, input, start, i);
+      continue;
+    }
     unsigned int code= decode_from_utf8 (input, i);
     string s= input (start, i);
     string r= apply (conv, s);
@@ -349,13 +482,13 @@ cork_to_utf8 (string input) {
   string r;
   for (i=0; i<n; i++)
     if (input[i] == '<' && i+1<n && input[i+1] == '#') {
-      r << apply (conv, input (start, i));
+      conv->convert (r, input, start, i);
       start= i= i+2;
       while (i<n && input[i] != '>') i++;
       r << encode_as_utf8 (from_hexadecimal (input (start, i)));
       start= i+1;
     }
-  r << apply (conv, input (start, n));
+  conv->convert (r, input, start, n);
   return r;
 }
 
@@ -366,13 +499,13 @@ strict_cork_to_utf8 (string input) {
   string r;
   for (i=0; i<n; i++)
     if (input[i] == '<' && i+1<n && input[i+1] == '#') {
-      r << apply (conv, input (start, i));
+      conv->convert (r, input, start, i);
       start= i= i+2;
       while (i<n && input[i] != '>') i++;
       r << encode_as_utf8 (from_hexadecimal (input (start, i)));
       start= i+1;
     }
-  r << apply (conv, input (start, n));
+  conv->convert (r, input, start, n);
   return r;
 }
 
@@ -383,13 +516,13 @@ cork_to_sourcecode (string input) {
   string r;
   for (i=0; i<n; i++)
     if (input[i] == '<' && i+1<n && input[i+1] == '#') {
-      r << apply (conv, input (start, i));
+      conv->convert (r, input, start, i);
       start= i= i+2;
       while (i<n && input[i] != '>') i++;
       r << encode_as_utf8 (from_hexadecimal (input (start, i)));
       start= i+1;
     }
-  r << apply (conv, input (start, n));
+  conv->convert (r, input, start, n);
   return r;
 }
 
@@ -400,6 +533,11 @@ utf8_to_t2a (string input) {
   string output;
   for (i=0; i<n; ) {
     start= i;
+    i= conv->verbatim_run (input, i, n, true);
+    if (i > start) {
+      append_range (output, input, start, i);
+      continue;
+    }
     unsigned int code= decode_from_utf8 (input, i);
     string s= input (start, i);
     string r= apply (conv, s);
@@ -459,13 +597,13 @@ t2a_to_utf8 (string input) {
   string r;
   for (i=0; i<n; i++)
     if (input[i] == '<' && i+1<n && input[i+1] == '#') {
-      r << apply (conv, input (start, i));
+      conv->convert (r, input, start, i);
       start= i= i+2;
       while (i<n && input[i] != '>') i++;
       r << encode_as_utf8 (from_hexadecimal (input (start, i)));
       start= i+1;
     }
-  r << apply (conv, input (start, n));
+  conv->convert (r, input, start, n);
   return r;
 }
 
@@ -13,6 +13,7 @@
 #define CONVERTER_H
 #include "resource.hpp"
 #include "hashtree.hpp"
+#include "array.hpp"
 #include "file.hpp"
 
 enum escape_type { NOESCAPES, BIT2BIT, UTF8, ENTITY_NAME, CHAR_ENTITY };
@@ -24,21 +25,36 @@ RESOURCE(converter);
 * It does so by iterating over a string, finding the longest matching key
 * in the dictionary and replacing the matched substring with the translation.
 * The hashtree and converter classes are used.
+*
+* After loading, the hashtree is compiled into flat transition tables:
+* each state s of the automaton owns the bytes lo[s] <= c < hi[s], and its
+* successor for c is found at trans[base[s] + c - lo[s]] (-1 if none).
+* Bytes which are always translated into themselves are flagged in
+* verbatim, so that runs of them can be copied without any matching.
 ******************************************************************************/
 
 struct converter_rep: rep<converter> {
   hashtree<char,string> ht;
   string output, nil_string, from, to;
   bool copy_unmatched;
-  void match (string& str, int& index);
+  array<int> lo, hi, base, val, trans;
+  array<string> values;
+  bool verbatim[256];
+  unsigned char verbatim_ascii[16];
+  void match (string& out, string& str, int& index, int end);
   void load ();
+  int  compile (hashtree<char,string> node);
+  void compile ();
 
 public:
   inline converter_rep(string from2, string to2) : 
     rep<converter>(from2*"-"*to2), ht(), output(), 
-    nil_string(), from(from2), to(to2), copy_unmatched(true) { load(); }
+    nil_string(), from(from2), to(to2), copy_unmatched(true) {
+      load(); compile(); }
 
   inline bool has_value(hashtree<char,string> node);
+  int  verbatim_run (string& str, int index, int end, bool ascii= false);
+  void convert (string& out, string& str, int start, int end);
 
   friend struct converter;
   friend string flush (converter c);
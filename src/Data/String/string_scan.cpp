@@ -0,0 +1,155 @@
+
+/******************************************************************************
+* MODULE     : string_scan.cpp
+* DESCRIPTION: Vectorized scanning and substring search in character buffers
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "string_scan.hpp"
+#include <string.h>
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define SCAN_SSE2
+#endif
+
+#ifdef SCAN_SSE2
+static inline int
+lowest_bit (unsigned int mask) {
+  return __builtin_ctz (mask);
+}
+
+static inline int
+highest_bit (unsigned int mask) {
+  return 31 - __builtin_clz (mask);
+}
+
+static inline unsigned int
+block_mask (__m128i block, __m128i c) {
+  return (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi8 (block, c));
+}
+
+static inline __m128i
+load_block (const char* s) {
+  return _mm_loadu_si128 ((const __m128i*) s);
+}
+#endif
+
+/******************************************************************************
+* Single characters
+******************************************************************************/
+
+int
+find_char (const char* s, int n, int pos, char c) {
+  if (pos < 0) pos= 0;
+  if (pos >= n) return -1;
+  const void* r= memchr (s + pos, c, n - pos);
+  return r == NULL? -1: (int) (((const char*) r) - s);
+}
+
+int
+rfind_char (const char* s, int n, int pos, char c) {
+  if (pos >= n) pos= n-1;
+#ifdef SCAN_SSE2
+  __m128i cc= _mm_set1_epi8 (c);
+  while (pos >= 15) {
+    unsigned int mask= block_mask (load_block (s + pos - 15), cc);
+    if (mask != 0) return pos - 15 + highest_bit (mask);
+    pos -= 16;
+  }
+#endif
+  for (; pos >= 0; pos--)
+    if (s[pos] == c) return pos;
+  return -1;
+}
+
+int
+find_chars (const char* s, int n, int pos, const char* set, int m) {
+  if (m == 1) return find_char (s, n, pos, set[0]);
+  if (pos < 0) pos= 0;
+#ifdef SCAN_SSE2
+  if (m <= 16) {
+    __m128i cs[16];
+    for (int j=0; j<m; j++) cs[j]= _mm_set1_epi8 (set[j]);
+    while (pos + 16 <= n) {
+      __m128i block= load_block (s + pos);
+      __m128i hit  = _mm_setzero_si128 ();
+      for (int j=0; j<m; j++)
+        hit= _mm_or_si128 (hit, _mm_cmpeq_epi8 (block, cs[j]));
+      unsigned int mask= (unsigned int) _mm_movemask_epi8 (hit);
+      if (mask != 0) return pos + lowest_bit (mask);
+      pos += 16;
+    }
+  }
+#endif
+  bool in_set[256];
+  memset (in_set, 0, sizeof (in_set));
+  for (int j=0; j<m; j++) in_set[(unsigned char) set[j]]= true;
+  for (; pos < n; pos++)
+    if (in_set[(unsigned char) s[pos]]) return pos;
+  return -1;
+}
+
+/******************************************************************************
+* Substrings
+******************************************************************************/
+
+int
+find_substring (const char* s, int n, int pos, const char* w, int k) {
+  if (k == 0) return pos;
+  if (pos < 0) pos= 0;
+  if (k == 1) return find_char (s, n, pos, w[0]);
+#ifdef SCAN_SSE2
+  __m128i first= _mm_set1_epi8 (w[0]);
+  __m128i last = _mm_set1_epi8 (w[k-1]);
+  while (pos + k - 1 + 16 <= n) {
+    unsigned int mask=
+      block_mask (load_block (s + pos), first) &
+      block_mask (load_block (s + pos + k - 1), last);
+    while (mask != 0) {
+      int i= pos + lowest_bit (mask);
+      if (memcmp (s + i + 1, w + 1, k - 2) == 0) return i;
+      mask &= mask - 1;
+    }
+    pos += 16;
+  }
+#endif
+  while (pos + k <= n) {
+    const void* r= memchr (s + pos, w[0], n - k + 1 - pos);
+    if (r == NULL) return -1;
+    int i= (int) (((const char*) r) - s);
+    if (memcmp (s + i + 1, w + 1, k - 1) == 0) return i;
+    pos= i + 1;
+  }
+  return -1;
+}
+
+int
+rfind_substring (const char* s, int n, int pos, const char* w, int k) {
+  if (k == 0) return pos < 0? -1: pos;
+  if (pos > n - k) pos= n - k;
+  if (k == 1) return rfind_char (s, n, pos, w[0]);
+#ifdef SCAN_SSE2
+  __m128i first= _mm_set1_epi8 (w[0]);
+  __m128i last = _mm_set1_epi8 (w[k-1]);
+  while (pos >= 15) {
+    int start= pos - 15;
+    unsigned int mask=
+      block_mask (load_block (s + start), first) &
+      block_mask (load_block (s + start + k - 1), last);
+    while (mask != 0) {
+      int b= highest_bit (mask);
+      if (memcmp (s + start + b + 1, w + 1, k - 2) == 0) return start + b;
+      mask &= ~(1u << b);
+    }
+    pos -= 16;
+  }
+#endif
+  for (; pos >= 0; pos--)
+    if (s[pos] == w[0] && memcmp (s + pos + 1, w + 1, k - 1) == 0)
+      return pos;
+  return -1;
+}
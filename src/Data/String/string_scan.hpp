@@ -0,0 +1,34 @@
+
+/******************************************************************************
+* MODULE     : string_scan.hpp
+* DESCRIPTION: Vectorized scanning and substring search in character buffers
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef STRING_SCAN_H
+#define STRING_SCAN_H
+#include "string.hpp"
+
+/******************************************************************************
+* The routines below operate on a buffer s of length n and return the
+* position of the first (resp. last) match at or after (resp. at or before)
+* pos, or -1 if there is none.  Whenever the compiler targets SSE2, blocks
+* of 16 bytes are examined at once; otherwise a portable scalar version
+* is used.  For substrings, candidate positions are found by comparing
+* both the first and the last character of the pattern simultaneously.
+******************************************************************************/
+
+int find_char (const char* s, int n, int pos, char c);
+int rfind_char (const char* s, int n, int pos, char c);
+int find_chars (const char* s, int n, int pos, const char* set, int m);
+int find_substring (const char* s, int n, int pos, const char* w, int k);
+int rfind_substring (const char* s, int n, int pos, const char* w, int k);
+
+inline const char* as_buffer (string& s) {
+  return N(s) == 0? (const char*) NULL: &s[0]; }
+
+#endif // defined STRING_SCAN_H
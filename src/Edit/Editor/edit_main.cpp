@@ -57,7 +57,8 @@ editor_rep::is_current_editor () {
 }
 
 edit_main_rep::edit_main_rep (server_rep* sv, tm_buffer buf):
-  editor_rep (sv, buf), props (UNKNOWN), ed_obs (edit_observer (this))
+  editor_rep (sv, buf), props (UNKNOWN), ed_obs (edit_observer (this)),
+  snippet_level (0), snippet_env (false)
 {
 #ifdef EXPERIMENTAL
   cct= copy (subtree (et, rp));
@@ -69,6 +70,7 @@ edit_main_rep::edit_main_rep (server_rep* sv, tm_buffer buf):
 }
 
 edit_main_rep::~edit_main_rep () {
+  flush_snippets ();
   detach_observer (subtree (et, rp), ed_obs);
 #ifdef EXPERIMENTAL
   mem= memorizer ();
@@ -231,6 +233,32 @@ edit_main_rep::nr_pages () {
   return N (the_box[0]);
 }
 
+static tree
+printing_layout_env (edit_env env) {
+  // Environment variables which are modified for printing and
+  // which may affect the layout of the document
+  tree t (TUPLE, 5);
+  t[0]= env->read (DPI);
+  t[1]= env->read (PAGE_SHOW_HF);
+  t[2]= env->read (PAGE_SCREEN_MARGIN);
+  t[3]= env->read (BG_COLOR);
+  t[4]= env->read (PAGE_MEDIUM);
+  return t;
+}
+
+bool
+edit_main_rep::reuse_screen_layout (tree screen_env, bool printed_changed) {
+  // The pages on the screen can be printed as is if the document
+  // has been typeset completely in paper mode using the same settings.
+  // The page borders are only decorations around the pages and the
+  // page-printed variable can only be ignored if it was never used.
+  if (has_changed (THE_TREE + THE_ENVIRONMENT)) return false;
+  if (printing_layout_env (env) != screen_env) return false;
+  if (printed_changed && env->printed_dep) return false;
+  if (N(eb) != 1 || N(eb[0]) == 0) return false;
+  return get_preference ("reuse screen layout", "on") == "on";
+}
+
 void
 edit_main_rep::print_doc (url name, bool conform, int first, int last) {
 #ifdef USE_GS
@@ -254,6 +282,8 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
   // Set environment variables for printing
 
   typeset_prepare ();
+  tree screen_env= printing_layout_env (env);
+  bool was_printed= (env->get_string (PAGE_PRINTED) == "true");
   env->write (DPI, printing_dpi);
   env->write (PAGE_SHOW_HF, "true");
   env->write (PAGE_SCREEN_MARGIN, "false");
@@ -267,7 +297,20 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
 
   // Typeset pages for printing
 
-  box the_box= typeset_as_document (env, subtree (et, rp), reverse (rp));
+  box the_box;
+  if (reuse_screen_layout (screen_env, !conform && !was_printed)) {
+    env->style_init_env ();
+    env->update ();
+    the_box= eb;
+  }
+  else
+    the_box= typeset_as_document (env, subtree (et, rp), reverse (rp));
+  array<box> page_box (N(the_box[0]));
+  for (int i=0; i<N(page_box); i++) {
+    page_box[i]= the_box[0][i];
+    if (page_box[i]->get_type () == PAGE_BORDER_BOX)
+      page_box[i]= page_box[i][0];
+  }
 
   // Determine parameters for printer
 
@@ -278,12 +321,12 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
   bool   landsc    = env->page_landscape;
   int    dpi       = as_int (printing_dpi);
   int    start     = max (0, first-1);
-  int    end       = min (N(the_box[0]), last);
+  int    end       = min (N(page_box), last);
   int    pages     = end-start;
   if (conform) {
     page_type= "user";
-    SI bw= the_box[0][0]->w();
-    SI bh= the_box[0][0]->h();
+    SI bw= page_box[0]->w();
+    SI bh= page_box[0]->h();
     string bws= as_string (bw) * "tmpt";
     string bhs= as_string (bh) * "tmpt";
     w= env->as_length (bws);
@@ -305,9 +348,12 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
         ren->clear_pattern (0, (SI) -h, (SI) w, 0);
 
       rectangles rs;
+      SI old_x= the_box[0]->sx(i), old_y= the_box[0]->sy(i);
       the_box[0]->sx(i)= 0;
       the_box[0]->sy(i)= 0;
-      the_box[0][i]->redraw (ren, path (0), rs);
+      page_box[i]->redraw (ren, path (0), rs);
+      the_box[0]->sx(i)= old_x;
+      the_box[0]->sy(i)= old_y;
       if (i<end-1) ren->next_page ();
     }
   }
@@ -378,6 +424,65 @@ edit_main_rep::export_ps (url name, string first, string last) {
   print_doc (name, true, as_int (first), as_int (last));
 }
 
+/******************************************************************************
+* Snippets
+*******************************************************************************
+* Between begin_snippets and end_snippets, the environment is set up for
+* printing only once for all snippets.  Bitmap snippets are not rendered
+* immediately, but by groups, whose images are then encoded in parallel.
+* Until then, empty files stand for the pending images.
+******************************************************************************/
+
+#define SNIPPET_GROUP_MAX 256
+
+void
+edit_main_rep::prepare_snippets () {
+  if (snippet_env) return;
+  typeset_prepare ();
+  snippet_dpi= env->read (DPI);
+  snippet_info= env->read (INFO_FLAG);
+  env->write (DPI, printing_dpi);
+  if (is_compound (snippet_info) || !ends (snippet_info->label, "paper"))
+    env->write (INFO_FLAG, "none");
+  env->style_init_env ();
+  env->update ();
+  snippet_env= true;
+}
+
+void
+edit_main_rep::flush_snippets () {
+  int i, n= N(snippet_names);
+  if (n == 0) return;
+  array<picture> pics (n);
+  for (i=0; i<n; i++)
+    pics[i]= make_raster_picture (snippet_boxes[i], 5.0);
+  save_pictures (snippet_names, pics);
+  snippet_names= array<url> ();
+  snippet_boxes= array<box> ();
+}
+
+void
+edit_main_rep::restore_snippets () {
+  flush_snippets ();
+  if (!snippet_env) return;
+  env->write (DPI, snippet_dpi);
+  env->write (INFO_FLAG, snippet_info);
+  env->style_init_env ();
+  env->update ();
+  snippet_env= false;
+}
+
+void
+edit_main_rep::begin_snippets () {
+  snippet_level++;
+}
+
+void
+edit_main_rep::end_snippets () {
+  if (snippet_level == 0) return;
+  if (--snippet_level == 0) restore_snippets ();
+}
+
 array<int>
 edit_main_rep::print_snippet (url name, tree t, bool conserve_preamble) {
   tree buft= subtree (et, rp);
@@ -394,23 +499,17 @@ edit_main_rep::print_snippet (url name, tree t, bool conserve_preamble) {
   bool ps= (s == "ps" || s == "eps");
   if (use_pdf ()) ps= (ps || s == "pdf");
 
-  typeset_prepare ();
+  prepare_snippets ();
   int dpi= as_int (printing_dpi);
-  tree old_dpi= env->read (DPI);
-  tree old_info_flag= env->read (INFO_FLAG);
-  env->write (DPI, printing_dpi);
-  if (is_compound (old_info_flag) || !ends (old_info_flag->label, "paper"))
-    env->write (INFO_FLAG, "none");
-  env->style_init_env ();
-  env->update ();
   box b= typeset_as_box (env, t, path ());
-  env->write (DPI, old_dpi);
-  env->write (INFO_FLAG, old_info_flag);
-  env->style_init_env ();
-  env->update ();
   
   if (b->x4 - b->x3 >= 5*PIXEL && b->y4 - b->y3 >= 5*PIXEL) {
-    if (bitmap) make_raster_image (name, b, 5.0);
+    if (bitmap) {
+      snippet_names << name;
+      snippet_boxes << b;
+      if (snippet_level > 0) save_string (name, "");
+      if (N(snippet_names) >= SNIPPET_GROUP_MAX) flush_snippets ();
+    }
     else if (ps) make_eps (name, b, dpi);
     else {
       url temp= url_temp (use_pdf ()? ".pdf": ".eps");
@@ -425,12 +524,26 @@ edit_main_rep::print_snippet (url name, tree t, bool conserve_preamble) {
       ::remove (temp);
     }
   }
+  if (snippet_level == 0) restore_snippets ();
   array<int> a;
   a << b->x3 << b->y3 << b->x4 << b->y4 << b->x1 << b->y1 << b->x2 << b->y2;
   a << env->get_int (FONT_BASE_SIZE) << dpi;
   return a;
 }
 
+array<int>
+edit_main_rep::print_snippets (array<url> us, array<tree> ts,
+                               bool conserve_preamble) {
+  // the extents of all snippets are concatenated in the result
+  ASSERT (N(us) == N(ts), "arrays of the same length expected");
+  array<int> r;
+  begin_snippets ();
+  for (int i=0; i<N(us); i++)
+    r << print_snippet (us[i], ts[i], conserve_preamble);
+  end_snippets ();
+  return r;
+}
+
 bool
 edit_main_rep::graphics_file_to_clipboard (url name) {
 #ifdef QTTEXMACS
@@ -41,6 +41,16 @@ class edit_main_rep:
 private:
   hashmap<tree,tree> props;   // properties associated to the editor
   observer           ed_obs;  // edit observer attached to root of tree
+  int                snippet_level;   // nesting level of snippet batches
+  bool               snippet_env;     // environment set up for snippets ?
+  tree               snippet_dpi;     // DPI before the snippets
+  tree               snippet_info;    // INFO_FLAG before the snippets
+  array<url>         snippet_names;   // pending bitmap snippets
+  array<box>         snippet_boxes;   // and their boxes
+
+  void prepare_snippets ();
+  void flush_snippets ();
+  void restore_snippets ();
 
 public:
   edit_main_rep (server_rep* sv, tm_buffer buf);
@@ -66,11 +76,16 @@ public:
 
   string get_metadata (string kind);
   int  nr_pages ();
+  bool reuse_screen_layout (tree screen_env, bool printed_changed);
   void print_doc (url ps_name, bool to_file, int first, int last);
   void print_to_file (url ps_name, string first="1", string last="1000000");
   void print_buffer (string first="1", string last="1000000");
   void export_ps (url ps_name, string first="1", string last="1000000");
   array<int> print_snippet (url u, tree t, bool conserve_preamble);
+  array<int> print_snippets (array<url> us, array<tree> ts,
+                             bool conserve_preamble);
+  void begin_snippets ();
+  void end_snippets ();
   bool graphics_file_to_clipboard (url output);
   void footer_eval (string s);
   tree the_line ();
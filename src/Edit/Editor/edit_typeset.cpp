@@ -16,10 +16,12 @@
 #include "file.hpp"
 #include "analyze.hpp"
 #include "tm_timer.hpp"
+#include "tm_latency.hpp"
 #include "Bridge/impl_typesetter.hpp"
 #include "new_style.hpp"
 #include "iterator.hpp"
 #include "merge_sort.hpp"
+#include "Freetype/tt_file.hpp"
 #ifdef EXPERIMENTAL
 #include "../../Style/Environment/std_environment.hpp"
 #endif // EXPERIMENTAL
@@ -282,7 +284,7 @@ edit_typeset_rep::typeset_style_use_cache (tree style) {
     if (!is_tuple (style)) FAILED ("tuple expected as style");
     H= get_style_env (style);
     drd= get_style_drd (style);
-    style_set_cache (style, H, drd->get_locals ());
+    style_set_cache (style, H, drd->get_locals (), get_style_deps (style));
     env->patch_env (H);
     drd->set_environment (H);
   }
@@ -973,26 +975,33 @@ edit_typeset_rep::typeset_sub (SI& x1, SI& y1, SI& x2, SI& y2) {
   typeset_prepare ();
   eb= empty_box (reverse (rp));
   // saves memory, also necessary for change_log update
-  bench_start ("typeset");
+  {
+    TRACE_SCOPE ("typeset", "typeset");
 #ifdef USE_EXCEPTIONS
-  try {
+    try {
 #endif
-    eb= ::typeset (ttt, x1, y1, x2, y2);
+      eb= ::typeset (ttt, x1, y1, x2, y2);
 #ifdef USE_EXCEPTIONS
-  }
-  catch (string msg) {
-    the_exception= msg;
-    std_error << "Typesetting failure, resetting to empty document\n";
-    assign (rp, tree (DOCUMENT, ""));
-    ::notify_assign (ttt, path(), subtree (et, rp));
-    eb= ::typeset (ttt, x1, y1, x2, y2);    
-  }
-  handle_exceptions ();
+    }
+    catch (string msg) {
+      the_exception= msg;
+      std_error << "Typesetting failure, resetting to empty document\n";
+      assign (rp, tree (DOCUMENT, ""));
+      ::notify_assign (ttt, path(), subtree (et, rp));
+      eb= ::typeset (ttt, x1, y1, x2, y2);    
+    }
+    handle_exceptions ();
 #endif
-  bench_end ("typeset");
+  }
+  latency_mark (LATENCY_TYPESET);
+  bench_print ("typeset");
+  bench_reset ("typeset");
   //time_t t2= texmacs_time ();
   //if (t2 - t1 >= 10) cout << "typeset took " << t2-t1 << "ms\n";
   picture_cache_clean ();
+#ifdef USE_FREETYPE
+  tt_face_clean ();
+#endif
 }
 
 static void
@@ -1075,6 +1084,7 @@ edit_typeset_rep::typeset_invalidate_all () {
   //cout << "Invalidate all\n";
   notify_change (THE_ENVIRONMENT);
   typeset_preamble ();
+  env->printed_dep= false;
   ::notify_assign (ttt, path(), subtree (et, rp));
 }
 
@@ -674,6 +674,7 @@ edit_interface_rep::find_alt_selection_index
 
 void
 edit_interface_rep::apply_changes () {
+  TRACE_SCOPE ("typeset", "apply changes");
   //cout << "Apply changes\n";
   //cout << "et= " << et << "\n";
   //cout << "tp= " << tp << "\n";
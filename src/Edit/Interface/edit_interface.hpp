@@ -215,6 +215,9 @@ public:
   void handle_set_zoom_factor (double zoomf);
   void handle_clear (renderer win, SI x1, SI y1, SI x2, SI y2);
   void handle_repaint (renderer win, SI x1, SI y1, SI x2, SI y2);
+  void replay_key_press (string key);
+  void replay_changes ();
+  void replay_repaint (rectangle r);
 
   friend class interactive_command_rep;
   friend class tm_window_rep;
@@ -13,6 +13,7 @@
 #include "analyze.hpp"
 #include "tm_buffer.hpp"
 #include "archiver.hpp"
+#include "tm_latency.hpp"
 
 #ifdef Q_OS_MAC
 #include "Plugins/Qt/QTMApplication.hpp"
@@ -353,6 +354,7 @@ void
 edit_interface_rep::handle_keypress (string key, time_t t) {
   if (is_nil (buf)) return;
   if (t > last_event) last_event= t;
+  if (!starts (key, "pre-edit:")) latency_key (key);
   bool started= false;
 #ifdef USE_EXCEPTIONS
   try {
@@ -394,6 +396,7 @@ edit_interface_rep::handle_keypress (string key, time_t t) {
       call ("link-follow-ids", object (focus_ids), object ("focus"));
     notify_change (THE_DECORATIONS);
     end_editing ();
+    latency_mark (LATENCY_MODIFY);
     //time_t t2= texmacs_time ();
     //if (t2 - t1 >= 10) cout << "handle_keypress took " << t2-t1 << "ms\n";
 #ifdef USE_EXCEPTIONS
@@ -408,6 +411,32 @@ edit_interface_rep::handle_keypress (string key, time_t t) {
 #endif
 }
 
+void
+edit_interface_rep::replay_key_press (string key) {
+  // Without a window, there is no event loop which applies the changes
+  // after a key press, so we typeset and repaint ourselves
+  if (is_nil (eb)) replay_changes ();
+  handle_keypress (key, texmacs_time ());
+  replay_changes ();
+}
+
+void
+edit_interface_rep::replay_changes () {
+  SI x1= 0, y1= 0, x2= 0, y2= 0;
+  if (is_nil (eb) || (env_change & (THE_TREE+THE_ENVIRONMENT))) {
+    typeset_invalidate_env ();
+    typeset (x1, y1, x2, y2);
+  }
+  go_to_here ();
+  env_change= 0;
+  cursor cu= get_cursor ();
+  SI P3= 3*pixel;
+  rectangle r (cu->ox - P3, cu->oy + cu->y1 - P3,
+               cu->ox + P3, cu->oy + cu->y2 + P3);
+  if (x1 < x2 && y1 < y2) r= least_upper_bound (r, rectangle (x1, y1, x2, y2));
+  replay_repaint (r);
+}
+
 void drag_left_reset ();
 void drag_right_reset ();
 
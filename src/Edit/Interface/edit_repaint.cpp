@@ -12,6 +12,7 @@
 #include "Interface/edit_interface.hpp"
 #include "message.hpp"
 #include "gui.hpp" // for gui_interrupted
+#include "tm_latency.hpp"
 
 extern int nr_painted;
 extern void clear_pattern_rectangles (renderer ren, rectangle m, rectangles l);
@@ -381,6 +382,7 @@ edit_interface_rep::handle_clear (renderer win, SI x1, SI y1, SI x2, SI y2) {
 
 void
 edit_interface_rep::handle_repaint (renderer win, SI x1, SI y1, SI x2, SI y2) {
+  TRACE_SCOPE ("repaint", "repaint");
   if (is_nil (eb)) apply_changes ();
   if (env_change != 0) {
     std_warning << "Invalid situation (" << env_change << ")"
@@ -404,5 +406,26 @@ edit_interface_rep::handle_repaint (renderer win, SI x1, SI y1, SI x2, SI y2) {
   draw_with_stored (win, rectangle (x1, y1, x2, y2) /magf);
   if (last_change-last_update > 0)
     last_change = texmacs_time ();
+  latency_mark (LATENCY_REPAINT);
   // cout << "Repainted\n";
 }
+
+void
+edit_interface_rep::replay_repaint (rectangle r) {
+  // Offscreen repaint of a region of the document, at most as large as
+  // a screen, for measuring key press latencies without a window
+  TRACE_SCOPE ("repaint", "replay repaint");
+  SI px= (SI) (std_shrinkf * PIXEL / zoomf);
+  SI x1= r->x1, y2= r->y2;
+  SI x2= min (r->x2, x1 + 2048 * px);
+  SI y1= max (r->y1, y2 - 1536 * px);
+  int w= max ((x2 - x1 + px - 1) / px, 1);
+  int h= max ((y2 - y1 + px - 1) / px, 1);
+  picture pic= native_picture (w, h, -x1 / px, -y2 / px);
+  renderer ren= picture_renderer (pic, zoomf);
+  rectangles l;
+  draw_background (ren, x1, y1, x2, y2);
+  draw_text (ren, l);
+  tm_delete (ren);
+  latency_mark (LATENCY_REPAINT);
+}
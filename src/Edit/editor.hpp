@@ -186,6 +186,7 @@ public:
   virtual void interrupt_shortcut () = 0;
   virtual bool kbd_get_command (string cmd_s, string& help, command& cmd) = 0;
   virtual void key_press (string key) = 0;
+  virtual void replay_key_press (string key) = 0;
   virtual void emulate_keyboard (string keys, string action= "") = 0;
   virtual bool complete_try () = 0;
   virtual void complete_start (string prefix, array<string> compls) = 0;
@@ -599,6 +600,10 @@ public:
   virtual void export_ps (url ps_name,
 			  string first="1", string last="1000000") = 0;
   virtual array<int> print_snippet (url u, tree t, bool conserve_preamble) = 0;
+  virtual array<int> print_snippets (array<url> us, array<tree> ts,
+                                     bool conserve_preamble) = 0;
+  virtual void begin_snippets () = 0;
+  virtual void end_snippets () = 0;
   virtual bool graphics_file_to_clipboard (url output) = 0;
   virtual void footer_eval (string s) = 0;
   virtual tree the_line () = 0;
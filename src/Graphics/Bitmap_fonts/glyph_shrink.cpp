@@ -11,6 +11,11 @@
 
 #include "bitmap_font.hpp"
 #include "renderer.hpp"
+#include <string.h>
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define SHRINK_SSE2
+#endif
 
 static int
 log2i (int i) {
@@ -41,25 +46,98 @@ my_norm (int a, int m) {
   else return m-a;
 }
 
+/******************************************************************************
+* Row operations on unpacked bitmaps
+******************************************************************************/
+
+static unsigned char unpacked_byte[256][8];
+
+static void
+init_unpacked_bytes () {
+  static bool done= false;
+  if (done) return;
+  for (int c=0; c<256; c++)
+    for (int i=0; i<8; i++)
+      unpacked_byte[c][i]= (c >> i) & 1;
+  done= true;
+}
+
+static void
+unpack_row (glyph_rep* gl, int y, unsigned char* row) {
+  // row[x] becomes gl->get_1 (x, y) for 0 <= x < gl->width
+  int x= 0, w= gl->width, bit= y*w;
+  init_unpacked_bytes ();
+  for (; x<w && (bit&7) != 0; x++, bit++)
+    row[x]= (gl->raster[bit>>3] >> (bit&7)) & 1;
+  for (; x+8 <= w; x+=8, bit+=8)
+    memcpy (row + x, unpacked_byte[gl->raster[bit>>3]], 8);
+  for (; x<w; x++, bit++)
+    row[x]= (gl->raster[bit>>3] >> (bit&7)) & 1;
+}
+
+static void
+or_row (unsigned char* dest, const unsigned char* src, int n) {
+  int i= 0;
+#ifdef SHRINK_SSE2
+  for (; i+16 <= n; i+=16) {
+    __m128i a= _mm_loadu_si128 ((const __m128i*) (dest + i));
+    __m128i b= _mm_loadu_si128 ((const __m128i*) (src + i));
+    _mm_storeu_si128 ((__m128i*) (dest + i), _mm_or_si128 (a, b));
+  }
+#endif
+  for (; i<n; i++) dest[i] |= src[i];
+}
+
+static void
+add_row (unsigned char* dest, const unsigned char* src, int n) {
+  int i= 0;
+#ifdef SHRINK_SSE2
+  for (; i+16 <= n; i+=16) {
+    __m128i a= _mm_loadu_si128 ((const __m128i*) (dest + i));
+    __m128i b= _mm_loadu_si128 ((const __m128i*) (src + i));
+    _mm_storeu_si128 ((__m128i*) (dest + i), _mm_add_epi8 (a, b));
+  }
+#endif
+  for (; i<n; i++) dest[i] += src[i];
+}
+
+static void
+dilate_row (unsigned char* dest, const unsigned char* src, int n, int t) {
+  // dest[x] becomes 1 whenever one of src[x-t], ..., src[x] is set
+  memcpy (dest, src, n);
+  for (int k=1; k<=t; k++)
+    or_row (dest + k, src, n - k);
+}
+
+/******************************************************************************
+* Determine the optimal shift for glyphs with vertical or horizontal stems
+******************************************************************************/
+
 int
 get_hor_shift (glyph gl, int xfactor, int tx) {
   STACK_NEW_ARRAY (flag, bool, gl->width);
+  STACK_NEW_ARRAY (row, unsigned char, gl->width);
+  STACK_NEW_ARRAY (count, int, gl->width);
+  STACK_NEW_ARRAY (max_count, int, gl->width);
 
-  // cout << "[";
-  int x;
-  for (x=0; x<gl->width; x++) {
-    int max_count= 0, count=0, y;
-    for (y=0; y<gl->height; y++)
-      if (gl->get_1 (x,y)) count++;
+  // longest vertical run in each column, computed row by row
+  int x, y;
+  for (x=0; x<gl->width; x++) count[x]= max_count[x]= 0;
+  for (y=0; y<gl->height; y++) {
+    unpack_row (gl.rep, y, row);
+    for (x=0; x<gl->width; x++)
+      if (row[x] != 0) count[x]++;
       else {
-	max_count = max (max_count, count);
-	count     = 0;
+	max_count[x]= max (max_count[x], count[x]);
+	count[x]    = 0;
       }
-    max_count= max (max_count, count);
-    flag[x]= (max_count>(gl->height>>1));
-    // if (flag[x]) cout << "*"; else cout << " ";
   }
-  // cout << "]   ";
+  for (x=0; x<gl->width; x++)
+    flag[x]= (max (max_count[x], count[x]) > (gl->height>>1));
+
+  STACK_DELETE_ARRAY (max_count);
+  STACK_DELETE_ARRAY (count);
+  STACK_DELETE_ARRAY (row);
 
   int first0=-1, first1=-1, last0=-1, last1=-1;
   for (x=0; x<gl->width; x++)
@@ -98,22 +176,23 @@ get_hor_shift (glyph gl, int xfactor, int tx) {
 int
 get_ver_shift (glyph gl, int yfactor, int ty) {
   STACK_NEW_ARRAY (flag, bool, gl->height);
+  STACK_NEW_ARRAY (row, unsigned char, gl->width);
 
-  // cout << "[";
   int y;
   for (y=0; y<gl->height; y++) {
     int max_count= 0, count=0, x;
+    unpack_row (gl.rep, y, row);
     for (x=0; x<gl->width; x++)
-      if (gl->get_1 (x,y)) count++;
+      if (row[x] != 0) count++;
       else {
 	max_count = max (max_count, count);
 	count     = 0;
       }
     max_count= max (max_count, count);
     flag[y]= (max_count>(gl->width>>1));
-    // if (flag[y]) cout << "*"; else cout << " ";
   }
-  // cout << "]   ";
+
+  STACK_DELETE_ARRAY (row);
 
   int first0=-1, first1=-1, last0=-1, last1=-1;
   for (y=0; y<gl->height; y++)
@@ -176,40 +255,52 @@ shrink (glyph gl, int xfactor, int yfactor,
   SI  off_x = (((-X1) *xfactor+ dx)*PIXEL + ((tx*PIXEL)>>1))/xfactor;
   SI  off_y = (((Y2-1)*yfactor- dy)*PIXEL - ((ty*PIXEL)>>1))/yfactor;
 
-  int i, j, x, y;
-  int index, indey, entry;
+  // Coverage of the dilated glyph, with one byte per pixel and one
+  // unpacked and horizontally dilated source row stamped ty+1 times
+  int j, y;
   int ww=(X2-X1)*xfactor, hh=(Y2-Y1)*yfactor;
-  int* bitmap= tm_new_array<int> (ww*hh);
-  //STACK_NEW_ARRAY (bitmap, int, ww*hh);
-  for (i=0; i<ww*hh; i++) bitmap[i]=0;
-  for (y=0, index= ww*frac_y+ frac_x; y<gl->height; y++, index-=ww)
-    for (x=0; x<gl->width; x++)
-      if (gl->get_1(x,y))
-        for (j=0, indey=ww*ty; j<=ty; j++, indey-=ww) {
-	  entry = index+indey+x;
-	  for (i=0; i<=tx; i++, entry++)
-	    bitmap[entry]= 1;
-	}
+  int rw= gl->width+ tx;
+  unsigned char* bitmap= tm_new_array<unsigned char> (ww*hh);
+  unsigned char* bits  = tm_new_array<unsigned char> (rw);
+  unsigned char* row   = tm_new_array<unsigned char> (max (rw, ww));
+  memset (bitmap, 0, ww*hh);
+  memset (bits, 0, rw);
+  for (y=0; y<gl->height; y++) {
+    unpack_row (gl.rep, y, bits);
+    dilate_row (row, bits, rw, tx);
+    int index= ww*(frac_y- y)+ frac_x;
+    for (j=0; j<=ty; j++)
+      or_row (bitmap + index + ww*(ty-j), row, rw);
+  }
 
+  // Box filter: sum yfactor rows bytewise, then groups of xfactor columns
   int X, Y, sum, nr= xfactor*yfactor;
   int new_depth= gl->depth+ log2i (nr);
   if (new_depth > 8) new_depth= 8;
+  ASSERT (yfactor < 256, "too large shrinking factor");
   glyph CB (X2-X1, Y2-Y1, -X1, Y2-1, new_depth, gl->status);
   CB->index = gl->index;
-  for (Y=Y1; Y<Y2; Y++)
+  for (Y=Y1; Y<Y2; Y++) {
+    memset (row, 0, ww);
+    for (j=0; j<yfactor; j++) {
+      int r= (Y-Y1)*xfactor+ j;
+      if (r < hh) add_row (row, bitmap + r*ww, ww);
+    }
+    QN* dest= CB->raster + (Y2-1-Y)*CB->width;
     for (X=X1; X<X2; X++) {
+      const unsigned char* col= row + (X-X1)*xfactor;
       sum=0;
-      indey= ((Y-Y1)*ww+ (X-X1))*xfactor;
-      for (j=0, index= indey; j<yfactor; j++, index+=ww)
-	for (i=0; i<xfactor; i++)
-	  sum += bitmap[index+ i];
+      for (int i=0; i<xfactor; i++) sum += col[i];
       if (nr >= 64) sum= (64 * sum) / nr;
-      CB->set (X, Y, sum);
+      if (new_depth == 1) CB->set (X, Y, sum);
+      else dest[X-X1]= (QN) sum;
     }
+  }
+  tm_delete_array (row);
+  tm_delete_array (bits);
+  tm_delete_array (bitmap);
   xo= off_x;
   yo= off_y;
-  tm_delete_array (bitmap);
-  //STACK_DELETE_ARRAY (bitmap);
 
   // cout << CB << "\n";
   return CB;
@@ -208,10 +208,8 @@ find_font_bis (tree t) {
 
 font
 find_font (tree t) {
-  bench_start ("find font");
-  font fn= find_font_bis (t);
-  bench_cumul ("find font");
-  return fn;
+  TRACE_SCOPE ("font", "find font");
+  return find_font_bis (t);
 }
 
 font
@@ -235,6 +235,9 @@ extern bool new_fonts;
 void set_new_fonts (bool new_val);
 bool get_new_fonts ();
 void font_database_build (url u);
+tree font_file_stamp (url u);
+bool font_file_outdated (url u, tree stamp, hashmap<tree,tree> stamps,
+                         hashmap<string,bool> referenced);
 void font_database_build_local ();
 void font_database_extend_local (url u);
 void font_database_build_global ();
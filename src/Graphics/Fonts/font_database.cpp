@@ -10,6 +10,7 @@
 ******************************************************************************/
 
 #include "font.hpp"
+#include "boot.hpp"
 #include "iterator.hpp"
 #include "file.hpp"
 #include "convert.hpp"
@@ -18,6 +19,13 @@
 #include "Freetype/tt_tools.hpp"
 #include "Metafont/tex_files.hpp"
 #include "data_cache.hpp"
+#ifndef OS_MINGW
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+#ifdef OS_GNU_LINUX
+#include <dirent.h>
+#endif
 
 void font_database_filter_features ();
 void font_database_filter_characteristics ();
@@ -32,6 +40,7 @@ static array<string> font_database_families (hashmap<tree,tree> ftab);
 #define LOCAL_FEATURES "$TEXMACS_HOME_PATH/fonts/font-features.scm"
 #define LOCAL_CHARACTERISTICS \
   "$TEXMACS_HOME_PATH/fonts/font-characteristics.scm"
+#define LOCAL_STAMPS "$TEXMACS_HOME_PATH/fonts/font-stamps.scm"
 #define DELTA_DATABASE "$TEXMACS_HOME_PATH/fonts/delta-database.scm"
 #define DELTA_FEATURES "$TEXMACS_HOME_PATH/fonts/delta-features.scm"
 #define DELTA_CHARACTERISTICS \
@@ -262,10 +271,108 @@ font_database_save () {
   font_database_save_characteristics (LOCAL_CHARACTERISTICS);
 }
 
+/******************************************************************************
+* Parallel processing of font files
+*******************************************************************************
+* Scanning and analyzing large collections of fonts is done by a pool of
+* forked worker processes, each with its own copy of the FreeType library
+* and the font caches.  Each worker handles a share of the tasks and sends
+* its results back through a temporary file; tasks for which no result
+* came back are redone in the main process.
+*
+* A forked process only inherits the calling thread: locks which are held
+* by other threads at the time of the fork (in the allocator, Qt or the
+* background writer, say) remain locked forever in the workers.  We
+* therefore only fork in headless runs in which no other thread exists,
+* which can only be checked on GNU/Linux.  Rebuilds from an interactive
+* session are done sequentially; a parallel rebuild of the local database
+* can be obtained with texmacs -headless -x "(font-database-build-local)".
+******************************************************************************/
+
+typedef tree (*font_task) (string);
+
+static bool
+font_database_may_fork () {
+  if (!headless_mode) return false;
+#ifdef OS_GNU_LINUX
+  DIR* dir= opendir ("/proc/self/task");
+  if (dir == NULL) return false;
+  int nr= 0;
+  struct dirent* e;
+  while ((e= readdir (dir)) != NULL)
+    if (e->d_name[0] != '.') nr++;
+  closedir (dir);
+  return nr == 1;
+#else
+  // no portable way to count the threads of the process
+  return false;
+#endif
+}
+
+static int
+font_database_workers (int n) {
+#ifdef OS_MINGW
+  (void) n;
+  return 1;
+#else
+  int nr= (int) sysconf (_SC_NPROCESSORS_ONLN);
+  return max (1, min (min (nr, 16), n / 4));
+#endif
+}
+
+static array<tree>
+font_database_map (array<string> args, font_task task) {
+  int i, w, n= N(args);
+  array<tree> r (n);
+  array<bool> done (n);
+  for (i=0; i<n; i++) done[i]= false;
+#ifndef OS_MINGW
+  int nr= font_database_may_fork ()? font_database_workers (n): 1;
+  if (nr > 1) {
+    array<url> files (nr);
+    array<int> pids (nr);
+    cout.flush ();
+    for (w=0; w<nr; w++) {
+      files[w]= url_temp (".scm");
+      pids[w]= fork ();
+      if (pids[w] == 0) { // the worker
+        tree t (TUPLE);
+        for (i=w; i<n; i+=nr)
+          t << tuple (as_string (i), task (args[i]));
+        bool err= save_string (files[w], scheme_tree_to_block (t));
+        cout.flush ();
+        _exit (err? 1: 0);
+      }
+    }
+    for (w=0; w<nr; w++) {
+      int status= 0;
+      if (pids[w] <= 0 || waitpid (pids[w], &status, 0) != pids[w]) continue;
+      string s;
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0 &&
+          !load_string (files[w], s, false)) {
+        tree t= block_to_scheme_tree (s);
+        for (int k=0; k<N(t); k++)
+          if (is_func (t[k], TUPLE, 2) && is_atomic (t[k][0])) {
+            i= as_int (t[k][0]);
+            if (i >= 0 && i < n) { r[i]= t[k][1]; done[i]= true; }
+          }
+      }
+      remove (files[w]);
+    }
+  }
+#endif
+  for (i=0; i<n; i++)
+    if (!done[i]) r[i]= task (args[i]);
+  return r;
+}
+
 /******************************************************************************
 * Building the database
 ******************************************************************************/
 
+static bool font_incremental= false;
+static hashmap<tree,tree> font_stamps (UNINIT);
+
 bool
 on_blacklist (string name) {
   return
@@ -278,12 +385,12 @@ on_blacklist (string name) {
     starts (name, "FonetikaDania");
 }
 
-void
-font_database_build (url u) {
+static void
+font_database_files (url u, array<url>& files) {
   if (is_none (u));
   else if (is_or (u)) {
-    font_database_build (u[1]);
-    font_database_build (u[2]);
+    font_database_files (u[1], files);
+    font_database_files (u[2], files);
   }
   else if (is_directory (u)) {
     bool err;
@@ -293,27 +400,123 @@ font_database_build (url u) {
         if (ends (a[i], ".ttf") ||
             ends (a[i], ".ttc") ||
             ends (a[i], ".otf"))
-          font_database_build (u * url (a[i]));
+          font_database_files (u * url (a[i]), files);
   }
   else if (is_regular (u)) {
     if (on_blacklist (as_string (tail (u)))) return;
-    cout << "Process " << u << "\n";
-    scheme_tree t= tt_font_name (u);
+    files << u;
+  }
+}
+
+tree
+font_file_stamp (url u) {
+  return tuple (as_string (file_size (u)),
+                as_string (last_modified (u, false)));
+}
+
+bool
+font_file_outdated (url u, tree stamp, hashmap<tree,tree> stamps,
+                    hashmap<string,bool> referenced) {
+  // files whose size or modification time changed since the last build
+  // and files which no longer occur in the database need to be rescanned;
+  // files without any font names are marked as such in their stamps
+  string name= as_string (u);
+  if (!stamps->contains (name)) return true;
+  tree old= stamps [name];
+  if (N(old) == 3 && old[2] == "unnamed") return old (0, 2) != stamp;
+  string ref = as_string (tail (u)) * ":" * as_string (stamp[0]);
+  return old != stamp || !referenced [ref];
+}
+
+static tree
+font_file_names (string name) {
+  return tt_font_name (url_system (name));
+}
+
+static hashmap<string,bool>
+font_database_referenced () {
+  // files which occur in the database, together with their sizes
+  hashmap<string,bool> r (false);
+  iterator<tree> it= iterate (font_table);
+  while (it->busy ()) {
+    tree im= font_table [it->next ()];
+    if (!is_tuple (im)) continue;
+    for (int i=0; i<N(im); i++)
+      if (is_func (im[i], TUPLE, 3) && is_atomic (im[i][0]))
+        r (as_string (im[i][0]) * ":" * as_string (im[i][2]))= true;
+  }
+  return r;
+}
+
+void
+font_database_build (url u) {
+  // In incremental mode, only rescan outdated files
+  array<url> files;
+  font_database_files (u, files);
+  hashmap<string,bool> referenced (false);
+  if (font_incremental) referenced= font_database_referenced ();
+
+  array<url> todo;
+  array<string> names;
+  array<tree> stamps;
+  for (int i=0; i<N(files); i++) {
+    tree stamp= font_file_stamp (files[i]);
+    string name= as_string (files[i]);
+    if (font_incremental &&
+        !font_file_outdated (files[i], stamp, font_stamps, referenced))
+      continue;
+    cout << "Process " << files[i] << "\n";
+    todo << files[i];
+    names << name;
+    stamps << stamp;
+  }
+
+  array<tree> r= font_database_map (names, font_file_names);
+  for (int k=0; k<N(todo); k++) {
+    url  u = todo[k];
+    tree t = r[k];
+    bool changed= font_stamps->contains (names[k]);
+    bool named= false;
     for (int i=0; i<N(t); i++)
       if (is_func (t[i], TUPLE, 2) &&
           is_atomic (t[i][0]) &&
           is_atomic (t[i][1]))
         {
-          int  sz = file_size (u);
           tree key= t[i];
-          tree im = tuple (as_string (tail (u)), as_string (i), as_string (sz));
+          tree im = tuple (as_string (tail (u)), as_string (i), stamps[k][0]);
           tree all= tree (TUPLE);
           if (font_table->contains (key))
             all= font_table [key];
           tuple_insert (all, im);
           font_table (key)= all;
+          if (font_incremental && changed)
+            font_characteristics->reset (key);
+          named= true;
         }
+    if (named) font_stamps (names[k])= stamps[k];
+    else font_stamps (names[k])= tuple (stamps[k][0], stamps[k][1], "unnamed");
+  }
+}
+
+static void
+font_database_load_stamps () {
+  font_stamps= hashmap<tree,tree> (UNINIT);
+  font_database_load_database (LOCAL_STAMPS, font_stamps);
+  font_incremental= true;
+}
+
+static void
+font_database_save_stamps () {
+  array<scheme_tree> r;
+  iterator<tree> it= iterate (font_stamps);
+  while (it->busy ()) {
+    tree key= it->next ();
+    r << tuple (key, font_stamps [key]);
   }
+  merge_sort_leq<scheme_tree,font_less_eq_operator> (r);
+  save_string (LOCAL_STAMPS, scheme_tree_to_block (tree (TUPLE, r)));
+  font_stamps= hashmap<tree,tree> (UNINIT);
+  font_incremental= false;
 }
 
 static void
@@ -331,20 +534,24 @@ font_database_guess_features () {
 void
 font_database_build_local () {
   font_database_load ();
+  font_database_load_stamps ();
   font_database_build (tt_font_path ());
   font_database_build_characteristics (false);
   font_database_guess_features ();
   font_database_save ();
+  font_database_save_stamps ();
 }
 
 void
 font_database_extend_local (url u) {
   tt_extend_font_path (u);
   font_database_load ();
+  font_database_load_stamps ();
   font_database_build (u);
   font_database_build_characteristics (false);
   font_database_guess_features ();
   font_database_save ();
+  font_database_save_stamps ();
 }
 
 void
@@ -571,16 +778,31 @@ font_database_filter_characteristics () {
 * Additional font characteristics (automatically generated)
 ******************************************************************************/
 
+static tree
+font_analyze (string name) {
+  array<string> a= tt_analyze (name);
+  tree t (TUPLE, N(a));
+  for (int j=0; j<N(a); j++) t[j]= a[j];
+  return t;
+}
+
 void
 font_database_build_characteristics (bool force) {
+  // First determine the font file to be analyzed for each entry
+  // (the first existing one, or the last one when forced),
+  // then analyze all selected files in parallel
+  array<tree> keys;
+  array<string> names;
   iterator<tree> it= iterate (font_table);
   while (it->busy ()) {
     tree key= it->next ();
     tree im = font_table[key];
     if (!(is_func (key, TUPLE) && N(key) >= 2)) continue;
+    if (!force && font_characteristics->contains (key)) continue;
     cout << "Analyzing " << key[0] << " " << key[1] << "\n";
+    string found;
     for (int i=0; i<N(im); i++)
-      if (force || !font_characteristics->contains (key))
+      if (force || found == "")
         if (is_func (im[i], TUPLE, 3)) {
           string name= as_string (im[i][0]);
           string nr  = as_string (im[i][1]);
@@ -593,15 +815,19 @@ font_database_build_characteristics (bool force) {
             name= name (0, N(name)-4);
             if (!tt_font_exists (name) && ends (name, "10"))
               name= name (0, N(name)-2);
-            if (tt_font_exists (name)) {
-              array<string> a= tt_analyze (name);
-              cout << name << " ~> " << a << "\n";
-              tree t (TUPLE, N(a));
-              for (int j=0; j<N(a); j++) t[j]= a[j];
-              font_characteristics (key)= t;
-            }
+            if (tt_font_exists (name)) found= name;
           }
         }
+    if (found != "") {
+      keys << key;
+      names << found;
+    }
+  }
+
+  array<tree> r= font_database_map (names, font_analyze);
+  for (int k=0; k<N(keys); k++) {
+    cout << names[k] << " ~> " << r[k] << "\n";
+    font_characteristics (keys[k])= r[k];
   }
 }
 
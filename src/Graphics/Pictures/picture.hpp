@@ -86,6 +86,7 @@ picture cached_load_picture (url u, int w, int h, tree eff,
                              int pixel, bool perma= true);
 string picture_as_eps (picture pic, int dpi);
 void save_picture (url dest, picture p);
+void save_pictures (array<url> dests, array<picture> ps);
 
 /******************************************************************************
 * Drawing on pictures and combining pictures
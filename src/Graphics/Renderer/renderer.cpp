@@ -329,6 +329,13 @@ abs_outer_round (SI& x1, SI& y1, SI& x2, SI& y2) {
 * Default property selection and rendering routines
 ******************************************************************************/
 
+void
+renderer_rep::draw_glyphs (array<int> cs, font_glyphs fn, array<SI> xs, SI y) {
+  // draw a run of glyphs on the same baseline
+  for (int i=0; i<N(cs); i++)
+    draw (cs[i], fn, xs[i], y);
+}
+
 void
 renderer_rep::draw_triangle (SI x1, SI y1, SI x2, SI y2, SI x3, SI y3) {
   array<SI> x (3), y (3);
@@ -565,5 +572,11 @@ save_picture (url dest, picture p) {
   FAILED ("not yet implemented");
 }
 
+void
+save_pictures (array<url> dests, array<picture> ps) {
+  for (int i=0; i<N(ps); i++)
+    save_picture (dests[i], ps[i]);
+}
+
 #endif
 #endif
@@ -99,6 +99,7 @@ public:
 
   /* drawing */
   virtual void draw (int char_code, font_glyphs fn, SI x, SI y) = 0;
+  virtual void draw_glyphs (array<int> cs, font_glyphs fn, array<SI> xs, SI y);
   virtual void line (SI x1, SI y1, SI x2, SI y2) = 0;
   virtual void lines (array<SI> x, array<SI> y) = 0;
   virtual void clear (SI x1, SI y1, SI x2, SI y2) = 0;
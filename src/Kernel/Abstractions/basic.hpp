@@ -13,6 +13,7 @@
 #define BASIC_H
 #include "fast_alloc.hpp"
 #include <math.h>
+#include <type_traits>
 
 #ifdef HAVE_INTPTR_T
 #ifdef HAVE_INTTYPES_H
@@ -119,6 +120,10 @@ inline SI min (SI i, SI j) { if (i<j) return i; else return j; }
 inline SI max (SI i, SI j) { if (i>j) return i; else return j; }
 inline DI min (DI i, DI j) { if (i<j) return i; else return j; }
 inline DI max (DI i, DI j) { if (i>j) return i; else return j; }
+inline DI min (SI i, DI j) { if (i<j) return i; else return j; }
+inline DI max (SI i, DI j) { if (i>j) return i; else return j; }
+inline DI min (DI i, SI j) { if (i<j) return i; else return j; }
+inline DI max (DI i, SI j) { if (i>j) return i; else return j; }
 inline double min (double i, double j) { if (i<j) return i; else return j; }
 inline double max (double i, double j) { if (i>j) return i; else return j; }
 inline int hash (int i) { return i; }
@@ -188,6 +193,19 @@ struct abstract_struct {
   virtual inline ~abstract_struct () { TM_DEBUG(abstract_count--); }
 };
 
+/******************************************************************************
+* relocatable types
+*******************************************************************************
+* Objects of a relocatable type can be moved to another address by copying
+* their bytes, without calling their copy constructor and destructor.
+* Besides trivially copyable types, this holds for the reference counted
+* handles whose only member is a pointer to their representation, which
+* declare themselves relocatable by specializing the template below.
+******************************************************************************/
+
+template<class T> struct relocatable {
+  static const bool value= std::is_trivially_copyable<T>::value; };
+
 /******************************************************************************
 * indirect structures
 ******************************************************************************/
@@ -12,47 +12,94 @@
 #ifndef ARRAY_CC
 #define ARRAY_CC
 #include "array.hpp"
+#include <new>
+#include <string.h>
 
 /******************************************************************************
 * Routines intern to the array<T> class
 ******************************************************************************/
 
-inline int
-round_length (int n, size_t s) {
+inline DI
+round_length (DI n, size_t s) {
   (void) s;
   if (n<6) return n;
-  int i=8;
+  DI i=8;
   while (n>i) i<<=1;
   return i;
 }
 
+template<class T> inline T*
+array_alloc (DI l) {
+  if (l == 0) return (T*) NULL;
+  return (T*) fast_alloc (l * sizeof (T));
+}
+
+template<class T> inline void
+array_free (T* a, DI l) {
+  if (l != 0) fast_free ((void*) a, l * sizeof (T));
+}
+
+template<class T>
+array_rep<T>::array_rep (DI n2):
+  n (n2), l (round_length (n2, sizeof (T))), a (array_alloc<T> (l))
+{
+  for (DI i=0; i<n; i++) (void) new ((void*) (a+i)) T ();
+}
+
 template<class T>
-array_rep<T>::array_rep (int n2):
-  n(n2), a((n==0)?((T*) NULL):(tm_new_array<T> (round_length(n, sizeof (T))))) {}
+array_rep<T>::~array_rep () {
+  for (DI i=0; i<n; i++) a[i].~T ();
+  array_free (a, l);
+}
 
 template<class T> void
-array_rep<T>::resize (int m) {
-  int nn= round_length (n, sizeof (T));
-  int mm= round_length (m, sizeof (T));
-  if (mm != nn) {
-    if (mm != 0) {
-      int i, k= (m<n? m: n);
-      T* b= tm_new_array<T> (mm);
-      for (i=0; i<k; i++) b[i]= a[i];
-      if (nn != 0) tm_delete_array (a);
-      a= b;
-    }
-    else {
-      if (nn != 0) tm_delete_array (a);
-      a= NULL;
+array_rep<T>::reallocate (DI l2) {
+  // move the elements to a new block of memory for l2 >= n elements
+  T* b= array_alloc<T> (l2);
+  if (relocatable<T>::value)
+    memcpy ((void*) b, (void*) a, n * sizeof (T));
+  else
+    for (DI i=0; i<n; i++) {
+      (void) new ((void*) (b+i)) T (a[i]);
+      a[i].~T ();
     }
+  array_free (a, l);
+  a= b;
+  l= l2;
+}
+
+template<class T> void
+array_rep<T>::resize (DI m) {
+  if (m < n) {
+    for (DI i=m; i<n; i++) a[i].~T ();
+    n= m;
+    if (m == 0) { array_free (a, l); a= NULL; l= 0; }
+    else if (4 * round_length (m, sizeof (T)) <= l)
+      reallocate (round_length (m, sizeof (T)));
+  }
+  else if (m > n) {
+    if (m > l) reallocate (round_length (m, sizeof (T)));
+    for (DI i=n; i<m; i++) (void) new ((void*) (a+i)) T ();
+    n= m;
+  }
+}
+
+template<class T> void
+array_rep<T>::reserve (DI m) {
+  if (m > l) reallocate (m);
+}
+
+template<class T> void
+array_rep<T>::shrink () {
+  if (n < l) {
+    if (n == 0) { array_free (a, l); a= NULL; l= 0; }
+    else reallocate (n);
   }
-  n= m;
 }
 
 template<class T>
-array<T>::array (T* a, int n) {
-  int i;
+array<T>::array (T* a, DI n) {
+  DI i;
   rep= tm_new<array_rep<T> > (n);
   for (i=0; i<n; i++)
     rep->a[i]=a[i];
@@ -98,7 +145,7 @@ array<T>::array (T x1, T x2, T x3, T x4, T x5) {
 
 template<class T> bool
 operator == (array<T> a, array<T> b) {
-  int i;
+  DI i;
   if (N(a)!=N(b)) return false;
   for (i=0; i<N(a); i++)
     if (a[i]!=b[i]) return false;
@@ -107,7 +154,7 @@ operator == (array<T> a, array<T> b) {
 
 template<class T> bool
 operator != (array<T> a, array<T> b) {
-  int i;
+  DI i;
   if (N(a)!=N(b)) return true;
   for (i=0; i<N(a); i++)
     if (a[i]!=b[i]) return true;
@@ -116,7 +163,7 @@ operator != (array<T> a, array<T> b) {
 
 template<class T> tm_ostream&
 operator << (tm_ostream& out, array<T> a) {
-  int i;
+  DI i;
   
   if (N(a)==0) return out << "[ ]";
   out << "[ ";
@@ -136,7 +183,7 @@ operator << (array<T>& a, T x) {
 
 template<class T> array<T>&
 operator << (array<T>& a, array<T> b) {
-  int i, k= N(a);
+  DI i, k= N(a);
   a->resize (N(a)+ N(b));
   for (i=0; i<N(b); i++) a[i+k]= b[i];
   return a;
@@ -144,7 +191,7 @@ operator << (array<T>& a, array<T> b) {
 
 template<class t> bool
 contains (t a, array<t> b) {
-  int i, l= N(b);
+  DI i, l= N(b);
   for (i=0; i<l; i++)
     if (a == b[i])
       return true;
@@ -153,7 +200,7 @@ contains (t a, array<t> b) {
 
 template<class t> array<t>
 append (t a, array<t> b) {
-  int i, l= N(b);
+  DI i, l= N(b);
   array<t> c (l+1);
   c[0]= a;
   for (i=0; i<l; i++) c[i+1]= b[i];
@@ -162,7 +209,7 @@ append (t a, array<t> b) {
 
 template<class T> array<T>
 append (array<T> a, array<T> b) {
-  int i, k= N(a), l= N(b);
+  DI i, k= N(a), l= N(b);
   array<T> c (k+l);
   for (i=0; i<k; i++) c[i]= a[i];
   for (i=0; i<l; i++) c[i+k]= b[i];
@@ -170,8 +217,8 @@ append (array<T> a, array<T> b) {
 }
 
 template<class T> array<T>
-range (array<T> a, int i, int j) {
-  int k;
+range (array<T> a, DI i, DI j) {
+  DI k;
   ASSERT (i>=0 && j<=N(a), "out of range");
   array<T> r (j-i);
   for (k=i; k<j; k++) r[k-i]= a[k];
@@ -180,7 +227,7 @@ range (array<T> a, int i, int j) {
 
 template<class T> array<T>
 reverse (array<T> a) {
-  int i, n= N(a);
+  DI i, n= N(a);
   array<T> r (n);
   for (i=0; i<n; i++) r[i]= a[n-1-i];
   return r;
@@ -188,7 +235,8 @@ reverse (array<T> a) {
 
 template<class T> int
 hash (array<T> a) {
-  int i, n=N(a), h= 0;
+  DI i, n=N(a);
+  int h= 0;
   for (i=0; i<n; i++)
     h= hash(a[i]) ^ ((h<<7) + (h>>25));
   return h;
@@ -196,7 +244,7 @@ hash (array<T> a) {
 
 template<class T> array<T>
 operator * (array<T> a, T c) {
-  int i, n= N(a);
+  DI i, n= N(a);
   array<T> r (n);
   for (i=0; i<n; i++) r[i]= a[i] * c;
   return r;
@@ -204,7 +252,7 @@ operator * (array<T> a, T c) {
 
 template<class T> array<T>
 operator / (array<T> a, T c) {
-  int i, n= N(a);
+  DI i, n= N(a);
   array<T> r (n);
   for (i=0; i<n; i++) r[i]= a[i] / c;
   return r;
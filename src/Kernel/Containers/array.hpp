@@ -16,40 +16,50 @@
 
 class tree;
 template<class T> class array;
-template<class T> int N (array<T> a);
+template<class T> struct relocatable<array<T> > {
+  static const bool value= true; };
+template<class T> DI N (array<T> a);
 template<class T> T*  A (array<T> a);
 template<class T> array<T> copy (array<T> x);
 
 template<class T> class array_rep: concrete_struct {
-  int n;
+  DI n;  // number of elements
+  DI l;  // number of elements for which memory has been allocated
   T* a;
 
+  void reallocate (DI l);
+
 public:
-  inline array_rep (): n(0), a(NULL) {}
-         array_rep (int n);
-  inline ~array_rep () { if (n!=0) tm_delete_array (a); }
-  void resize (int n);
+  inline array_rep (): n(0), l(0), a(NULL) {}
+         array_rep (DI n);
+         ~array_rep ();
+  void resize (DI n);
+  void reserve (DI n);
+  void shrink ();
+  inline DI capacity () { return l; }
   friend class array<T>;
-  friend int N LESSGTR (array<T> a);
+  friend DI N LESSGTR (array<T> a);
   friend T*  A LESSGTR (array<T> a);
   friend array<T> copy LESSGTR (array<T> a);
 };
 
 template<class T> class array {
   CONCRETE_TEMPLATE(array,T);
-  inline array (int n=0): rep (tm_new<array_rep<T> > (n)) {}
-  array (T *a, int n);
+  inline array (int n=0): rep (tm_new<array_rep<T> > ((DI) n)) {}
+  inline array (DI n): rep (tm_new<array_rep<T> > (n)) {}
+  array (T *a, DI n);
+  inline array (T *a, int n): array (a, (DI) n) {}
   array (T x1, T x2);
   array (T x1, T x2, T x3);
   array (T x1, T x2, T x3, T x4);
   array (T x1, T x2, T x3, T x4, T x5);
-  inline T& operator [] (int i) { return rep->a[i]; }
+  inline T& operator [] (DI i) { return rep->a[i]; }
   operator tree (); // defined in tree.hpp
 };
 CONCRETE_TEMPLATE_CODE(array,class,T);
 
 #define TMPL template<class T>
-TMPL inline int N (array<T> a) { return a->n; }
+TMPL inline DI N (array<T> a) { return a->n; }
 TMPL inline T*  A (array<T> a) { return a->a; }
 TMPL inline array<T> copy (array<T> a) {
   return array<T> (a->a, a->n); }
@@ -59,7 +69,7 @@ TMPL array<T>& operator << (array<T>& a, array<T> b);
 TMPL bool contains (T a, array<T> b);
 TMPL array<T> append (T a, array<T> b);
 TMPL array<T> append (array<T> a, array<T> b);
-TMPL array<T> range (array<T> a, int i, int j);
+TMPL array<T> range (array<T> a, DI i, DI j);
 TMPL array<T> reverse (array<T> a);
 TMPL bool operator == (array<T> a, array<T> b);
 TMPL bool operator != (array<T> a, array<T> b);
@@ -75,6 +85,8 @@ TMPL int hash (array<T> a);
 inline array<string>& operator << (array<string>& a, char* x) {
   return a << string(x); }
 #endif
+inline array<int>& operator << (array<int>& a, DI x) {
+  return a << ((int) x); }
 
 #include "array.cpp"
 
@@ -16,6 +16,8 @@
 class tree;
 template<class T> class list_rep;
 template<class T> class list;
+template<class T> struct relocatable<list<T> > {
+  static const bool value= true; };
 
 template<class T> bool is_nil (list<T> l);
 template<class T> bool is_atom (list<T> l);
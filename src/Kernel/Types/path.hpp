@@ -31,6 +31,7 @@ bool   version_inf (string v1, string v2);
 * Operations on paths
 ******************************************************************************/
 
+inline path operator * (path p, DI i) { return p * ((int) i); }
 path path_up (path p);
 path path_up (path p, int times);
 bool path_inf (path p1, path p2);
@@ -19,55 +19,69 @@
 * Low level routines and constructors
 ******************************************************************************/
 
-static inline int
-round_length (int n) {
-  n=(n+3)&(0xfffffffc);
+static inline DI
+round_length (DI n) {
+  n=(n+3)&(~((DI) 3));
   if (n<24) return n;
-  int i=32;
+  DI i=32;
   while (n>i) i<<=1;
   return i;
 }
 
-string_rep::string_rep (int n2):
-  n(n2), a ((n==0)?((char*) NULL):tm_new_array<char> (round_length(n))) {}
+string_rep::string_rep (DI n2):
+  n (n2), l (round_length (n2)),
+  a ((l==0)?((char*) NULL):((char*) fast_alloc (l))) {}
 
 void
-string_rep::resize (int m) {
-  int nn= round_length (n);
-  int mm= round_length (m);
-  if (mm != nn) {
-    if (mm != 0) {
-      int i, k= (m<n? m: n);
-      char* b= tm_new_array<char> (mm);
-      for (i=0; i<k; i++) b[i]= a[i];
-      if (nn != 0) tm_delete_array (a);
-      a= b;
-    }
-    else if (nn != 0) tm_delete_array (a);
+string_rep::reallocate (DI l2) {
+  // move the characters to a new block of memory for l2 >= n characters
+  char* b= (l2==0)? ((char*) NULL): ((char*) fast_alloc (l2));
+  if (n != 0) memcpy (b, a, n);
+  if (l != 0) fast_free ((void*) a, l);
+  a= b;
+  l= l2;
+}
+
+void
+string_rep::resize (DI m) {
+  if (m > l) reallocate (round_length (m));
+  else if (m < n && 4 * round_length (m) <= l) {
+    n= m;
+    reallocate (round_length (m));
   }
   n= m;
 }
 
+void
+string_rep::reserve (DI m) {
+  if (m > l) reallocate (m);
+}
+
+void
+string_rep::shrink () {
+  if (n < l) reallocate (n);
+}
+
 string::string (char c) {
   rep= tm_new<string_rep> (1);
   rep->a[0]=c;
 }
 
-string::string (char c, int n) {
+string::string (char c, DI n) {
   rep= tm_new<string_rep> (n);
-  for (int i=0; i<n; i++)
+  for (DI i=0; i<n; i++)
     rep->a[i]=c;
 }
 
 string::string (const char* a) {
-  int i, n=strlen(a);
+  DI i, n=strlen(a);
   rep= tm_new<string_rep> (n);
   for (i=0; i<n; i++)
     rep->a[i]=a[i];
 }
 
-string::string (const char* a, int n) {
-  int i;
+string::string (const char* a, DI n) {
+  DI i;
   rep= tm_new<string_rep> (n);
   for (i=0; i<n; i++)
     rep->a[i]=a[i];
@@ -79,7 +93,7 @@ string::string (const char* a, int n) {
 
 bool
 string::operator == (const char* s) {
-  int i, n= rep->n;
+  DI i, n= rep->n;
   char* S= rep->a;
   for (i=0; i<n; i++) {
     if (s[i]!=S[i]) return false;
@@ -90,7 +104,7 @@ string::operator == (const char* s) {
 
 bool
 string::operator != (const char* s) {
-  int i, n= rep->n;
+  DI i, n= rep->n;
   char* S= rep->a;
   for (i=0; i<n; i++) {
     if (s[i]!=S[i]) return true;
@@ -101,7 +115,7 @@ string::operator != (const char* s) {
 
 bool
 string::operator == (string a) {
-  int i;
+  DI i;
   if (rep->n!=a->n) return false;
   for (i=0; i<rep->n; i++)
     if (rep->a[i]!=a->a[i]) return false;
@@ -110,7 +124,7 @@ string::operator == (string a) {
 
 bool
 string::operator != (string a) {
-  int i;
+  DI i;
   if (rep->n!=a->n) return true;
   for (i=0; i<rep->n; i++)
     if (rep->a[i]!=a->a[i]) return true;
@@ -118,10 +132,10 @@ string::operator != (string a) {
 }
 
 string
-string::operator () (int begin, int end) {
+string::operator () (DI begin, DI end) {
   if (end <= begin) return string();
 
-  int i;
+  DI i;
   begin = max(min(rep->n, begin), 0);
   end = max(min(rep->n, end), 0);
   string r (end-begin);
@@ -131,7 +145,7 @@ string::operator () (int begin, int end) {
 
 string
 copy (string s) {
-  int i, n=N(s);
+  DI i, n=N(s);
   string r (n);
   for (i=0; i<n; i++) r[i]=s[i];
   return r;
@@ -146,7 +160,7 @@ operator << (string& a, char x) {
 
 string&
 operator << (string& a, string b) {
-  int i, k1= N(a), k2=N(b);
+  DI i, k1= N(a), k2=N(b);
   a->resize (k1+k2);
   for (i=0; i<k2; i++) a[i+k1]= b[i];
   return a;
@@ -154,7 +168,7 @@ operator << (string& a, string b) {
 
 string
 operator * (string a, string b) {
-  int i, n1=N(a), n2=N(b);
+  DI i, n1=N(a), n2=N(b);
   string c(n1+n2);
   for (i=0; i<n1; i++) c[i]=a[i];
   for (i=0; i<n2; i++) c[i+n1]=b[i];
@@ -173,7 +187,7 @@ operator * (string a, const char* b) {
 
 bool
 operator < (string s1, string s2) {
-  int i;
+  DI i;
   for (i=0; i<N(s1); i++) {
     if (i>=N(s2)) return false;
     if (s1[i]<s2[i]) return true;
@@ -184,7 +198,7 @@ operator < (string s1, string s2) {
 
 bool
 operator <= (string s1, string s2) {
-  int i;
+  DI i;
   for (i=0; i<N(s1); i++) {
     if (i>=N(s2)) return false;
     if (s1[i]<s2[i]) return true;
@@ -201,7 +215,8 @@ operator << (tm_ostream& out, string a) {
 
 int
 hash (string s) {
-  int i, h=0, n=N(s);
+  int h=0;
+  DI i, n=N(s);
   for (i=0; i<n; i++) {
     h=(h<<9)+(h>>23);
     h=h+((int) s[i]);
@@ -268,7 +283,7 @@ as_double (string s) {
 
 char*
 as_charp (string s) {
-  int i, n= N(s);
+  DI i, n= N(s);
   char *s2= tm_new_array<char> (n+1);
   for (i=0; i<n; i++) s2[i]=s[i];
   s2[n]= '\0';
@@ -15,38 +15,46 @@
 #include "basic.hpp"
 
 class string;
+template<> struct relocatable<string> { static const bool value= true; };
 class string_rep: concrete_struct {
-  int n;
+  DI n;  // number of characters
+  DI l;  // number of characters for which memory has been allocated
   char* a;
 
+  void reallocate (DI l);
+
 public:
-  inline string_rep (): n(0), a(NULL) {}
-         string_rep (int n);
-  inline ~string_rep () { if (n!=0) tm_delete_array (a); }
-  void resize (int n);
+  inline string_rep (): n(0), l(0), a(NULL) {}
+         string_rep (DI n);
+  inline ~string_rep () { if (l!=0) fast_free ((void*) a, l); }
+  void resize (DI n);
+  void reserve (DI n);
+  void shrink ();
+  inline DI capacity () { return l; }
 
   friend class string;
-  friend inline int N (string a);
+  friend inline DI N (string a);
 };
 
 class string {
   CONCRETE(string);
   inline string (): rep (tm_new<string_rep> ()) {}
-  inline string (int n): rep (tm_new<string_rep> (n)) {}
+  inline string (int n): rep (tm_new<string_rep> ((DI) n)) {}
+  inline string (DI n): rep (tm_new<string_rep> (n)) {}
   string (char c);
-  string (char c, int n);
+  string (char c, DI n);
   string (const char *s);
-  string (const char *s, int n);
-  inline char& operator [] (int i) { return rep->a[i]; }
+  string (const char *s, DI n);
+  inline char& operator [] (DI i) { return rep->a[i]; }
   bool operator == (const char* s);
   bool operator != (const char* s);
   bool operator == (string s);
   bool operator != (string s);
-  string operator () (int start, int end);
+  string operator () (DI start, DI end);
 };
 CONCRETE_CODE(string);
 
-extern inline int N (string a) { return a->n; }
+extern inline DI N (string a) { return a->n; }
 string   copy (string a);
 tm_ostream& operator << (tm_ostream& out, string a);
 string&  operator << (string& a, char);
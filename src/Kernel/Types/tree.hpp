@@ -20,6 +20,7 @@
 ******************************************************************************/
 
 class tree;
+template<> struct relocatable<tree> { static const bool value= true; };
 class tree_rep;
 class atomic_rep;
 class compound_rep;
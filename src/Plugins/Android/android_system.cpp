@@ -112,6 +112,17 @@ ssize_t texmacs_fread (char *z, size_t n, FILE *stream) {
   return pfile->read(z, n);
 }
 
+char* texmacs_fmap (FILE *stream, size_t size) {
+  // mappings of a QFile do not survive the destruction of the QFile,
+  // so the caller falls back to reading the file
+  (void) stream; (void) size;
+  return nullptr;
+}
+
+void texmacs_funmap (char *data, size_t size) {
+  (void) data; (void) size;
+}
+
 void texmacs_fclose(FILE *&file, bool unlock) {
   QFile *pfile = (QFile*)file;
   pfile->close();
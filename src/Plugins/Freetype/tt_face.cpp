@@ -15,6 +15,8 @@
 #include "tt_file.hpp"
 #include "tm_timer.hpp"
 #include "sys_utils.hpp"
+#include "iterator.hpp"
+#include "scheme.hpp"
 
 #ifdef USE_FREETYPE
 
@@ -42,54 +44,108 @@ tt_face_rep::tt_face_rep (string name): rep<tt_face> (name) {
   if (ft_initialize ()) return;
   if (DEBUG_VERBOSE)
     debug_fonts << "Loading True Type font " << name << "\n";
-  url u= tt_font_find (name);
-  if (is_none (u)) return;
+  bad_face= !open ();
+}
+
+tt_face_rep::~tt_face_rep () {
+  std_warning << "tt_face_rep should not be deleted\n";
+  close ();
+}
+
+bool
+tt_face_rep::open () {
+  // The font file is mapped into memory whenever possible, so that only
+  // the tables which are actually used by FreeType are paged in and the
+  // pages are shared with other processes using the same font
+  url u= tt_font_find (res_name);
+  if (is_none (u)) return false;
 
   FILE *font_file = texmacs_fopen(concretize (u), "r");
   if (!font_file) {
-    debug_fonts << "Can't load " << name << LF;
-    return;
+    debug_fonts << "Can't load " << res_name << LF;
+    return false;
   }
   ssize_t fsize = texmacs_fsize (font_file);
   if (fsize <= 0) {
     texmacs_fclose(font_file);
-    debug_fonts << "Can't load " << name << LF; 
-    return;
+    debug_fonts << "Can't load " << res_name << LF; 
+    return false;
   }
 
-  buffer = (FT_Byte*)malloc(fsize);
-  ssize_t readed = texmacs_fread ((char*)buffer, fsize, font_file);
-  if (readed != fsize) {
-    free(buffer);
-    buffer = nullptr;
-    texmacs_fclose(font_file);
-    debug_fonts << "Can't read " << name << LF;
-    return;
+  buffer_size = (size_t) fsize;
+  buffer = (FT_Byte*) texmacs_fmap (font_file, buffer_size);
+  mapped = (buffer != nullptr);
+  if (!mapped) {
+    buffer = (FT_Byte*)malloc(fsize);
+    ssize_t readed = texmacs_fread ((char*)buffer, fsize, font_file);
+    if (readed != fsize) {
+      close ();
+      texmacs_fclose(font_file);
+      debug_fonts << "Can't read " << res_name << LF;
+      return false;
+    }
   }
   texmacs_fclose(font_file);
 
   if (ft_new_memory_face (ft_library, buffer, fsize, 0, &ft_face)) {  
-    debug_fonts << "Can't load font " << name << LF;
-    free(buffer);
-    buffer = nullptr;
-    return; 
+    debug_fonts << "Can't load font " << res_name << LF;
+    ft_face = nullptr;
+    close ();
+    return false; 
   }
   ft_select_charmap (ft_face, ft_encoding_adobe_custom);
-  bad_face= false;
+  last_use = texmacs_time ();
+  return true;
 }
 
-tt_face_rep::~tt_face_rep () {
-  std_warning << "tt_face_rep should not be deleted\n";
+void
+tt_face_rep::close () {
   if (ft_face) ft_done_face (ft_face);
-  if (buffer) free(buffer);
+  if (buffer && mapped) texmacs_funmap ((char*) buffer, buffer_size);
+  else if (buffer) free(buffer);
+  ft_face = nullptr;
+  buffer = nullptr;
+  buffer_size = 0;
+  mapped = false;
+}
+
+bool
+tt_face_rep::ready () {
+  if (bad_face) return false;
+  if (ft_face == nullptr && !open ()) {
+    bad_face= true;
+    return false;
+  }
+  last_use= texmacs_time ();
+  return true;
 }
 
 tt_face
 load_tt_face (string name) {
-  bench_start ("load tt face");
-  tt_face face= make (tt_face, name, tm_new<tt_face_rep> (name));
-  bench_cumul ("load tt face");
-  return face;
+  TRACE_SCOPE ("font", "load tt face");
+  return make (tt_face, name, tm_new<tt_face_rep> (name));
+}
+
+void
+tt_face_clean () {
+  // Close faces which have not been used for a while; they are
+  // transparently reopened when they are needed again
+  static time_t last_gc= 0;
+  if (texmacs_time () - last_gc <= 60000) return;
+  last_gc= texmacs_time ();
+  int timeout= as_int (get_preference ("idle font timeout", "0"));
+  if (timeout <= 0) return;
+
+  iterator<string> it= iterate (tt_face::instances);
+  while (it->busy ()) {
+    tt_face face (it->next ());
+    if (face->ft_face != nullptr &&
+        last_gc - face->last_use > 60000 * ((time_t) timeout)) {
+      if (DEBUG_VERBOSE)
+        debug_fonts << "Closing idle True Type font " << face->res_name << "\n";
+      face->close ();
+    }
+  }
 }
 
 /******************************************************************************
@@ -100,12 +156,18 @@ static metric error_metric;
 
 tt_font_metric_rep::tt_font_metric_rep (
   string name, string family, int size2, int hdpi2, int vdpi2):
-  font_metric_rep (name), size (size2), hdpi (hdpi2), vdpi (vdpi2), fnm (NULL)
+  font_metric_rep (name), size (size2), hdpi (hdpi2), vdpi (vdpi2),
+  has_kerning (false)
 {
+  for (int i=0; i<TT_KERNING_SIZE; i++) {
+    kern_cache[i].left= kern_cache[i].right= -1;
+    kern_cache[i].kerning= 0;
+  }
   face= load_tt_face (family);
-  bad_font_metric= face->bad_face ||
+  bad_font_metric= !face->ready () ||
     ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
   if (bad_font_metric) return;
+  has_kerning= FT_HAS_KERNING (face->ft_face);
 
   error_metric->x1= error_metric->y1= 0;
   error_metric->x2= error_metric->y2= 0;
@@ -116,22 +178,22 @@ tt_font_metric_rep::tt_font_metric_rep (
 bool
 tt_font_metric_rep::exists (int i) {
   if (face->bad_face) return false;
-  if (fnm->contains (i)) return true;
+  if (fnm.contains (i)) return true;
+  if (!face->ready ()) return false;
   FT_UInt glyph_index= decode_index (face->ft_face, i);
   return glyph_index != 0;
 }
 
 metric&
 tt_font_metric_rep::get (int i) {
-  if (!face->bad_face && !fnm->contains(i)) {
+  if (!fnm.contains (i) && face->ready ()) {
     ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
     FT_UInt glyph_index= decode_index (face->ft_face, i);
     if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT))
       return error_metric;
     FT_GlyphSlot slot= face->ft_face->glyph;
     if (ft_render_glyph (slot, ft_render_mode_mono)) return error_metric;
-    metric_struct* M= tm_new<metric_struct> ();
-    fnm(i)= (pointer) M;
+    metric& M= fnm (i);
     int w= slot->bitmap.width;
     int h= slot->bitmap.rows;
     SI ww= w * PIXEL;
@@ -156,18 +218,27 @@ tt_font_metric_rep::get (int i) {
     //cout << "Physical: " << M->x3/PIXEL << ", " << M->y3/PIXEL
     //     << "; " << M->x4/PIXEL << ", " << M->y4/PIXEL << "\n";
   }
-  return *((metric*) ((void*) fnm [i]));
+  if (!fnm.contains (i)) return error_metric;
+  return fnm [i];
 }
 
 SI
 tt_font_metric_rep::kerning (int left, int right) {
-  if (face->bad_face || !FT_HAS_KERNING (face->ft_face)) return 0;
+  if (!has_kerning) return 0;
+  unsigned int h= ((unsigned int) left) * 31 + ((unsigned int) right);
+  tt_kerning_entry& e= kern_cache[(h ^ (h >> TT_KERNING_BITS)) &
+                                  (TT_KERNING_SIZE - 1)];
+  if (e.left == left && e.right == right) return e.kerning;
+  if (!face->ready ()) return 0;
   FT_Vector k;
   FT_UInt l= decode_index (face->ft_face, left);
   FT_UInt r= decode_index (face->ft_face, right);
   ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
   if (ft_get_kerning (face->ft_face, l, r, FT_KERNING_DEFAULT, &k)) return 0;
-  return tt_si (k.x);
+  e.left   = left;
+  e.right  = right;
+  e.kerning= tt_si (k.x);
+  return e.kerning;
 }
 
 font_metric
@@ -187,17 +258,17 @@ static glyph error_glyph;
 tt_font_glyphs_rep::tt_font_glyphs_rep (
   string name, string family, int size2, int hdpi2, int vdpi2):
   font_glyphs_rep (name), size (size2),
-  hdpi (hdpi2), vdpi (vdpi2), fng (glyph ())
+  hdpi (hdpi2), vdpi (vdpi2)
 {
   face= load_tt_face (family);
-  bad_font_glyphs= face->bad_face ||
+  bad_font_glyphs= !face->ready () ||
     ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
   if (bad_font_glyphs) return;
 }
 
 glyph&
 tt_font_glyphs_rep::get (int i) {
-  if (!face->bad_face && !fng->contains(i)) {
+  if (!fng.contains (i) && face->ready ()) {
     ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
     FT_UInt glyph_index= decode_index (face->ft_face, i);
     if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT))
@@ -232,9 +303,10 @@ tt_font_glyphs_rep::get (int i) {
     //cout << "Glyph " << i << " of " << res_name << "\n";
     //cout << G << "\n";
     if (G->width * G->height == 0) G= error_glyph;
-    fng(i)= G;
+    fng (i)= G;
   }
-  return fng(i);
+  if (!fng.contains (i)) return error_glyph;
+  return fng [i];
 }
 
 font_glyphs
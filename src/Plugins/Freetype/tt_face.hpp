@@ -14,6 +14,7 @@
 #include "bitmap_font.hpp"
 #include "Freetype/free_type.hpp"
 #include "hashmap.hpp"
+#include "iterator.hpp"
 
 #ifdef USE_FREETYPE
 
@@ -23,17 +24,120 @@ struct tt_face_rep: rep<tt_face> {
   bool bad_face = true;
   FT_Face ft_face = nullptr;
   FT_Byte *buffer = nullptr;
+  size_t buffer_size = 0;
+  bool mapped = false;       // buffer maps the font file into memory
+  time_t last_use = 0;       // time of the last access to ft_face
   tt_face_rep (string name);
   ~tt_face_rep () override;
+  bool open ();
+  void close ();
+  bool ready ();             // reopen the face if it has been evicted
+};
+
+/******************************************************************************
+* Dense tables indexed by character codes
+*******************************************************************************
+* Metrics and glyphs are stored in pages of 256 consecutive character
+* codes, which are allocated on demand.  Unicode code points and glyph
+* indices (encoded as 0xc000000 + index) are looked up through a plain
+* array of pages; other codes use a hash table of pages.
+******************************************************************************/
+
+#define TT_PAGE_BITS   8
+#define TT_PAGE_SIZE   (1 << TT_PAGE_BITS)
+#define TT_UNICODE_END 0x110000
+#define TT_INDEX_START 0xc000000
+#define TT_INDEX_END   0xc010000
+
+template<class T>
+struct tt_page {
+  T    entry[TT_PAGE_SIZE];
+  bool done [TT_PAGE_SIZE];
+  tt_page () { for (int i=0; i<TT_PAGE_SIZE; i++) done[i]= false; }
+};
+
+template<class T>
+class tt_table {
+  array<tt_page<T>*> pages;  // pages for unicode code points and indices
+  hashmap<int,pointer> far;  // pages for all other codes
+
+  static inline int slot (int c) {
+    if (c >= 0 && c < TT_UNICODE_END) return c >> TT_PAGE_BITS;
+    if (c >= TT_INDEX_START && c < TT_INDEX_END)
+      return (TT_UNICODE_END + (c - TT_INDEX_START)) >> TT_PAGE_BITS;
+    return -1;
+  }
+
+  tt_page<T>* create (int c) {
+    int s= slot (c);
+    tt_page<T>* p= tm_new<tt_page<T> > ();
+    if (s < 0) far (c >> TT_PAGE_BITS)= (pointer) p;
+    else {
+      int i, n= N(pages);
+      if (s >= n) {
+        pages->resize (s + 1);
+        for (i=n; i<=s; i++) pages[i]= NULL;
+      }
+      pages[s]= p;
+    }
+    return p;
+  }
+
+  tt_table (const tt_table&);           // the pages are owned by the table
+  void operator= (const tt_table&);
+
+public:
+  tt_table (): far (NULL) {}
+  ~tt_table () {
+    for (int i=0; i<N(pages); i++)
+      if (pages[i] != NULL) tm_delete (pages[i]);
+    iterator<int> it= iterate (far);
+    while (it->busy ()) tm_delete ((tt_page<T>*) far [it->next ()]);
+  }
+
+  inline tt_page<T>* page (int c) {
+    int s= slot (c);
+    if (s >= 0) return s < N(pages)? pages[s]: (tt_page<T>*) NULL;
+    return (tt_page<T>*) far [c >> TT_PAGE_BITS];
+  }
+
+  inline bool contains (int c) {
+    tt_page<T>* p= page (c);
+    return p != NULL && p->done[c & (TT_PAGE_SIZE-1)];
+  }
+
+  inline T& operator [] (int c) {
+    // only for codes which are known to be contained in the table
+    return page (c)->entry[c & (TT_PAGE_SIZE-1)];
+  }
+
+  inline T& operator () (int c) {
+    tt_page<T>* p= page (c);
+    if (p == NULL) p= create (c);
+    p->done[c & (TT_PAGE_SIZE-1)]= true;
+    return p->entry[c & (TT_PAGE_SIZE-1)];
+  }
+};
+
+/******************************************************************************
+* Metrics and glyphs of True Type fonts
+******************************************************************************/
+
+#define TT_KERNING_BITS 8
+#define TT_KERNING_SIZE (1 << TT_KERNING_BITS)
+
+struct tt_kerning_entry {
+  int left, right;
+  SI  kerning;
 };
 
 struct tt_font_metric_rep: font_metric_rep {
   bool bad_metric;
   tt_face face;
   int size, hdpi, vdpi;
-  hashmap<int,pointer> fnm;
-  //metric* fnm;
-  //bool* done;
+  bool has_kerning;
+  tt_table<metric> fnm;
+  tt_kerning_entry kern_cache[TT_KERNING_SIZE];  // direct mapped
   tt_font_metric_rep (string name, string family, int size, int hdpi, int vdpi);
   bool exists (int char_code);
   metric& get (int char_code);
@@ -44,14 +148,13 @@ struct tt_font_glyphs_rep: font_glyphs_rep {
   bool bad_glyphs;
   tt_face face;
   int size, hdpi, vdpi;
-  hashmap<int,glyph> fng;
-  //glyph* fng;
-  //bool* done;
+  tt_table<glyph> fng;
   tt_font_glyphs_rep (string name, string family, int size, int hdpi, int vdpi);
   glyph& get (int char_code);
 };
 
 tt_face load_tt_face (string name);
+void tt_face_clean ();
 font_metric tt_font_metric (string family, int size, int hdpi, int vdpi);
 //font_glyphs tt_font_glyphs (string family, int size, int hdpi, int vdpi);
 
@@ -220,10 +220,12 @@ tt_find_name (string name, int size) {
     cache_reset ("font_cache.scm", s);
   }
 
-  bench_start ("tt find name");
-  string r= tt_find_name_sub (name, size);
-  //cout << name << size << " -> " << r << "\n";
-  bench_cumul ("tt find name");
+  string r;
+  {
+    TRACE_SCOPE ("font", "tt find name");
+    r= tt_find_name_sub (name, size);
+    //cout << name << size << " -> " << r << "\n";
+  }
 
   if (r != "") cache_set ("font_cache.scm", s, r);
   return r;
@@ -24,6 +24,7 @@ string tt_find_name (string name, int size);
 
 #ifdef USE_FREETYPE
 font_glyphs tt_font_glyphs (string family, int size, int hdpi, int vdpi);
+void tt_face_clean ();
 #endif // USE_FREETYPE
 
 #endif // TT_FILE_H
@@ -181,14 +181,18 @@ tt_font_rep::get_xpositions (string s, SI* xpos) {
 void
 tt_font_rep::draw_fixed (renderer ren, string s, SI x, SI y) {
   if (N(s)!=0) {
-    int i;
-    for (i=0; i<N(s); i++) {
+    int i, n= N(s);
+    array<int> cs (n);
+    array<SI>  xs (n);
+    for (i=0; i<n; i++) {
       if (i>0) x += ROUND (fnm->kerning ((QN) s[i-1], (QN) s[i]));
       QN c= s[i];
-      ren->draw (c, fng, x, y);
+      cs[i]= c;
+      xs[i]= x;
       metric_struct* ex= fnm->get (c);
       x += ROUND (ex->x2);
     }
+    ren->draw_glyphs (cs, fng, xs, y);
   }
 }
 
@@ -712,18 +712,22 @@ void
 unicode_font_rep::draw_fixed (renderer ren, string s, SI x, SI y, bool ligf) {
   int i= 0, n= N(s);
   unsigned int uc= 0xffffffff;
+  array<int> cs;
+  array<SI>  xs;
   while (i<n) {
     unsigned int pc= uc;
     uc= read_unicode_char (s, i);
     if (ligs > 0 && ligf && (((char) uc) == 'f' || ((char) uc) == 's'))
       uc= ligature_replace (uc, s, i);
     if (pc != 0xffffffff) x += ROUND (fnm->kerning (pc, uc));
-    ren->draw (uc, fng, x, y);
+    cs << ((int) uc);
+    xs << x;
     metric_struct* ex= fnm->get (uc);
     x += ROUND (ex->x2);
     //if (fnm->kerning (pc, uc) != 0)
     //cout << "Kerning " << ((char) pc) << ((char) uc) << " " << ROUND (fnm->kerning (pc, uc)) << ", " << ROUND (ex->x2) << "\n";
   }
+  ren->draw_glyphs (cs, fng, xs, y);
 }
 
 void
@@ -284,7 +284,7 @@ pk_loader::load_pk () {
   SI xoff;
   SI yoff;
   
-  bench_start ("decode pk");
+  TRACE_SCOPE ("font", "decode pk");
   glyph* fng= tm_new_array<glyph> (ec+1-bc);
   char_pos = tm_new_array<int> (ec+1-bc);
   unpacked = tm_new_array<bool> (ec+1-bc);
@@ -427,6 +427,5 @@ pk_loader::load_pk () {
       fng[c]->lwidth= ((lwidth+(PIXEL>>1)) / PIXEL);
     }
 
-  bench_cumul ("decode pk");
   return fng;
 }
@@ -301,14 +301,13 @@ void
 load_tex (string family, int size, int dpi, int dsize,
 	  tex_font_metric& tfm, font_glyphs& pk)
 {
-  bench_start ("load tex font");
+  TRACE_SCOPE ("font", "load tex font");
   if (DEBUG_VERBOSE)
     debug_fonts << "Loading " << family << size
                 << " at " << dpi << " dpi\n";
   if (load_tex_tfm (family, size, dsize, tfm) &&
       load_tex_pk (family, size, dpi, dsize, tfm, pk))
     {
-      bench_cumul ("load tex font");
       rubber_fix (tfm, pk);
       return;
     }
@@ -320,10 +319,7 @@ load_tex (string family, int size, int dpi, int dsize,
   }
   if (load_tex_tfm ("ecrm", size, 10, tfm) &&
       load_tex_pk ("ecrm", size, dpi, 10, tfm, pk))
-    {
-      bench_cumul ("load tex font");
-      return;
-    }
+    return;
 #ifdef OS_WIN32
   else {
     string name= family * as_string (size) * "@" * as_string (dpi);
@@ -332,14 +328,10 @@ load_tex (string family, int size, int dpi, int dsize,
     XNoTexWarn();
     if (load_tex_tfm ("ecrm", 10, 10, tfm) &&
 	load_tex_pk ("ecrm", 10, 600, 10, tfm, pk))
-      {
-	bench_cumul ("load tex font");
-	return;
-      }
+      return;
   }
 #endif
   string name= family * as_string (size) * "@" * as_string (dpi);
   failed_error << "Could not open " << name << "\n";
   FAILED ("Tex seems not to be installed properly");
-  bench_cumul ("load tex font");
 }
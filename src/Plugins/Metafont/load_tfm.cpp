@@ -380,7 +380,7 @@ load_tfm (url file_name, string family, int size) {
   int i= 0;
   string s;
   (void) load_string (file_name, s, true);
-  bench_start ("decode tfm");
+  TRACE_SCOPE ("font", "decode tfm");
 
   parse (s, i, tfm->lf);
   parse (s, i, tfm->lh);
@@ -445,6 +445,5 @@ load_tfm (url file_name, string family, int size) {
     tfm->param[0]= (int) (0.167 * ((double) (1<<20)));
   // End fixes
 
-  bench_cumul ("decode tfm");
   return tfm;
 }
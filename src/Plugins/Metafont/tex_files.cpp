@@ -29,10 +29,8 @@ static url the_pfb_path= url_none ();
 
 static string
 kpsewhich (string name) {
-  bench_start ("kpsewhich");
-  string which= var_eval_system ("kpsewhich " * name);
-  bench_cumul ("kpsewhich");
-  return which;
+  TRACE_SCOPE ("font", "kpsewhich");
+  return var_eval_system ("kpsewhich " * name);
 }
 
 static url
@@ -93,19 +91,20 @@ resolve_tex (url name) {
     cache_reset ("font_cache.scm", s);
   }
 
-  bench_start ("resolve tex");
   url u= url_none ();
-  if (ends (s, "mf" )) {
-    u= resolve_tfm (name);
+  {
+    TRACE_SCOPE ("font", "resolve tex");
+    if (ends (s, "mf" )) {
+      u= resolve_tfm (name);
 #ifdef OS_WIN32
-    if (is_none (u))
-      u= resolve_tfm (replace (s, ".mf", ".tfm"));
+      if (is_none (u))
+        u= resolve_tfm (replace (s, ".mf", ".tfm"));
 #endif
+    }
+    if (ends (s, "tfm")) u= resolve_tfm (name);
+    if (ends (s, "pk" )) u= resolve_pk  (name);
+    if (ends (s, "pfb")) u= resolve_pfb (name);
   }
-  if (ends (s, "tfm")) u= resolve_tfm (name);
-  if (ends (s, "pk" )) u= resolve_pk  (name);
-  if (ends (s, "pfb")) u= resolve_pfb (name);
-  bench_cumul ("resolve tex");
 
   if (!is_none (u)) cache_set ("font_cache.scm", s, as_string (u));
   //cout << "Resolve " << name << " -> " << u << "\n";
@@ -0,0 +1,240 @@
+
+/******************************************************************************
+* MODULE     : pdf_hummus_deflate.cpp
+* DESCRIPTION: Compression of pdf streams on worker threads
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "pdf_hummus_deflate.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include "zlib.h"
+
+#ifndef OS_MINGW
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+struct pdf_deflate_job {
+  unsigned long key;    // identifier chosen by the caller
+  char*         in;     // uncompressed data
+  size_t        in_n;
+  char*         out;    // compressed data
+  size_t        out_n;
+  bool          done;   // compression finished?
+  bool          packed; // were the data compressed?
+};
+
+static void
+deflate_job (pdf_deflate_job* job) {
+  uLongf n= (uLongf) job->out_n;
+  if (job->in == NULL || job->out == NULL ||
+      compress2 ((Bytef*) job->out, &n, (const Bytef*) job->in,
+                 (uLong) job->in_n, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    // hand back the uncompressed data instead
+    free (job->out);
+    job->out   = job->in;
+    job->out_n = (job->in == NULL? 0: job->in_n);
+    job->in    = NULL;
+    job->packed= false;
+    return;
+  }
+  job->out_n = (size_t) n;
+  job->packed= true;
+  free (job->in);
+  job->in= NULL;
+}
+
+int
+pdf_deflate_default_threads () {
+#ifdef OS_MINGW
+  return 1;
+#else
+  int nr= (int) sysconf (_SC_NPROCESSORS_ONLN);
+  if (nr < 1) nr= 1;
+  if (nr > 8) nr= 8;
+  return nr;
+#endif
+}
+
+/******************************************************************************
+* Worker threads
+******************************************************************************/
+
+#ifndef OS_MINGW
+
+struct pdf_deflate_threads {
+  pthread_mutex_t        lock;
+  pthread_cond_t         work;   // signaled when jobs were submitted
+  pthread_cond_t         ready;  // signaled when a job has been finished
+  std::vector<pthread_t> ids;
+};
+
+static void*
+pdf_deflate_worker (void* arg) {
+  ((pdf_deflate_queue*) arg)->run_worker ();
+  return NULL;
+}
+
+void
+pdf_deflate_queue::run_worker () {
+  pthread_mutex_lock (&threads->lock);
+  while (true) {
+    while (!stop && next == jobs.size ())
+      pthread_cond_wait (&threads->work, &threads->lock);
+    if (next == jobs.size ()) break;
+    pdf_deflate_job* job= jobs[next++];
+    pthread_mutex_unlock (&threads->lock);
+    deflate_job (job);
+    pthread_mutex_lock (&threads->lock);
+    job->done= true;
+    pthread_cond_broadcast (&threads->ready);
+  }
+  pthread_mutex_unlock (&threads->lock);
+}
+
+void
+pdf_deflate_queue::start () {
+  threads= new pdf_deflate_threads ();
+  pthread_mutex_init (&threads->lock, NULL);
+  pthread_cond_init (&threads->work, NULL);
+  pthread_cond_init (&threads->ready, NULL);
+  for (int i=0; i<nr_threads; i++) {
+    pthread_t id;
+    if (pthread_create (&id, NULL, pdf_deflate_worker, (void*) this) == 0)
+      threads->ids.push_back (id);
+  }
+  if (threads->ids.size () == 0) {
+    pthread_cond_destroy (&threads->ready);
+    pthread_cond_destroy (&threads->work);
+    pthread_mutex_destroy (&threads->lock);
+    delete threads;
+    threads= NULL;
+  }
+}
+
+#else
+
+struct pdf_deflate_threads {};
+void pdf_deflate_queue::run_worker () {}
+void pdf_deflate_queue::start () {}
+
+#endif
+
+/******************************************************************************
+* The queue
+******************************************************************************/
+
+pdf_deflate_queue::pdf_deflate_queue (int nr_threads2):
+  nr_threads (nr_threads2), threads (NULL),
+  first (0), next (0), stop (false), last (NULL)
+{
+#ifndef OS_MINGW
+  if (nr_threads > 1) start ();
+#endif
+}
+
+pdf_deflate_queue::~pdf_deflate_queue () {
+#ifndef OS_MINGW
+  if (threads != NULL) {
+    pthread_mutex_lock (&threads->lock);
+    stop= true;
+    pthread_cond_broadcast (&threads->work);
+    pthread_mutex_unlock (&threads->lock);
+    for (size_t i=0; i<threads->ids.size (); i++)
+      pthread_join (threads->ids[i], NULL);
+    pthread_cond_destroy (&threads->ready);
+    pthread_cond_destroy (&threads->work);
+    pthread_mutex_destroy (&threads->lock);
+    delete threads;
+  }
+#endif
+  release_last ();
+  for (size_t i=first; i<jobs.size (); i++) {
+    free (jobs[i]->in);
+    free (jobs[i]->out);
+    delete jobs[i];
+  }
+}
+
+int
+pdf_deflate_queue::pending () {
+  return (int) (jobs.size () - first);
+}
+
+void
+pdf_deflate_queue::release_last () {
+  if (last == NULL) return;
+  free (last->out);
+  delete last;
+  last= NULL;
+}
+
+void
+pdf_deflate_queue::submit (unsigned long key, const char* data, size_t n) {
+  pdf_deflate_job* job= new pdf_deflate_job ();
+  job->key  = key;
+  job->in_n = n;
+  job->in   = (char*) malloc (n + 1);
+  job->out_n= (size_t) compressBound ((uLong) n);
+  job->out  = (char*) malloc (job->out_n + 1);
+  job->done = false;
+  job->packed= false;
+  if (job->in != NULL) memcpy (job->in, data, n);
+#ifndef OS_MINGW
+  if (threads != NULL) {
+    pthread_mutex_lock (&threads->lock);
+    if (first == jobs.size () && next == first) {
+      // all previous jobs have been retrieved: recycle the vector
+      jobs.clear ();
+      first= next= 0;
+    }
+    jobs.push_back (job);
+    pthread_cond_signal (&threads->work);
+    pthread_mutex_unlock (&threads->lock);
+    return;
+  }
+#endif
+  if (first == jobs.size ()) {
+    jobs.clear ();
+    first= next= 0;
+  }
+  deflate_job (job);
+  job->done= true;
+  jobs.push_back (job);
+  next= jobs.size ();
+}
+
+bool
+pdf_deflate_queue::retrieve (unsigned long& key, const char*& data, size_t& n,
+                             bool& packed, bool wait) {
+  // Retrieve the oldest job if it is finished or if we are allowed to wait.
+  // The returned data remain valid until the next call to retrieve; they
+  // are the uncompressed data if packed is false.
+  release_last ();
+  if (first == jobs.size ()) return false;
+  pdf_deflate_job* job= jobs[first];
+#ifndef OS_MINGW
+  if (threads != NULL) {
+    pthread_mutex_lock (&threads->lock);
+    if (!job->done && !wait) {
+      pthread_mutex_unlock (&threads->lock);
+      return false;
+    }
+    while (!job->done)
+      pthread_cond_wait (&threads->ready, &threads->lock);
+    pthread_mutex_unlock (&threads->lock);
+  }
+#endif
+  jobs[first++]= NULL;
+  last= job;
+  key = job->key;
+  data  = job->out;
+  n     = job->out_n;
+  packed= job->packed;
+  return true;
+}
@@ -0,0 +1,57 @@
+
+/******************************************************************************
+* MODULE     : pdf_hummus_deflate.hpp
+* DESCRIPTION: Compression of pdf streams on worker threads
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef PDF_HUMMUS_DEFLATE_H
+#define PDF_HUMMUS_DEFLATE_H
+
+#include "config.h"
+#include <stddef.h>
+#include <vector>
+
+/******************************************************************************
+* Queues of streams to be compressed
+*******************************************************************************
+* The contents of the pages are generated on the main thread and submitted
+* to the queue, which compresses them on a small pool of worker threads.
+* The compressed streams are retrieved on the main thread, in the order in
+* which they were submitted, so that the numbering of the pdf objects and
+* the registration of resources remain sequential.  The workers only use
+* malloc and zlib and never touch any other data of the kernel.
+******************************************************************************/
+
+struct pdf_deflate_job;
+struct pdf_deflate_threads;
+
+class pdf_deflate_queue {
+  int                           nr_threads;
+  pdf_deflate_threads*          threads;
+  std::vector<pdf_deflate_job*> jobs;
+  size_t                        first;     // oldest job not yet retrieved
+  size_t                        next;      // first job not yet started
+  bool                          stop;      // workers should terminate
+  pdf_deflate_job*              last;      // last retrieved job
+
+  void start ();
+  void release_last ();
+
+public:
+  pdf_deflate_queue (int nr_threads);
+  ~pdf_deflate_queue ();
+  int  pending ();
+  void submit (unsigned long key, const char* data, size_t n);
+  bool retrieve (unsigned long& key, const char*& data, size_t& n,
+                 bool& packed, bool wait);
+  void run_worker ();
+};
+
+int pdf_deflate_default_threads ();
+
+#endif // defined PDF_HUMMUS_DEFLATE_H
@@ -10,6 +10,7 @@
 ******************************************************************************/
 
 #include "pdf_hummus_renderer.hpp"
+#include "pdf_hummus_deflate.hpp"
 #include "Metafont/tex_files.hpp"
 #include "Freetype/tt_file.hpp"
 #include "file.hpp"
@@ -53,6 +54,10 @@
 #include "PDFWriter/PDFTiledPattern.h"
 #include "PDFWriter/TiledPatternContentContext.h"
 #include "PDFWriter/PDFUsedFont.h"
+#include "PDFWriter/AbstractContentContext.h"
+#include "PDFWriter/OutputStringBufferStream.h"
+#include "PDFWriter/IPageEndWritingTask.h"
+#include "PDFWriter/MD5Generator.h"
  
 /******************************************************************************
  * pdf_hummus_renderer
@@ -69,6 +74,180 @@ class pdf_raw_image;
 class t3font;
 class pdf_pattern;
 
+/******************************************************************************
+* Page contents which are generated in memory
+*******************************************************************************
+* Instead of writing the contents of a page directly to the pdf file,
+* we generate them in a memory buffer, so that they can be compressed
+* on a worker thread while the next pages are being generated.
+******************************************************************************/
+
+class pdf_image_writing_task: public IPageEndWritingTask {
+  std::string path;
+  unsigned long index;
+  ObjectIDType id;
+  PDFParsingOptions options;
+public:
+  pdf_image_writing_task (const std::string& path2, unsigned long index2,
+                          ObjectIDType id2, const PDFParsingOptions& opts2):
+    path (path2), index (index2), id (id2), options (opts2) {}
+  PDFHummus::EStatusCode Write (PDFPage* pg, ObjectsContext* oc,
+                                PDFHummus::DocumentContext* dc) {
+    (void) pg; (void) oc;
+    return dc->WriteFormForImage (path, index, id, options); }
+};
+
+class pdf_page_content: public AbstractContentContext {
+  PDFPage* page;
+  OutputStringBufferStream buffer;
+public:
+  pdf_page_content (PDFHummus::DocumentContext* dc, PDFPage* pg):
+    AbstractContentContext (dc), page (pg) {
+      GetPrimitiveWriter ().SetStreamForWriting (&buffer); }
+  std::string contents () { return buffer.ToString (); }
+private:
+  ResourcesDictionary* GetResourcesDictionary () {
+    return &(page->GetResourcesDictionary ()); }
+  void ScheduleImageWrite (const std::string& path, unsigned long index,
+                           ObjectIDType id, const PDFParsingOptions& opts) {
+    mDocumentContext->RegisterPageEndWritingTask
+      (page, new pdf_image_writing_task (path, index, id, opts)); }
+};
+
+/******************************************************************************
+* Reusing the page contents of previous exports
+*******************************************************************************
+* For each exported file, we remember the compressed contents of its pages,
+* indexed by the md5 sums of the uncompressed contents.  When the same file
+* is exported again, for instance after each save in a continuous preview
+* workflow, the pages whose contents did not change are written without
+* compressing them again.
+******************************************************************************/
+
+#define PDF_PAGE_CACHE_MAX (64 << 20)
+
+static hashmap<string,hashmap<string,string> > pdf_page_cache;
+static hashmap<string,int> pdf_page_cache_size (0);
+
+static bool
+pdf_incremental_export () {
+  return get_preference ("incremental pdf export", "on") == "on";
+}
+
+static hashmap<string,string>
+pdf_page_cache_get (url name) {
+  string key= as_string (name);
+  if (!pdf_incremental_export () || !pdf_page_cache->contains (key))
+    return hashmap<string,string> ();
+  return pdf_page_cache[key];
+}
+
+static void
+pdf_page_cache_set (url name, hashmap<string,string> streams) {
+  string key= as_string (name);
+  pdf_page_cache->reset (key);
+  pdf_page_cache_size->reset (key);
+  if (!pdf_incremental_export ()) return;
+  int size= 0, total= 0;
+  iterator<string> it= iterate (streams);
+  while (it->busy ()) size += N(streams[it->next ()]);
+  if (size > PDF_PAGE_CACHE_MAX) return;
+  it= iterate (pdf_page_cache_size);
+  while (it->busy ()) total += pdf_page_cache_size[it->next ()];
+  if (total + size > PDF_PAGE_CACHE_MAX) {
+    pdf_page_cache= hashmap<string,hashmap<string,string> > ();
+    pdf_page_cache_size= hashmap<string,int> (0);
+  }
+  pdf_page_cache (key)= streams;
+  pdf_page_cache_size (key)= size;
+}
+
+/******************************************************************************
+* Sharing prepared images between exports
+*******************************************************************************
+* Images are identified by the md5 sums of their contents, so that copies
+* of the same picture under different names are embedded only once.
+* Images which need to be converted (png and all formats for which we call
+* an external converter) are prepared as single page pdf files, which are
+* kept in the cache directory and embedded as is by later exports,
+* also in later sessions.
+******************************************************************************/
+
+#define PDF_IMAGE_CACHE_MAX_FILES 1000
+
+static hashmap<string,string> pdf_image_sums;
+static hashmap<string,string> pdf_image_stamps;
+
+static bool
+pdf_image_cache_enabled () {
+  return get_preference ("pdf image cache", "on") == "on";
+}
+
+static string
+pdf_image_sum (url name) {
+  // md5 sum of an image file, which is only recomputed when it changes
+  string key= as_string (name);
+  string stamp= as_string (last_modified (name, false)) * ":" *
+                as_string (file_size (name));
+  if (pdf_image_stamps->contains (key) && pdf_image_stamps[key] == stamp)
+    return pdf_image_sums[key];
+  string s;
+  if (load_string (name, s, false)) return "";
+  MD5Generator md5;
+  if (N(s) > 0) md5.Accumulate (std::string (&s[0], N(s)));
+  string sum= md5.ToHexString().c_str();
+  pdf_image_stamps (key)= stamp;
+  pdf_image_sums (key)= sum;
+  return sum;
+}
+
+static url
+pdf_image_cache_dir () {
+  return url ("$TEXMACS_HOME_PATH/system/cache/pdf-images");
+}
+
+static url
+pdf_image_cache_file (url name, int w, int h) {
+  // the prepared pdf version of an image in the cache
+  if (!pdf_image_cache_enabled ()) return url_none ();
+  string sum= pdf_image_sum (name);
+  if (sum == "") return url_none ();
+  return pdf_image_cache_dir () *
+    (sum * "-" * as_string (w) * "x" * as_string (h) * ".pdf");
+}
+
+static void
+pdf_image_cache_store (url temp, url cached) {
+  url dir= pdf_image_cache_dir ();
+  if (!is_directory (dir)) mkdir (dir);
+  bool error_flag;
+  array<string> a= read_directory (dir, error_flag);
+  if (!error_flag && N(a) > PDF_IMAGE_CACHE_MAX_FILES) {
+    // evict the oldest files, until a quarter of the cache is free again
+    array<int> dates;
+    array<string> names;
+    for (int i=0; i<N(a); i++)
+      if (ends (a[i], ".pdf") || ends (a[i], ".part")) {
+        dates << last_modified (dir * a[i], false);
+        names << a[i];
+      }
+    merge_sort_leq<int,string,less_eq_operator<int> > (dates, names);
+    int n= N(names) - (3 * PDF_IMAGE_CACHE_MAX_FILES) / 4;
+    for (int i=0; i<n; i++) remove (dir * names[i]);
+  }
+  // write under a temporary name, so that concurrent or interrupted
+  // exports never leave a truncated file in the cache
+  string s;
+  if (load_string (temp, s, false)) return;
+  url part= dir * (as_string (tail (url_temp (""))) * ".part");
+  if (!save_string (part, s, false)) move (part, cached);
+  if (exists (part)) remove (part);
+}
+
+/******************************************************************************
+* The renderer
+******************************************************************************/
+
 class pdf_hummus_renderer_rep : public renderer_rep {
   
   static const int default_dpi= 72; // PDF initial coordinate system corresponds to 72 dpi
@@ -106,6 +285,7 @@ class pdf_hummus_renderer_rep : public renderer_rep {
   hashset<string> EuropeanComputerModern_fonts;
   hashmap<string,pdf_raw_image> pdf_glyphs;
   hashmap<tree,pdf_image> image_pool;
+  hashmap<tree,tree> image_keys;  // content based keys for image_pool
   hashmap<tree,pdf_image> pattern_image_pool;
   hashmap<tree,pdf_pattern> pattern_pool;
   hashmap<unsigned long long int,url> picture_cache;
@@ -131,7 +311,11 @@ class pdf_hummus_renderer_rep : public renderer_rep {
   
   PDFWriter pdfWriter;
   PDFPage* page;
-  PageContentContext* contentContext;
+  pdf_page_content* contentContext;
+  pdf_deflate_queue contents;  // page contents being compressed
+  hashmap<ObjectIDType,string> content_sum;  // md5 sums of pending contents
+  hashmap<string,string> old_streams;  // contents of the previous export
+  hashmap<string,string> new_streams;  // contents of the current export
   
   // geometry
   
@@ -165,6 +349,9 @@ class pdf_hummus_renderer_rep : public renderer_rep {
   
   void begin_page();
   void end_page();
+  void flush_contents (int max_pending);
+  void write_contents (ObjectIDType id, const char* data, size_t n,
+                       bool packed= true);
   
   int get_label_id(string label);
 
@@ -178,6 +365,7 @@ class pdf_hummus_renderer_rep : public renderer_rep {
   PDFImageXObject *create_pdf_image_raw (string raw_data, SI width, SI height, ObjectIDType imageXObjectID);
   void make_pdf_font (string fontname);
   void draw_bitmap_glyph (int ch, font_glyphs fn, SI x, SI y);
+  tree  image_key (url u);
   void  image (url u, double w, double h, SI x, SI y, int alpha);
   
   void bezier_arc (SI x1, SI y1, SI x2, SI y2, int alpha, int delta, bool filled);
@@ -298,7 +486,9 @@ pdf_hummus_renderer_rep::pdf_hummus_renderer_rep (
     t3font_registry_id(-1),
     destId(0),
     label_count(0),
-    outlineId(0)
+    outlineId(0),
+    contents (nr_pages2 > 1? pdf_deflate_default_threads (): 1),
+    old_streams (pdf_page_cache_get (pdf_file_name2))
 {
   width = default_dpi * paper_w / 2.54;
   height= default_dpi * paper_h / 2.54;
@@ -364,6 +554,8 @@ pdf_hummus_renderer_rep::pdf_hummus_renderer_rep (
 pdf_hummus_renderer_rep::~pdf_hummus_renderer_rep () {
   if (!started) return; // no cleanup to do
   end_page();
+  flush_contents (0);
+  pdf_page_cache_set (pdf_file_name, new_streams);
   
   flush_images();
   flush_patterns();
@@ -435,28 +627,23 @@ pdf_hummus_renderer_rep::begin_page() {
 
   page = new PDFPage();
   page->SetMediaBox(PDFRectangle(0,0,width,height));
-  contentContext = pdfWriter.StartPageContentContext(page);
-  if (NULL == contentContext) {
-    //status = PDFHummus::eFailure;
-    convert_error << "Failed to create content context for page\n";
-  } else {
-    fg  = -1;
-    bg  = -1;
-    lw  = -1;
-    current_width = -1.0;
-    cfn= "";
-    cfid = NULL;
-    inText = false;
-    clip_level = 0;
-    
-      // outmost save of the graphics state
-    contentContext->q();
-      // set scaling suitable for dpi (pdf default is 72)
-    contentContext->cm((double)default_dpi / dpi, 0, 0, (double)default_dpi / dpi, 0, 0);
-    
-    set_origin (0, paper_h*dpi*pixel/2.54);
-    set_clipping (0, (int) ((-dpi*pixel*paper_h)/2.54), (int) ((dpi*pixel*paper_w)/2.54), 0);
-  }
+  contentContext = new pdf_page_content(&pdfWriter.GetDocumentContext(), page);
+  fg  = -1;
+  bg  = -1;
+  lw  = -1;
+  current_width = -1.0;
+  cfn= "";
+  cfid = NULL;
+  inText = false;
+  clip_level = 0;
+  
+    // outmost save of the graphics state
+  contentContext->q();
+    // set scaling suitable for dpi (pdf default is 72)
+  contentContext->cm((double)default_dpi / dpi, 0, 0, (double)default_dpi / dpi, 0, 0);
+  
+  set_origin (0, paper_h*dpi*pixel/2.54);
+  set_clipping (0, (int) ((-dpi*pixel*paper_h)/2.54), (int) ((dpi*pixel*paper_w)/2.54), 0);
 }
 
 void
@@ -475,10 +662,28 @@ pdf_hummus_renderer_rep::end_page(){
   // outmost restore for the graphics state (see begin_page)
   contentContext->Q();
 
-  status = pdfWriter.EndPageContentContext(contentContext);
-  if (status != PDFHummus::eSuccess) {
-    convert_error << "Failed to end page content context\n";
+  // compress the contents in the background, unless they did not change
+  // since the previous export; the stream object is written by
+  // flush_contents once the compression is done
+  ObjectIDType content_id= pdfWriter.GetObjectsContext()
+    .GetInDirectObjectsRegistry().AllocateNewObjectID();
+  page->AddContentStreamReference(content_id);
+  std::string data= contentContext->contents();
+  MD5Generator md5;
+  md5.Accumulate(data);
+  const std::string& digest= md5.ToStringAsString();
+  string sum (digest.c_str(), (int) digest.size());
+  if (old_streams->contains (sum)) {
+    string stream= old_streams[sum];
+    new_streams (sum)= stream;
+    write_contents (content_id, &stream[0], N(stream));
+  }
+  else {
+    content_sum (content_id)= sum;
+    contents.submit(content_id, data.c_str(), data.size());
   }
+  delete contentContext;
+  contentContext= NULL;
   
   EStatusCodeAndObjectIDType res = pdfWriter.GetDocumentContext().WritePageAndRelease(page);
   status = res.first;
@@ -488,6 +693,42 @@ pdf_hummus_renderer_rep::end_page(){
 
   page_id (page_num) = res.second;
   page_num++;
+  flush_contents (16);
+}
+
+void
+pdf_hummus_renderer_rep::flush_contents (int max_pending) {
+  // write the compressed page contents which are ready, and wait
+  // for the oldest ones if too many of them are still pending
+  unsigned long id;
+  const char* data;
+  size_t n;
+  bool packed;
+  while (contents.retrieve (id, data, n, packed,
+                            contents.pending () > max_pending)) {
+    // contents which could not be compressed are written as they are
+    if (!packed) convert_error << "Failed to compress page contents\n";
+    else if (content_sum->contains (id))
+      new_streams (content_sum[id])= string (data, (int) n);
+    content_sum->reset (id);
+    write_contents (id, data, n, packed);
+  }
+}
+
+void
+pdf_hummus_renderer_rep::write_contents (ObjectIDType id, const char* data,
+                                         size_t n, bool packed) {
+  ObjectsContext& objectsContext= pdfWriter.GetObjectsContext();
+  objectsContext.StartNewIndirectObject(id);
+  DictionaryContext* dict= objectsContext.StartDictionary();
+  if (packed) {
+    dict->WriteKey("Filter");
+    dict->WriteNameValue("FlateDecode");
+  }
+  PDFStream* stream= objectsContext.StartUnfilteredPDFStream(dict);
+  stream->GetWriteStream()->Write((const IOBasicTypes::Byte*) data, n);
+  objectsContext.EndPDFStream(stream); // It does the EndIndirectObject()
+  delete stream;
 }
 
 void
@@ -600,6 +841,10 @@ public:
   bool flush_for_pattern (PDFWriter& pdfw);
 }; // class pdf_image_ref
 
+#ifndef PDFHUMMUS_NO_PNG
+static bool png_to_pdf (url image, url pdf, int w, int h);
+#endif
+
 class pdf_image {
   CONCRETE_NULL(pdf_image);
   pdf_image (url _u, ObjectIDType _id):
@@ -1754,12 +1999,30 @@ pdf_image_rep::flush (PDFWriter& pdfw)
   
     if ((s == "jpg") || (s == "jpeg")) 
       if (flush_jpg(pdfw, name)) return;
+    // images prepared by previous exports are embedded from the cache
+    url cached= pdf_image_cache_file (name, w, h);
+    if (!is_none (cached) && is_regular (cached)) {
+      temp= cached;
+      name= url_none ();
+    }
 #ifndef PDFHUMMUS_NO_PNG
-    if (s == "png")
+    else if (s == "png" && !is_none (cached)) {
+      if (png_to_pdf (name, temp, w, h)) pdf_image_cache_store (temp, cached);
+      else {
+        remove (temp);
+        if (flush_png(pdfw, name)) return;
+      }
+    }
+    else if (s == "png") {
       if (flush_png(pdfw, name)) return;
+    }
 #endif
-    // other formats we generate a pdf (with available converters) that we'll embbed
-    image_to_pdf (name, temp, w, h, 300);
+    else {
+      // other formats we generate a pdf (with available converters) that we'll embbed
+      image_to_pdf (name, temp, w, h, 300);
+      if (!is_none (cached) && is_regular (temp))
+        pdf_image_cache_store (temp, cached);
+    }
     // the 300 dpi setting is the maximum dpi of raster images that will be generated:
     // images that are to dense will de downsampled to keep file small
     // (other are not up-sampled) 
@@ -2012,6 +2275,50 @@ pdf_image_rep::flush_jpg (PDFWriter& pdfw, url image) {
 }
 
 #ifndef PDFHUMMUS_NO_PNG
+static bool
+png_to_pdf (url image, url pdf, int w, int h) {
+  // single page pdf of size w x h for a png image, as stored in the cache
+  c_string f (concretize (image));
+  c_string g (concretize (pdf));
+  PNGImageHandler pngHandler;
+  InputFile file;
+  if (file.OpenFile (std::string ((char*) f)) != PDFHummus::eSuccess)
+    return false;
+  IByteReaderWithPosition* stream= file.GetInputStream ();
+  DoubleAndDoublePair dim= pngHandler.ReadImageDimensions (stream);
+  double iw= dim.first, ih= dim.second;
+  if (iw <= 0 || ih <= 0) return false;
+  stream->SetPosition (0);
+
+  PDFWriter writer;
+  if (writer.StartPDF (std::string ((char*) g), ePDFVersion) != eSuccess)
+    return false;
+  PDFFormXObject* formXObject= writer.CreateFormXObjectFromPNGStream (stream);
+  if ((void*) formXObject == NULL) {
+    writer.EndPDF ();
+    return false;
+  }
+  PDFPage* pg= new PDFPage ();
+  pg->SetMediaBox (PDFRectangle (0, 0, w, h));
+  PageContentContext* ctx= writer.StartPageContentContext (pg);
+  if (ctx == NULL) {
+    delete pg;
+    delete formXObject;
+    writer.EndPDF ();
+    return false;
+  }
+  ctx->q ();
+  ctx->cm (w / iw, 0, 0, h / ih, 0, 0);
+  ctx->Do (pg->GetResourcesDictionary ()
+           .AddFormXObjectMapping (formXObject->GetObjectID ()));
+  ctx->Q ();
+  writer.EndPageContentContext (ctx);
+  EStatusCode status= writer.WritePageAndRelease (pg);
+  delete formXObject;
+  if (writer.EndPDF () != eSuccess) status= eFailure;
+  return status == eSuccess;
+}
+
 bool
 pdf_image_rep::flush_png (PDFWriter& pdfw, url image) {
   c_string f (concretize (image));
@@ -2073,13 +2380,29 @@ pdf_hummus_renderer_rep::flush_patterns ()
   }
 }
 
+tree
+pdf_hummus_renderer_rep::image_key (url u) {
+  // images with the same contents share the same form XObject,
+  // whatever their names and the transformations with which they are drawn
+  tree lookup= tuple (u->t);
+  if (image_keys->contains (lookup)) return image_keys[lookup];
+  tree key= lookup;
+  url name= resolve (u);
+  if (!is_none (name)) {
+    string sum= pdf_image_sum (name);
+    if (sum != "") key= tuple ("md5", sum, suffix (name));
+  }
+  image_keys (lookup)= key;
+  return key;
+}
+
 void
 pdf_hummus_renderer_rep::image (
   url u, double w, double h, SI x, SI y, int alpha)
 {
   // debug_convert << "pdf renderer, image " << u << ", " << w << " x " << h
   //		<< " + (" << x << ", " << y << ")" << LF;
-  tree lookup= tuple (u->t);
+  tree lookup= image_key (u);
   pdf_image im = ( image_pool->contains(lookup) ? image_pool[lookup] : pdf_image() );
   
   if (is_nil(im)) {
@@ -0,0 +1,199 @@
+
+/******************************************************************************
+* MODULE     : qt_glyph_atlas.cpp
+* DESCRIPTION: color independent cache of glyph coverage masks
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "qt_glyph_atlas.hpp"
+
+#define ATLAS_SHEET_SIZE  1024
+#define ATLAS_MAX_SHEETS  64
+#define ATLAS_PADDING     1
+
+// 8-bit alpha images only exist since Qt 5.5; older versions store
+// the coverage in the alpha channel of premultiplied ARGB images
+#if QT_VERSION >= 0x050500
+#define ATLAS_FORMAT      QImage::Format_Alpha8
+#define ATLAS_DEPTH       1
+#else
+#define ATLAS_FORMAT      QImage::Format_ARGB32_Premultiplied
+#define ATLAS_DEPTH       4
+#endif
+
+/******************************************************************************
+* Keys of the atlas
+******************************************************************************/
+
+bool
+operator == (qt_atlas_key k1, qt_atlas_key k2) {
+  return
+    (k1->c==k2->c) && (k1->fng.rep==k2->fng.rep) &&
+    (k1->sf==k2->sf) && (k1->dpr==k2->dpr);
+}
+
+bool
+operator != (qt_atlas_key k1, qt_atlas_key k2) {
+  return
+    (k1->c!=k2->c) || (k1->fng.rep!=k2->fng.rep) ||
+    (k1->sf!=k2->sf) || (k1->dpr!=k2->dpr);
+}
+
+int
+hash (qt_atlas_key k) {
+  return k->c ^ ((intptr_t) k->fng.rep) ^ k->sf ^ (k->dpr << 8);
+}
+
+/******************************************************************************
+* Global state of the atlas
+******************************************************************************/
+
+static hashmap<qt_atlas_key,qt_atlas_glyph> atlas_glyphs;
+static QImage* sheet_image[ATLAS_MAX_SHEETS];
+static array<qt_atlas_key> sheet_keys[ATLAS_MAX_SHEETS];
+static int sheet_use[ATLAS_MAX_SHEETS];
+static int nr_sheets = 0;
+static int max_sheets= 16;  // 16Mb with the default sheet size
+static int current   = -1;  // sheet which is currently being filled
+static int shelf_x   = 0;   // free position on the current shelf
+static int shelf_y   = 0;   // vertical position of the current shelf
+static int shelf_h   = 0;   // height of the current shelf
+static int atlas_tick= 0;   // incremented at each use of the atlas
+static int atlas_run = 0;   // tick at the start of the current run
+
+void
+atlas_set_budget (int bytes) {
+  int sheet_bytes= ATLAS_SHEET_SIZE * ATLAS_SHEET_SIZE * ATLAS_DEPTH;
+  max_sheets= max (1, min (ATLAS_MAX_SHEETS, bytes / sheet_bytes));
+}
+
+int
+atlas_memory () {
+  return nr_sheets * ATLAS_SHEET_SIZE * ATLAS_SHEET_SIZE * ATLAS_DEPTH;
+}
+
+int
+atlas_entries () {
+  return N(atlas_glyphs);
+}
+
+QImage*
+atlas_sheet (int i) {
+  ASSERT (i >= 0 && i < nr_sheets, "invalid atlas sheet");
+  return sheet_image[i];
+}
+
+void
+atlas_clear () {
+  for (int i=0; i<nr_sheets; i++) {
+    delete sheet_image[i];
+    sheet_image[i]= NULL;
+    sheet_keys[i]= array<qt_atlas_key> ();
+  }
+  atlas_glyphs= hashmap<qt_atlas_key,qt_atlas_glyph> ();
+  nr_sheets= 0;
+  current= -1;
+  shelf_x= shelf_y= shelf_h= 0;
+}
+
+/******************************************************************************
+* Allocation of space on the sheets
+******************************************************************************/
+
+static bool
+atlas_new_sheet () {
+  // Sheets which have been used since the start of the current run
+  // cannot be recycled, since the run may still refer to them
+  int i= -1;
+  if (nr_sheets < max_sheets) i= nr_sheets;
+  else {
+    for (int j=0; j<nr_sheets; j++)
+      if (sheet_use[j] < atlas_run && (i < 0 || sheet_use[j] < sheet_use[i]))
+        i= j;
+    if (i < 0 && nr_sheets < ATLAS_MAX_SHEETS) i= nr_sheets;
+    if (i < 0) return false;
+  }
+  if (i == nr_sheets) {
+    sheet_image[i]= new QImage (ATLAS_SHEET_SIZE, ATLAS_SHEET_SIZE,
+                                ATLAS_FORMAT);
+    nr_sheets++;
+  }
+  else {
+    array<qt_atlas_key> keys= sheet_keys[i];
+    for (int k=0; k<N(keys); k++) atlas_glyphs->reset (keys[k]);
+    sheet_keys[i]= array<qt_atlas_key> ();
+  }
+  sheet_image[i]->fill (0);
+  sheet_use[i]= atlas_tick;
+  current= i;
+  shelf_x= shelf_y= shelf_h= 0;
+  return true;
+}
+
+static bool
+atlas_place (int w, int h, int& x, int& y) {
+  if (current < 0) return false;
+  if (shelf_x + w > ATLAS_SHEET_SIZE) {
+    shelf_y += shelf_h;
+    shelf_x= 0;
+    shelf_h= 0;
+  }
+  if (shelf_y + h > ATLAS_SHEET_SIZE) return false;
+  x= shelf_x;
+  y= shelf_y;
+  shelf_x += w + ATLAS_PADDING;
+  shelf_h= max (shelf_h, h + ATLAS_PADDING);
+  return true;
+}
+
+/******************************************************************************
+* Looking up and inserting glyphs
+******************************************************************************/
+
+void
+atlas_start_run () {
+  atlas_run= ++atlas_tick;
+}
+
+qt_atlas_glyph
+atlas_lookup (qt_atlas_key k) {
+  qt_atlas_glyph g= atlas_glyphs [k];
+  if (!is_nil (g)) sheet_use[g->sheet]= atlas_tick;
+  return g;
+}
+
+qt_atlas_glyph
+atlas_insert (qt_atlas_key k, glyph gl, SI xo, SI yo) {
+  int i, j, x, y, w= gl->width, h= gl->height;
+  if (w <= 0 || h <= 0 ||
+      w > ATLAS_SHEET_SIZE || h > ATLAS_SHEET_SIZE) return qt_atlas_glyph ();
+  if (!atlas_place (w, h, x, y)) {
+    if (!atlas_new_sheet ()) return qt_atlas_glyph ();
+    if (!atlas_place (w, h, x, y)) return qt_atlas_glyph ();
+  }
+
+  int nr_cols= k->sf * k->sf;
+  if (nr_cols >= 64) nr_cols= 64;
+  QImage* im= sheet_image[current];
+  for (j=0; j<h; j++) {
+#if QT_VERSION >= 0x050500
+    uchar* line= im->scanLine (y + j) + x;
+    for (i=0; i<w; i++)
+      line[i]= (uchar) min (255, (255 * gl->get_x (i, j)) / nr_cols);
+#else
+    QRgb* line= ((QRgb*) im->scanLine (y + j)) + x;
+    for (i=0; i<w; i++)
+      line[i]= qRgba (0, 0, 0, min (255, (255 * gl->get_x (i, j)) / nr_cols));
+#endif
+  }
+
+  qt_atlas_glyph g (current, x, y, w, h, xo, yo);
+  atlas_glyphs (k)= g;
+  sheet_keys[current] << k;
+  sheet_use[current]= atlas_tick;
+  return g;
+}
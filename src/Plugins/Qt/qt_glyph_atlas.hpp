@@ -0,0 +1,75 @@
+
+/******************************************************************************
+* MODULE     : qt_glyph_atlas.hpp
+* DESCRIPTION: color independent cache of glyph coverage masks
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef QT_GLYPH_ATLAS_HPP
+#define QT_GLYPH_ATLAS_HPP
+
+#include "basic_renderer.hpp"
+#include <QImage>
+
+/******************************************************************************
+* The anti-aliased coverage masks of shrunk glyphs are packed into a few
+* large 8-bit alpha sheets, independently of the color in which they are
+* drawn; the color is only applied at drawing time.  Sheets are filled
+* shelf by shelf and, when the memory budget is exhausted, the least
+* recently used sheet is recycled together with all glyphs on it.
+******************************************************************************/
+
+struct qt_atlas_key_rep: concrete_struct {
+  int          c;     // glyph index
+  font_glyphs  fng;   // font from which the glyph is taken
+  int          sf;    // shrinking factor
+  int          dpr;   // device pixel ratio times 100
+  qt_atlas_key_rep (int c2, font_glyphs fng2, int sf2, int dpr2):
+    c (c2), fng (fng2), sf (sf2), dpr (dpr2) {}
+  friend class qt_atlas_key;
+};
+
+class qt_atlas_key {
+CONCRETE(qt_atlas_key);
+  qt_atlas_key (int c=0, font_glyphs fng= font_glyphs (),
+                int sf=1, int dpr= 100):
+    rep (tm_new<qt_atlas_key_rep> (c, fng, sf, dpr)) {}
+};
+CONCRETE_CODE(qt_atlas_key);
+
+bool operator == (qt_atlas_key k1, qt_atlas_key k2);
+bool operator != (qt_atlas_key k1, qt_atlas_key k2);
+int hash (qt_atlas_key k);
+
+struct qt_atlas_glyph_rep: concrete_struct {
+  int sheet;     // sheet on which the coverage mask is stored
+  int x, y;      // position of the mask on the sheet
+  int w, h;      // size of the mask
+  SI  xo, yo;    // origin of the shrunk glyph
+  qt_atlas_glyph_rep (int s2, int x2, int y2, int w2, int h2,
+                      SI xo2, SI yo2):
+    sheet (s2), x (x2), y (y2), w (w2), h (h2), xo (xo2), yo (yo2) {}
+  friend class qt_atlas_glyph;
+};
+
+class qt_atlas_glyph {
+CONCRETE_NULL(qt_atlas_glyph);
+  qt_atlas_glyph (int s2, int x2, int y2, int w2, int h2, SI xo2, SI yo2):
+    rep (tm_new<qt_atlas_glyph_rep> (s2, x2, y2, w2, h2, xo2, yo2)) {}
+};
+CONCRETE_NULL_CODE(qt_atlas_glyph);
+
+void atlas_start_run ();
+qt_atlas_glyph atlas_lookup (qt_atlas_key k);
+qt_atlas_glyph atlas_insert (qt_atlas_key k, glyph gl, SI xo, SI yo);
+QImage* atlas_sheet (int i);
+void atlas_set_budget (int bytes);
+int  atlas_memory ();
+int  atlas_entries ();
+void atlas_clear ();
+
+#endif // defined QT_GLYPH_ATLAS_HPP
@@ -27,6 +27,8 @@
 #include <QPaintDevice>
 #include <QPixmap>
 #include <QSvgRenderer>
+#include <QThreadPool>
+#include <QRunnable>
 
 /******************************************************************************
 * Abstract Qt pictures
@@ -416,3 +418,27 @@ save_picture (url dest, picture p) {
   if (exists (dest)) remove (dest);
   pict->pict.save (utf8_to_qstring (concretize (dest)));
 }
+
+class qt_save_picture_task: public QRunnable {
+  QImage  im;
+  QString name;
+public:
+  qt_save_picture_task (const QImage& im2, const QString& name2):
+    im (im2), name (name2) {}
+  void run () { im.save (name); }
+};
+
+void
+save_pictures (array<url> dests, array<picture> ps) {
+  // the images are encoded in parallel; the workers only access
+  // their own (implicitly shared) copies of the images
+  QThreadPool pool;
+  for (int i=0; i<N(ps); i++) {
+    picture q= as_qt_picture (ps[i]);
+    qt_picture_rep* pict= (qt_picture_rep*) q->get_handle ();
+    if (exists (dests[i])) remove (dests[i]);
+    QString name= utf8_to_qstring (concretize (dests[i]));
+    pool.start (new qt_save_picture_task (pict->pict, name));
+  }
+  pool.waitForDone ();
+}
@@ -17,6 +17,7 @@
 #include "image_files.hpp"
 #include "scheme.hpp"
 #include "frame.hpp"
+#include "qt_glyph_atlas.hpp"
 
 #include <QObject>
 #include <QWidget>
@@ -24,29 +25,6 @@
 #include <QPainterPath>
 #include <QPixmap>
 
-/******************************************************************************
-* Qt images
-******************************************************************************/
-
-struct qt_image_rep: concrete_struct {
-  QTMImage *img;
-  SI xo,yo;
-  int w,h;
-  qt_image_rep (QTMImage* img2, SI xo2, SI yo2, int w2, int h2):
-    img (img2), xo (xo2), yo (yo2), w (w2), h (h2) {};
-  ~qt_image_rep() { delete img; };
-  friend class qt_image;
-};
-
-class qt_image {
-CONCRETE_NULL(qt_image);
-  qt_image (QTMImage* img2, SI xo2, SI yo2, int w2, int h2):
-    rep (tm_new<qt_image_rep> (img2, xo2, yo2, w2, h2)) {};
-  // qt_image ();
-};
-
-CONCRETE_NULL_CODE(qt_image);
-
 /******************************************************************************
  * Qt pixmaps
  ******************************************************************************/
@@ -74,8 +52,6 @@ CONCRETE_NULL_CODE(qt_pixmap);
 * Global support variables for all qt_renderers
 ******************************************************************************/
 
-// bitmaps of all characters
-static hashmap<basic_character,qt_image> character_image;  
 // image cache
 static hashmap<string,qt_pixmap> images;
 
@@ -85,7 +61,7 @@ static hashmap<string,qt_pixmap> images;
 ** Qt exit function
 */
 void del_obj_qt_renderer(void)  {
-  character_image= hashmap<basic_character,qt_image> ();  
+  atlas_clear ();
   images= hashmap<string,qt_pixmap>() ;
 }
 
@@ -580,6 +556,38 @@ qt_renderer_rep::draw_bis (int c, font_glyphs fng, SI x, SI y) {
   delete im;
 }
 
+static QImage*
+tinted_image (glyph gl, int sf, int r, int g, int b, int a) {
+  int i, j, w= gl->width, h= gl->height;
+  int nr_cols= sf*sf;
+  if (nr_cols >= 64) nr_cols= 64;
+  QImage *im= new QImage (w, h, QImage::Format_ARGB32);
+  for (j=0; j<h; j++)
+    for (i=0; i<w; i++) {
+      int col = gl->get_x (i, j);
+      im->setPixel (i, j, qRgba (r, g, b, (a*col)/nr_cols));
+    }
+  return im;
+}
+
+// Single glyphs are drawn directly from a small direct mapped cache of
+// tinted images, so that drawing character by character remains as fast
+// as before; only runs of glyphs are assembled from the atlas.
+
+#define TINTED_BITS 10
+#define TINTED_SIZE (1 << TINTED_BITS)
+
+struct qt_tinted_glyph {
+  qt_atlas_key key;
+  color        col;
+  QTMImage*    im;
+  SI           xo, yo;
+  int          w, h;
+  qt_tinted_glyph (): col (0), im (NULL), xo (0), yo (0), w (0), h (0) {}
+};
+
+static qt_tinted_glyph tinted_glyphs[TINTED_SIZE];
+
 void
 qt_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
   if (pen->get_type () == pencil_brush) {
@@ -587,14 +595,20 @@ qt_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
     return;
   }
 
-  // get the pixmap
   color fgc= pen->get_color ();
-  basic_character xc (c, fng, std_shrinkf, fgc, 0);
-  qt_image mi = character_image [xc];
-  if (is_nil(mi)) {
-    int r, g, b, a;
-    get_rgb (fgc, r, g, b, a);
-    if (get_reverse_colors ()) reverse (r, g, b);
+  int r, g, b, a;
+  get_rgb (fgc, r, g, b, a);
+  if (get_reverse_colors ()) reverse (r, g, b);
+  color col= rgb_color (r, g, b, a);
+#if QT_VERSION >= 0x060000
+  int dpr= (int) (100 * get_dpr () + 0.5);
+#else
+  int dpr= 100;
+#endif
+  qt_atlas_key k (c, fng, std_shrinkf, dpr);
+  qt_tinted_glyph& tg=
+    tinted_glyphs[(hash (k) ^ (int) col) & (TINTED_SIZE - 1)];
+  if (tg.im == NULL || tg.col != col || tg.key != k) {
     SI xo, yo;
     glyph pre_gl= fng->get (c); if (is_nil (pre_gl)) return;
 #if QT_VERSION >= 0x060000
@@ -602,67 +616,135 @@ qt_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
 #else
     glyph gl= shrink (pre_gl, std_shrinkf, std_shrinkf, xo, yo);
 #endif
-    int i, j, w= gl->width, h= gl->height;
+    if (gl->width <= 0 || gl->height <= 0) return;
+    QImage* im= tinted_image (gl, std_shrinkf, r, g, b, a);
+    if (tg.im != NULL) delete tg.im;
 #ifdef QTMPIXMAPS
-    QTMPixmapOrImage* im= new QTMPixmapOrImage (w, h);
-    if (!headless_mode) {
-      int nr_cols= std_shrinkf*std_shrinkf;
-      if (nr_cols >= 64) nr_cols= 64;
-
-      im->fill (Qt::transparent);
-      QPainter pp(im->QPixmap_ptr ());
-      QPen pen(painter->pen());
-      QBrush br(pen.color());
-      pp.setPen(Qt::NoPen);
-      for (j=0; j<h; j++)
-        for (i=0; i<w; i++) {
-          int col = gl->get_x (i, j);
-          br.setColor (QColor (r, g, b, (a*col)/nr_cols));
-          pp.fillRect (i, j, 1, 1, br);
-        }
-      pp.end();
-    }
-    else {
-      QImage* aux= im->QImage_ptr ();
-      int nr_cols= std_shrinkf*std_shrinkf;
-      if (nr_cols >= 64) nr_cols= 64;
-      im->fill (Qt::transparent);
-      for (j=0; j<h; j++)
-        for (i=0; i<w; i++) {
-          int col = gl->get_x (i, j);
-          aux->setPixel (i, j, qRgba (r, g, b, (a*col)/nr_cols));
-        }
-    }
+    if (headless_mode) tg.im= new QTMPixmapOrImage (*im);
+    else tg.im= new QTMPixmapOrImage (QPixmap::fromImage (*im));
+    delete im;
+#else
+    tg.im= im;
+#endif
+    tg.key= k; tg.col= col;
+    tg.xo= xo; tg.yo= yo;
+    tg.w= gl->width; tg.h= gl->height;
+  }
+  draw_clipped (tg.im, tg.w, tg.h, x- tg.xo*std_shrinkf, y+ tg.yo*std_shrinkf);
+}
+
+void
+qt_renderer_rep::draw_glyphs (array<int> cs, font_glyphs fng,
+                              array<SI> xs, SI y) {
+  int i, n= N(cs);
+  if (n == 1 || pen->get_type () == pencil_brush) {
+    for (i=0; i<n; i++) draw (cs[i], fng, xs[i], y);
+    return;
+  }
+
+  color fgc= pen->get_color ();
+  int r, g, b, a;
+  get_rgb (fgc, r, g, b, a);
+  if (get_reverse_colors ()) reverse (r, g, b);
+#if QT_VERSION >= 0x060000
+  int dpr= (int) (100 * get_dpr () + 0.5);
 #else
-    QTMImage *im= new QImage (w, h, QImage::Format_ARGB32);
-    //QTMImage *im= new QImage (w, h, QImage::Format_ARGB32_Premultiplied);
-    {
-      int nr_cols= std_shrinkf*std_shrinkf;
-      if (nr_cols >= 64) nr_cols= 64;
-
-      // the following line is disabled because
-      // it causes a crash on Qt/X11 4.4.3
-      //im->fill (Qt::transparent);
-
-      for (j=0; j<h; j++)
-        for (i=0; i<w; i++) {
-          int col = gl->get_x (i, j);
-          im->setPixel (i, j, qRgba (r, g, b, (a*col)/nr_cols));
-        }
+  int dpr= 100;
+#endif
+
+  // collect the coverage masks of the glyphs in the atlas
+  atlas_start_run ();
+  array<qt_atlas_glyph> gs (n);
+  array<int> px (n), py (n);
+  int x1= 0, y1= 0, x2= 0, y2= 0;
+  bool empty= true;
+  for (i=0; i<n; i++) {
+    qt_atlas_key k (cs[i], fng, std_shrinkf, dpr);
+    qt_atlas_glyph ag= atlas_lookup (k);
+    if (is_nil (ag)) {
+      SI xo, yo;
+      glyph pre_gl= fng->get (cs[i]); if (is_nil (pre_gl)) continue;
+#if QT_VERSION >= 0x060000
+      glyph gl= shrink (pre_gl, std_shrinkf, std_shrinkf, xo, yo, get_dpr());
+#else
+      glyph gl= shrink (pre_gl, std_shrinkf, std_shrinkf, xo, yo);
+#endif
+      ag= atlas_insert (k, gl, xo, yo);
+      if (is_nil (ag)) {
+        // glyph too large for the atlas
+        if (gl->width <= 0 || gl->height <= 0) continue;
+        QImage* im= tinted_image (gl, std_shrinkf, r, g, b, a);
+        draw_clipped (im, gl->width, gl->height,
+                      xs[i]- xo*std_shrinkf, y+ yo*std_shrinkf);
+        delete im;
+        continue;
+      }
     }
+    SI gx= xs[i]- ag->xo*std_shrinkf, gy= y+ ag->yo*std_shrinkf;
+    decode (gx, gy);
+    gy--; // top-left origin to bottom-left origin conversion
+    gs[i]= ag; px[i]= gx; py[i]= gy;
+    if (empty || gx < x1) x1= gx;
+    if (empty || gy < y1) y1= gy;
+    if (empty || gx + ag->w > x2) x2= gx + ag->w;
+    if (empty || gy + ag->h > y2) y2= gy + ag->h;
+    empty= false;
+  }
+  if (empty) return;
+
+  // assemble the masks and tint them with the current color;
+  // as before, the run is drawn through a pixmap if QTMPIXMAPS is set,
+  // except in headless mode, where no pixmaps can be created
+  static QTMImage* run_image= NULL;
+  static int run_w= 0, run_h= 0;
+  int w= x2 - x1, h= y2 - y1;
+  if (run_image == NULL || run_w < w || run_h < h) {
+    if (run_image != NULL) delete run_image;
+    run_w= max (run_w, w);
+    run_h= max (run_h, h);
+#ifdef QTMPIXMAPS
+    run_image= new QTMPixmapOrImage (run_w, run_h);
+#else
+    run_image= new QImage (run_w, run_h, QImage::Format_ARGB32_Premultiplied);
 #endif
-    qt_image mi2 (im, xo, yo, w, h);
-    mi = mi2;
-    //[im release]; // qt_image retains im
-    character_image (xc)= mi;
-    // FIXME: we must release the image at some point 
-    //        (this should be ok now, see qt_image)
   }
+#ifdef QTMPIXMAPS
+  QPaintDevice* dev;
+  if (headless_mode) dev= run_image->QImage_ptr ();
+  else dev= run_image->QPixmap_ptr ();
+  QPainter pp (dev);
+#else
+  QPainter pp (run_image);
+#endif
+  pp.setCompositionMode (QPainter::CompositionMode_Source);
+  pp.fillRect (0, 0, w, h, Qt::transparent);
+  pp.setCompositionMode (QPainter::CompositionMode_SourceOver);
+  for (i=0; i<n; i++)
+    if (!is_nil (gs[i])) {
+      qt_atlas_glyph ag= gs[i];
+      pp.drawImage (QPoint (px[i] - x1, py[i] - y1), *atlas_sheet (ag->sheet),
+                    QRect (ag->x, ag->y, ag->w, ag->h));
+    }
+  pp.setCompositionMode (QPainter::CompositionMode_SourceIn);
+  pp.fillRect (0, 0, w, h, QColor (r, g, b, a));
+  pp.end ();
 
-  // draw the character
-  //cout << (char)c << ": " << cx1/256 << ","  << cy1/256 << ","  
-  //<< cx2/256 << ","  << cy2/256 << LF; 
-  draw_clipped (mi->img, mi->w, mi->h, x- mi->xo*std_shrinkf, y+ mi->yo*std_shrinkf);
+  // draw the run
+#if QT_VERSION < 0x060000
+  painter->setRenderHints (0);
+#else
+  painter->setRenderHints (QPainter::Antialiasing, false);
+#endif
+#ifdef QTMPIXMAPS
+  if (!headless_mode)
+    painter->drawPixmap (QPoint (x1, y1), *(run_image->QPixmap_ptr ()),
+                         QRect (0, 0, w, h));
+  else
+    painter->drawImage (QPoint (x1, y1), *(run_image->QImage_ptr ()),
+                        QRect (0, 0, w, h));
+#else
+  painter->drawImage (QPoint (x1, y1), *run_image, QRect (0, 0, w, h));
+#endif
 }
 
 void
@@ -686,6 +768,8 @@ the_qt_renderer (double dpr) {
   static QPainter *the_painter = NULL;
   static qt_renderer_rep* the_renderer= NULL;
   if (!the_renderer) {
+    int mb= as_int (get_preference ("glyph cache size", "16"));
+    atlas_set_budget (max (mb, 1) << 20);
     the_painter = new QPainter();
 #if QT_VERSION >= 0x060000
     the_renderer= tm_new<qt_renderer_rep> (the_painter, dpr, 0, 0);
@@ -11,6 +11,7 @@
 
 #include "unix_system.hpp"
 #include "config.h"
+#include <sys/mman.h>
 #ifdef QTTEXMACS
 #include <QGuiApplication>
 #include <QStyleHints>
@@ -86,6 +87,17 @@ ssize_t texmacs_fread (char *z, size_t n, FILE *stream) {
   return fread(z, 1, n, stream);
 }
 
+char* texmacs_fmap (FILE *stream, size_t size) {
+  if (size == 0) return nullptr;
+  void *data= mmap(nullptr, size, PROT_READ, MAP_SHARED, fileno(stream), 0);
+  if (data == MAP_FAILED) return nullptr;
+  return (char*) data;
+}
+
+void texmacs_funmap (char *data, size_t size) {
+  munmap(data, size);
+}
+
 ssize_t texmacs_fwrite (const char *s, size_t n, FILE *stream) {
   if (stream != stdout && stream != stderr) {
     size_t ret= fwrite (s, n, 1, stream);
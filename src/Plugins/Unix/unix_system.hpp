@@ -48,6 +48,18 @@ ssize_t texmacs_fsize(FILE *stream);
  */
 ssize_t texmacs_fread(char *z, size_t n, FILE *stream);
 
+/*
+ * @brief Map the contents of a file which has been opened for reading
+ * into memory; the mapping is read-only and shared with other processes
+ * @return the start of the mapping, or nullptr if the file cannot be mapped
+ */
+char* texmacs_fmap (FILE *stream, size_t size);
+
+/*
+ * @brief Release a mapping which was obtained using texmacs_fmap
+ */
+void texmacs_funmap (char *data, size_t size);
+
 /*
  * @brief Proxy function to the fwrite function.
  */
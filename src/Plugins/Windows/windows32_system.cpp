@@ -57,6 +57,23 @@ ssize_t texmacs_fread (char *z, size_t n, FILE *stream) {
   return fread(z, 1, n, stream);
 }
 
+char* texmacs_fmap (FILE *stream, size_t size) {
+  if (size == 0) return nullptr;
+  HANDLE file= (HANDLE) _get_osfhandle(_fileno(stream));
+  if (file == INVALID_HANDLE_VALUE) return nullptr;
+  HANDLE mapping= CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) return nullptr;
+  void *data= MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+  // the view keeps the mapping alive
+  CloseHandle(mapping);
+  return (char*) data;
+}
+
+void texmacs_funmap (char *data, size_t size) {
+  (void) size;
+  UnmapViewOfFile(data);
+}
+
 ssize_t texmacs_fwrite(const char *string, size_t size, FILE *stream) {
   if (stream != stdout && stream != stderr) {
     size_t ret= fwrite(string, size, 1, stream);
@@ -300,3 +300,9 @@ save_picture (url dest, picture p) {
   (void) dest; (void) p;
   FAILED ("saving bitmap pictures has not been implemented under X11");
 }
+
+void
+save_pictures (array<url> dests, array<picture> ps) {
+  for (int i=0; i<N(ps); i++)
+    save_picture (dests[i], ps[i]);
+}
@@ -72,6 +72,22 @@
   (texmacs-memory mem_used (int))
   (bench-print bench_print (void string))
   (bench-print-all bench_print (void))
+  (bench-time bench_time (double))
+  (bench-reset bench_reset (void string))
+  (bench-reset-all bench_reset (void))
+  (trace-start trace_start (void))
+  (trace-stop trace_stop (void))
+  (trace-busy? trace_busy (bool))
+  (trace-export trace_export (bool url))
+  (trace-summary trace_summary (string))
+  (latency-reset latency_reset (void))
+  (latency-count latency_count (int string))
+  (latency-percentile latency_percentile (double string double))
+  (latency-histogram latency_histogram (array_int string))
+  (latency-bucket-limits latency_bucket_limits (array_int))
+  (latency-report latency_report (string))
+  (latency-record-start latency_record_start (void url))
+  (latency-record-stop latency_record_stop (void))
   (system-wait system_wait (void string string))
   (get-show-kbd get_show_kbd (bool))
   (set-show-kbd set_show_kbd (void bool))
@@ -759,6 +775,9 @@
   (buffer-import buffer_import (bool url url string))
   (buffer-load buffer_load (bool url))
   (buffer-export buffer_export (bool url url string))
+  (buffer-autosave buffer_autosave (bool url url))
+  (background-save-status background_save_status (int url))
+  (background-save-wait background_save_wait (void))
   (buffer-save buffer_save (bool url))
   (tree-import-loaded import_loaded_tree (tree string url string))
   (tree-import import_tree (tree url string))
@@ -178,6 +178,7 @@
 
   ;; keyboard and mouse handling
   (key-press key_press (void string))
+  (replay-key-press replay_key_press (void string))
   (raw-emulate-keyboard emulate_keyboard (void string))
   (complete-try? complete_try (bool))
   (get-input-mode get_input_mode (int))
@@ -336,6 +337,9 @@
   (print print_buffer (void))
   (print-pages print_buffer (void string string))
   (print-snippet print_snippet (array_int url content bool))
+  (print-snippets print_snippets (array_int array_url array_tree bool))
+  (begin-snippets begin_snippets (void))
+  (end-snippets end_snippets (void))
   (graphics-file-to-clipboard graphics_file_to_clipboard (bool url))
   (export-postscript export_ps (void url))
   (export-pages-postscript export_ps (void url string string))
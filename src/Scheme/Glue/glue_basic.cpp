@@ -581,6 +581,176 @@ tmg_bench_print_all () {
   return TMSCM_UNSPECIFIED;
 }
 
+tmscm
+tmg_bench_time () {
+  // TMSCM_DEFER_INTS;
+  double out= bench_time ();
+  // TMSCM_ALLOW_INTS;
+
+  return double_to_tmscm (out);
+}
+
+tmscm
+tmg_bench_reset (tmscm arg1) {
+  TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "bench-reset");
+
+  string in1= tmscm_to_string (arg1);
+
+  // TMSCM_DEFER_INTS;
+  bench_reset (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_bench_reset_all () {
+  // TMSCM_DEFER_INTS;
+  bench_reset ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_trace_start () {
+  // TMSCM_DEFER_INTS;
+  trace_start ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_trace_stop () {
+  // TMSCM_DEFER_INTS;
+  trace_stop ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_trace_busyP () {
+  // TMSCM_DEFER_INTS;
+  bool out= trace_busy ();
+  // TMSCM_ALLOW_INTS;
+
+  return bool_to_tmscm (out);
+}
+
+tmscm
+tmg_trace_export (tmscm arg1) {
+  TMSCM_ASSERT_URL (arg1, TMSCM_ARG1, "trace-export");
+
+  url in1= tmscm_to_url (arg1);
+
+  // TMSCM_DEFER_INTS;
+  bool out= trace_export (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return bool_to_tmscm (out);
+}
+
+tmscm
+tmg_trace_summary () {
+  // TMSCM_DEFER_INTS;
+  string out= trace_summary ();
+  // TMSCM_ALLOW_INTS;
+
+  return string_to_tmscm (out);
+}
+
+tmscm
+tmg_latency_reset () {
+  // TMSCM_DEFER_INTS;
+  latency_reset ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_latency_count (tmscm arg1) {
+  TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "latency-count");
+
+  string in1= tmscm_to_string (arg1);
+
+  // TMSCM_DEFER_INTS;
+  int out= latency_count (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return int_to_tmscm (out);
+}
+
+tmscm
+tmg_latency_percentile (tmscm arg1, tmscm arg2) {
+  TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "latency-percentile");
+  TMSCM_ASSERT_DOUBLE (arg2, TMSCM_ARG2, "latency-percentile");
+
+  string in1= tmscm_to_string (arg1);
+  double in2= tmscm_to_double (arg2);
+
+  // TMSCM_DEFER_INTS;
+  double out= latency_percentile (in1, in2);
+  // TMSCM_ALLOW_INTS;
+
+  return double_to_tmscm (out);
+}
+
+tmscm
+tmg_latency_histogram (tmscm arg1) {
+  TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "latency-histogram");
+
+  string in1= tmscm_to_string (arg1);
+
+  // TMSCM_DEFER_INTS;
+  array_int out= latency_histogram (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return array_int_to_tmscm (out);
+}
+
+tmscm
+tmg_latency_bucket_limits () {
+  // TMSCM_DEFER_INTS;
+  array_int out= latency_bucket_limits ();
+  // TMSCM_ALLOW_INTS;
+
+  return array_int_to_tmscm (out);
+}
+
+tmscm
+tmg_latency_report () {
+  // TMSCM_DEFER_INTS;
+  string out= latency_report ();
+  // TMSCM_ALLOW_INTS;
+
+  return string_to_tmscm (out);
+}
+
+tmscm
+tmg_latency_record_start (tmscm arg1) {
+  TMSCM_ASSERT_URL (arg1, TMSCM_ARG1, "latency-record-start");
+
+  url in1= tmscm_to_url (arg1);
+
+  // TMSCM_DEFER_INTS;
+  latency_record_start (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_latency_record_stop () {
+  // TMSCM_DEFER_INTS;
+  latency_record_stop ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
 tmscm
 tmg_system_wait (tmscm arg1, tmscm arg2) {
   TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "system-wait");
@@ -9275,6 +9445,43 @@ tmg_buffer_export (tmscm arg1, tmscm arg2, tmscm arg3) {
   return bool_to_tmscm (out);
 }
 
+tmscm
+tmg_buffer_autosave (tmscm arg1, tmscm arg2) {
+  TMSCM_ASSERT_URL (arg1, TMSCM_ARG1, "buffer-autosave");
+  TMSCM_ASSERT_URL (arg2, TMSCM_ARG2, "buffer-autosave");
+
+  url in1= tmscm_to_url (arg1);
+  url in2= tmscm_to_url (arg2);
+
+  // TMSCM_DEFER_INTS;
+  bool out= buffer_autosave (in1, in2);
+  // TMSCM_ALLOW_INTS;
+
+  return bool_to_tmscm (out);
+}
+
+tmscm
+tmg_background_save_status (tmscm arg1) {
+  TMSCM_ASSERT_URL (arg1, TMSCM_ARG1, "background-save-status");
+
+  url in1= tmscm_to_url (arg1);
+
+  // TMSCM_DEFER_INTS;
+  int out= background_save_status (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return int_to_tmscm (out);
+}
+
+tmscm
+tmg_background_save_wait () {
+  // TMSCM_DEFER_INTS;
+  background_save_wait ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
 tmscm
 tmg_buffer_save (tmscm arg1) {
   TMSCM_ASSERT_URL (arg1, TMSCM_ARG1, "buffer-save");
@@ -10322,6 +10529,22 @@ initialize_glue_basic () {
   tmscm_install_procedure ("texmacs-memory",  tmg_texmacs_memory, 0, 0, 0);
   tmscm_install_procedure ("bench-print",  tmg_bench_print, 1, 0, 0);
   tmscm_install_procedure ("bench-print-all",  tmg_bench_print_all, 0, 0, 0);
+  tmscm_install_procedure ("bench-time",  tmg_bench_time, 0, 0, 0);
+  tmscm_install_procedure ("bench-reset",  tmg_bench_reset, 1, 0, 0);
+  tmscm_install_procedure ("bench-reset-all",  tmg_bench_reset_all, 0, 0, 0);
+  tmscm_install_procedure ("trace-start",  tmg_trace_start, 0, 0, 0);
+  tmscm_install_procedure ("trace-stop",  tmg_trace_stop, 0, 0, 0);
+  tmscm_install_procedure ("trace-busy?",  tmg_trace_busyP, 0, 0, 0);
+  tmscm_install_procedure ("trace-export",  tmg_trace_export, 1, 0, 0);
+  tmscm_install_procedure ("trace-summary",  tmg_trace_summary, 0, 0, 0);
+  tmscm_install_procedure ("latency-reset",  tmg_latency_reset, 0, 0, 0);
+  tmscm_install_procedure ("latency-count",  tmg_latency_count, 1, 0, 0);
+  tmscm_install_procedure ("latency-percentile",  tmg_latency_percentile, 2, 0, 0);
+  tmscm_install_procedure ("latency-histogram",  tmg_latency_histogram, 1, 0, 0);
+  tmscm_install_procedure ("latency-bucket-limits",  tmg_latency_bucket_limits, 0, 0, 0);
+  tmscm_install_procedure ("latency-report",  tmg_latency_report, 0, 0, 0);
+  tmscm_install_procedure ("latency-record-start",  tmg_latency_record_start, 1, 0, 0);
+  tmscm_install_procedure ("latency-record-stop",  tmg_latency_record_stop, 0, 0, 0);
   tmscm_install_procedure ("system-wait",  tmg_system_wait, 2, 0, 0);
   tmscm_install_procedure ("get-show-kbd",  tmg_get_show_kbd, 0, 0, 0);
   tmscm_install_procedure ("set-show-kbd",  tmg_set_show_kbd, 1, 0, 0);
@@ -10944,6 +11167,9 @@ initialize_glue_basic () {
   tmscm_install_procedure ("buffer-import",  tmg_buffer_import, 3, 0, 0);
   tmscm_install_procedure ("buffer-load",  tmg_buffer_load, 1, 0, 0);
   tmscm_install_procedure ("buffer-export",  tmg_buffer_export, 3, 0, 0);
+  tmscm_install_procedure ("buffer-autosave",  tmg_buffer_autosave, 2, 0, 0);
+  tmscm_install_procedure ("background-save-status",  tmg_background_save_status, 1, 0, 0);
+  tmscm_install_procedure ("background-save-wait",  tmg_background_save_wait, 0, 0, 0);
   tmscm_install_procedure ("buffer-save",  tmg_buffer_save, 1, 0, 0);
   tmscm_install_procedure ("tree-import-loaded",  tmg_tree_import_loaded, 3, 0, 0);
   tmscm_install_procedure ("tree-import",  tmg_tree_import, 2, 0, 0);
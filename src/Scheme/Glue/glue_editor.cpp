@@ -1748,6 +1748,19 @@ tmg_key_press (tmscm arg1) {
   return TMSCM_UNSPECIFIED;
 }
 
+tmscm
+tmg_replay_key_press (tmscm arg1) {
+  TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "replay-key-press");
+
+  string in1= tmscm_to_string (arg1);
+
+  // TMSCM_DEFER_INTS;
+  get_current_editor()->replay_key_press (in1);
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
 tmscm
 tmg_raw_emulate_keyboard (tmscm arg1) {
   TMSCM_ASSERT_STRING (arg1, TMSCM_ARG1, "raw-emulate-keyboard");
@@ -3330,6 +3343,41 @@ tmg_print_snippet (tmscm arg1, tmscm arg2, tmscm arg3) {
   return array_int_to_tmscm (out);
 }
 
+tmscm
+tmg_print_snippets (tmscm arg1, tmscm arg2, tmscm arg3) {
+  TMSCM_ASSERT_ARRAY_URL (arg1, TMSCM_ARG1, "print-snippets");
+  TMSCM_ASSERT_ARRAY_TREE (arg2, TMSCM_ARG2, "print-snippets");
+  TMSCM_ASSERT_BOOL (arg3, TMSCM_ARG3, "print-snippets");
+
+  array_url in1= tmscm_to_array_url (arg1);
+  array_tree in2= tmscm_to_array_tree (arg2);
+  bool in3= tmscm_to_bool (arg3);
+
+  // TMSCM_DEFER_INTS;
+  array_int out= get_current_editor()->print_snippets (in1, in2, in3);
+  // TMSCM_ALLOW_INTS;
+
+  return array_int_to_tmscm (out);
+}
+
+tmscm
+tmg_begin_snippets () {
+  // TMSCM_DEFER_INTS;
+  get_current_editor()->begin_snippets ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
+tmscm
+tmg_end_snippets () {
+  // TMSCM_DEFER_INTS;
+  get_current_editor()->end_snippets ();
+  // TMSCM_ALLOW_INTS;
+
+  return TMSCM_UNSPECIFIED;
+}
+
 tmscm
 tmg_graphics_file_to_clipboard (tmscm arg1) {
   TMSCM_ASSERT_URL (arg1, TMSCM_ARG1, "graphics-file-to-clipboard");
@@ -3759,6 +3807,7 @@ initialize_glue_editor () {
   tmscm_install_procedure ("cell-del-format",  tmg_cell_del_format, 1, 0, 0);
   tmscm_install_procedure ("table-test",  tmg_table_test, 0, 0, 0);
   tmscm_install_procedure ("key-press",  tmg_key_press, 1, 0, 0);
+  tmscm_install_procedure ("replay-key-press",  tmg_replay_key_press, 1, 0, 0);
   tmscm_install_procedure ("raw-emulate-keyboard",  tmg_raw_emulate_keyboard, 1, 0, 0);
   tmscm_install_procedure ("complete-try?",  tmg_complete_tryP, 0, 0, 0);
   tmscm_install_procedure ("get-input-mode",  tmg_get_input_mode, 0, 0, 0);
@@ -3903,6 +3952,9 @@ initialize_glue_editor () {
   tmscm_install_procedure ("print",  tmg_print, 0, 0, 0);
   tmscm_install_procedure ("print-pages",  tmg_print_pages, 2, 0, 0);
   tmscm_install_procedure ("print-snippet",  tmg_print_snippet, 3, 0, 0);
+  tmscm_install_procedure ("print-snippets",  tmg_print_snippets, 3, 0, 0);
+  tmscm_install_procedure ("begin-snippets",  tmg_begin_snippets, 0, 0, 0);
+  tmscm_install_procedure ("end-snippets",  tmg_end_snippets, 0, 0, 0);
   tmscm_install_procedure ("graphics-file-to-clipboard",  tmg_graphics_file_to_clipboard, 1, 0, 0);
   tmscm_install_procedure ("export-postscript",  tmg_export_postscript, 1, 0, 0);
   tmscm_install_procedure ("export-pages-postscript",  tmg_export_pages_postscript, 3, 0, 0);
@@ -19,6 +19,7 @@
 #include "guile_tm.hpp"
 #include "blackbox.hpp"
 #include "file.hpp"
+#include "tm_trace.hpp"
 #include "../Scheme/glue.hpp"
 #include "convert.hpp" // tree_to_texmacs (should not belong here)
 
@@ -99,6 +100,7 @@ TeXmacs_lazy_eval_file (char *file) {
 
 static SCM
 TeXmacs_eval_file (char *file) {
+  TRACE_SCOPE ("scheme", "eval file");
 #ifndef DEBUG_ON
   return scm_internal_catch (SCM_BOOL_T,
                              (scm_t_catch_body) TeXmacs_lazy_eval_file, file,
@@ -141,6 +143,7 @@ TeXmacs_lazy_eval_string (char *s) {
 
 static SCM
 TeXmacs_eval_string (char *s) {
+  TRACE_SCOPE ("scheme", "eval string");
 #ifndef DEBUG_ON
   return scm_internal_catch (SCM_BOOL_T,
                              (scm_t_catch_body) TeXmacs_lazy_eval_string, s,
@@ -206,6 +209,7 @@ TeXmacs_lazy_call_scm (arg_list* args) {
 
 static SCM
 TeXmacs_call_scm (arg_list *args) {
+  TRACE_SCOPE ("scheme", "call scheme");
 #ifndef DEBUG_ON
   return scm_internal_catch (SCM_BOOL_T,
                              (scm_t_catch_body) TeXmacs_lazy_call_scm, (void*) args,
@@ -1196,6 +1196,7 @@ tmscm_to_list_tree (tmscm p) {
 #include "Concat/concater.hpp"
 #include "converter.hpp"
 #include "tm_timer.hpp"
+#include "tm_latency.hpp"
 #include "Metafont/tex_files.hpp"
 #include "Freetype/tt_file.hpp"
 #include "LaTeX_Preview/latex_preview.hpp"
@@ -12,6 +12,7 @@
 #include "tinyscheme_tm.hpp"
 #include "object.hpp"
 #include "glue.hpp"
+#include "tm_trace.hpp"
 
 
 
@@ -160,6 +161,7 @@ eval_scheme_file (string file) {
 	//static int cumul= 0;
 	//timer tm;
 	if (DEBUG_STD) debug_std << "Evaluating " << file << "...\n";
+	TRACE_SCOPE ("scheme", "eval file");
 	c_string _file (file);
 	FILE *f = fopen(_file, "r");
 	scm result= scm_eval_file (f);
@@ -190,6 +192,7 @@ TeXmacs_eval_string (char *s) {
 scm
 eval_scheme (string s) {
 	// cout << "Eval] " << s << "\n";
+	TRACE_SCOPE ("scheme", "eval string");
 	c_string _s (s);
 	scm result= scm_eval_string (_s);
 	return result;
@@ -203,6 +206,7 @@ struct arg_list { int  n; scm* a; };
 
 scm
 TeXmacs_call_scm (arg_list* args) {
+	TRACE_SCOPE ("scheme", "call scheme");
 	switch (args->n) {
 		default:
 		{
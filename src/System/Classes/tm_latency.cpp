@@ -0,0 +1,208 @@
+
+/******************************************************************************
+* MODULE     : tm_latency.cpp
+* DESCRIPTION: histograms of the latency between key presses and repaints
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "tm_latency.hpp"
+#include "tm_trace.hpp"
+#include "file.hpp"
+#include <stdio.h>
+
+/******************************************************************************
+* Histograms
+*******************************************************************************
+* Latencies are stored in microseconds.  The first 8 buckets hold the
+* latencies 0, ..., 7; next, each octave [2^e, 2^(e+1)) is divided into
+* 8 buckets of equal width.  The last bucket also holds all latencies
+* beyond its range, of more than 17 minutes.
+******************************************************************************/
+
+struct latency_histogram_rep {
+  DI count;
+  DI sum;
+  DI max;
+  int bucket[LATENCY_BUCKETS];
+};
+
+static latency_histogram_rep latency_hist[LATENCY_PHASES];
+static const char* latency_names[LATENCY_PHASES]=
+  { "modify", "typeset", "repaint" };
+
+int
+latency_bucket (DI us) {
+  if (us < 8) return (int) max (us, (DI) 0);
+  int e= 3;
+  while (e < 62 && (us >> (e+1)) != 0) e++;
+  int i= 8 + ((e-3) << 3) + ((int) (us >> (e-3)) - 8);
+  return min (i, LATENCY_BUCKETS - 1);
+}
+
+DI
+latency_bucket_limit (int i) {
+  // smallest latency beyond bucket i
+  if (i < 8) return (DI) (i+1);
+  int e= 3 + ((i-8) >> 3);
+  return ((DI) (9 + ((i-8) & 7))) << (e-3);
+}
+
+static DI
+latency_bucket_start (int i) {
+  return i == 0? (DI) 0: latency_bucket_limit (i-1);
+}
+
+static void
+latency_add (int phase, DI ns) {
+  latency_histogram_rep& h= latency_hist[phase];
+  DI us= ns / 1000;
+  h.count++;
+  h.sum += us;
+  h.max= max (h.max, us);
+  h.bucket[latency_bucket (us)]++;
+}
+
+static double
+latency_quantile (int phase, double q) {
+  // percentile in milliseconds, at the middle of the relevant bucket
+  latency_histogram_rep& h= latency_hist[phase];
+  if (h.count == 0) return 0.0;
+  DI rank= (DI) (q * h.count + 0.999999);
+  rank= max (min (rank, h.count), (DI) 1);
+  DI cumul= 0;
+  for (int i=0; i<LATENCY_BUCKETS; i++) {
+    cumul += h.bucket[i];
+    if (cumul >= rank) {
+      DI lo= latency_bucket_start (i), hi= latency_bucket_limit (i);
+      double mid= 0.5 * ((double) (lo + hi));
+      return min (mid, (double) h.max) / 1000.0;
+    }
+  }
+  return h.max / 1000.0;
+}
+
+/******************************************************************************
+* Following the pending key press
+******************************************************************************/
+
+static DI     pending_start= -1;   // reception of the oldest pending key
+static int    pending_phase= -1;   // last phase reached by this key
+static DI     record_last= 0;
+static string record_file;
+static string record_keys;
+
+void
+latency_key (string key) {
+  DI now= trace_clock ();
+  if (pending_start < 0) {
+    pending_start= now;
+    pending_phase= -1;
+  }
+  if (record_file != "") {
+    DI delay= record_keys == ""? (DI) 0: (now - record_last) / 1000000;
+    record_keys << as_string (delay) << " " << key << "\n";
+    record_last= now;
+  }
+}
+
+void
+latency_mark (int phase) {
+  if (pending_start < 0 || phase <= pending_phase) return;
+  latency_add (phase, trace_clock () - pending_start);
+  pending_phase= phase;
+  if (phase == LATENCY_REPAINT) pending_start= -1;
+}
+
+void
+latency_reset () {
+  for (int i=0; i<LATENCY_PHASES; i++) {
+    latency_histogram_rep& h= latency_hist[i];
+    h.count= h.sum= h.max= 0;
+    for (int j=0; j<LATENCY_BUCKETS; j++) h.bucket[j]= 0;
+  }
+  pending_start= -1;
+  pending_phase= -1;
+}
+
+/******************************************************************************
+* Reporting
+******************************************************************************/
+
+int
+latency_phase (string name) {
+  for (int i=0; i<LATENCY_PHASES; i++)
+    if (name == latency_names[i]) return i;
+  return -1;
+}
+
+int
+latency_count (string phase) {
+  int i= latency_phase (phase);
+  return i < 0? 0: (int) latency_hist[i].count;
+}
+
+double
+latency_percentile (string phase, double q) {
+  int i= latency_phase (phase);
+  return i < 0? 0.0: latency_quantile (i, q);
+}
+
+array<int>
+latency_histogram (string phase) {
+  int i= latency_phase (phase);
+  array<int> r (LATENCY_BUCKETS);
+  for (int j=0; j<LATENCY_BUCKETS; j++)
+    r[j]= i < 0? 0: latency_hist[i].bucket[j];
+  return r;
+}
+
+array<int>
+latency_bucket_limits () {
+  array<int> r (LATENCY_BUCKETS);
+  for (int j=0; j<LATENCY_BUCKETS; j++)
+    r[j]= (int) latency_bucket_limit (j);
+  return r;
+}
+
+string
+latency_report () {
+  // one line for each phase, with the latencies in milliseconds
+  string r= "phase      count     mean      p50      p90      p99      max\n";
+  char buf[256];
+  for (int i=0; i<LATENCY_PHASES; i++) {
+    latency_histogram_rep& h= latency_hist[i];
+    double mean= h.count == 0? 0.0: h.sum / (1000.0 * h.count);
+    snprintf (buf, 256, "%-8s %7lld %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+              latency_names[i], (long long) h.count, mean,
+              latency_quantile (i, 0.50), latency_quantile (i, 0.90),
+              latency_quantile (i, 0.99), h.max / 1000.0);
+    r << buf;
+  }
+  return r;
+}
+
+/******************************************************************************
+* Recording key scripts
+*******************************************************************************
+* Each line of a key script consists of the delay in milliseconds since
+* the previous key, followed by the key in the TeXmacs notation.
+******************************************************************************/
+
+void
+latency_record_start (url u) {
+  record_file= as_string (u);
+  record_keys= "";
+}
+
+void
+latency_record_stop () {
+  if (record_file == "") return;
+  if (save_string (url_system (record_file), record_keys))
+    std_warning << "Could not save keys to " << record_file << "\n";
+  record_file= "";
+  record_keys= "";
+}
@@ -0,0 +1,59 @@
+
+/******************************************************************************
+* MODULE     : tm_latency.hpp
+* DESCRIPTION: histograms of the latency between key presses and repaints
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef TM_LATENCY_H
+#define TM_LATENCY_H
+#include "array.hpp"
+
+class url;
+
+/******************************************************************************
+* Phases of the handling of a key press
+*******************************************************************************
+* For each key press, we measure the time from its reception until
+* the key has been handled (and the document modified), until the
+* document has been typeset and until the window has been repainted.
+* Each of these latencies is accounted in a histogram with 8 buckets
+* per octave, so that percentiles are accurate to about 6%.  When a key
+* arrives before the previous one has been repainted, both are merged
+* and the latency is measured from the oldest one.  Keys which do not
+* change the document have no typesetting phase.
+******************************************************************************/
+
+#define LATENCY_MODIFY   0
+#define LATENCY_TYPESET  1
+#define LATENCY_REPAINT  2
+#define LATENCY_PHASES   3
+
+#define LATENCY_BUCKETS  224
+
+void   latency_key (string key);
+void   latency_mark (int phase);
+void   latency_reset ();
+
+int    latency_phase (string name);
+int    latency_count (string phase);
+double latency_percentile (string phase, double q);
+array<int> latency_histogram (string phase);
+array<int> latency_bucket_limits ();
+string latency_report ();
+
+int    latency_bucket (DI us);
+DI     latency_bucket_limit (int i);
+
+/******************************************************************************
+* Recording key scripts for the replay harness
+******************************************************************************/
+
+void   latency_record_start (url u);
+void   latency_record_stop ();
+
+#endif // defined TM_LATENCY_H
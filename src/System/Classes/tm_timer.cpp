@@ -10,14 +10,8 @@
 ******************************************************************************/
 
 #include "tm_timer.hpp"
-#include "iterator.hpp"
 #include "merge_sort.hpp"
 
-static hashmap<string,int> timing_level (0);
-static hashmap<string,int> timing_nr    (0);
-static hashmap<string,int> timing_cumul (0);
-static hashmap<string,int> timing_last  (0);
-
 /******************************************************************************
 * Getting the time
 ******************************************************************************/
@@ -52,71 +46,61 @@ texmacs_time () {
 
 /******************************************************************************
 * Routines for benchmarking
+*******************************************************************************
+* The timing of a task is the cumulated duration of the outermost spans
+* of the trace points with the name of the task (see tm_trace.hpp).
 ******************************************************************************/
 
-void
-bench_start (string task) {
-  // start timer for a given type of task
-  if (timing_level [task] == 0)
-    timing_last (task)= (int) texmacs_time ();
-  timing_level (task) ++;
+double
+bench_time () {
+  // time in milliseconds, more accurate than texmacs_time
+  return trace_clock () / 1000000.0;
 }
 
 void
-bench_cumul (string task) {
-  // end timer for a given type of task, but don't reset timer
-  timing_level (task) --;
-  if (timing_level [task] == 0) {
-    int ms= ((int) texmacs_time ()) - timing_last (task);
-    timing_nr    (task) ++;
-    timing_cumul (task) += ms;
-    timing_last -> reset (task);
-  }
-}
-
-void
-bench_end (string task) {
-  // end timer for a given type of task, print result and reset timer
-  bench_cumul (task);
-  bench_print (task);
-  bench_reset (task);
+bench_reset (string task) {
+  // reset timer for a given type of task
+  for (trace_point* p= trace_points (); p != NULL; p= p->next)
+    if (task == p->name) {
+      p->count.store (0);
+      p->total.store (0);
+    }
 }
 
 void
-bench_reset (string task) {
-  // reset timer for a given type of task
-  timing_level->reset (task);
-  timing_nr   ->reset (task);
-  timing_cumul->reset (task);
-  timing_last ->reset (task);
+bench_reset () {
+  // reset timers for all types of tasks
+  for (trace_point* p= trace_points (); p != NULL; p= p->next) {
+    p->count.store (0);
+    p->total.store (0);
+  }
 }
 
 void
 bench_print (string task) {
   // print timing for a given type of task
   if (DEBUG_BENCH) {
-    int nr= timing_nr [task];
+    DI nr= 0, ns= 0;
+    for (trace_point* p= trace_points (); p != NULL; p= p->next)
+      if (task == p->name) {
+        nr += p->count.load ();
+        ns += p->total.load ();
+      }
     std_bench << "Task '" << task << "' took "
-              << timing_cumul [task] << " ms";
+              << (ns / 1000000) << " ms";
     if (nr > 1) std_bench << " (" << nr << " invocations)";
     std_bench << "\n";
   }
 }
 
-static array<string>
-collect (hashmap<string,int> h) {
-  array<string> a;
-  iterator<string> it= iterate (h);
-  while (it->busy ())
-    a << it->next ();
-  merge_sort (a);
-  return a;
-}
-
 void
 bench_print () {
   // print timings for all types of tasks
-  array<string> a= collect (timing_cumul);
+  array<string> a;
+  for (trace_point* p= trace_points (); p != NULL; p= p->next)
+    if (p->count.load () > 0 && !contains (string (p->name), a))
+      a << string (p->name);
+  merge_sort (a);
   int i, n= N(a);
   for (i=0; i<n; i++)
     bench_print (a[i]);
@@ -12,6 +12,7 @@
 #ifndef TIMER_H
 #define TIMER_H
 #include "string.hpp"
+#include "tm_trace.hpp"
 #include "tm_configure.hpp"
 
 #ifndef __FreeBSD__
@@ -41,10 +42,9 @@ extern "C" {
 time_t raw_time ();
 time_t texmacs_time ();
 
-void   bench_start (string task);
-void   bench_cumul (string task);
-void   bench_end   (string task);
+double bench_time ();
 void   bench_reset (string task);
+void   bench_reset ();
 void   bench_print (string task);
 void   bench_print ();
 
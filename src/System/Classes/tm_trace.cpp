@@ -0,0 +1,303 @@
+
+/******************************************************************************
+* MODULE     : tm_trace.cpp
+* DESCRIPTION: hierarchical tracing of the time spent in parts of TeXmacs
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "tm_trace.hpp"
+#include "file.hpp"
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef OS_MINGW
+#include <pthread.h>
+#endif
+
+#define TRACE_BUFFER 65536  // number of events kept for each thread
+#define TRACE_DEPTH  64     // maximal nesting of spans which is tracked
+
+/******************************************************************************
+* Global and per thread state
+*******************************************************************************
+* Spans may be opened on worker threads.  The per thread state is therefore
+* made of plain C data, allocated with malloc, since the fast allocator
+* may also serve operator new and is not thread-safe.  The list of trace
+* points and the list of event buffers are only modified under a lock;
+* each event buffer is written by a single thread at a time.
+******************************************************************************/
+
+struct trace_event {
+  trace_point* p;
+  DI start;     // in ns, for the monotonic clock
+  DI end;
+  DI arg;       // number attached by TRACE_ARG or -1
+};
+
+struct trace_buffer {
+  int             tid;   // number of the buffer, for the exported events
+  bool            main;  // used by the thread which started tracing?
+  bool            busy;  // currently owned by a running thread?
+  std::atomic<DI> head;  // number of events recorded so far
+  trace_event*    ev;    // the last TRACE_BUFFER events
+  trace_buffer*   next;
+};
+
+struct trace_thread {
+  trace_buffer* buf;
+  int           depth;
+  trace_point*  open[TRACE_DEPTH];
+  ~trace_thread ();
+};
+
+static std::atomic<bool> trace_on (false);
+static trace_point*  all_points = NULL;
+static trace_buffer* all_buffers= NULL;
+static int           nr_buffers = 0;
+static DI            trace_origin= 0;
+static string        trace_file;
+static thread_local trace_thread this_thread;
+
+#ifndef OS_MINGW
+static pthread_mutex_t trace_mutex= PTHREAD_MUTEX_INITIALIZER;
+static inline void trace_lock () { pthread_mutex_lock (&trace_mutex); }
+static inline void trace_unlock () { pthread_mutex_unlock (&trace_mutex); }
+#else
+static inline void trace_lock () {}
+static inline void trace_unlock () {}
+#endif
+
+trace_thread::~trace_thread () {
+  // let a later thread reuse the buffer
+  if (buf == NULL) return;
+  trace_lock ();
+  buf->busy= false;
+  trace_unlock ();
+}
+
+static trace_buffer*
+trace_acquire (bool main) {
+  trace_lock ();
+  trace_buffer* buf= all_buffers;
+  while (buf != NULL && buf->busy) buf= buf->next;
+  if (buf == NULL) {
+    buf= (trace_buffer*) malloc (sizeof (trace_buffer));
+    trace_event* ev= (trace_event*) malloc (TRACE_BUFFER * sizeof (trace_event));
+    if (buf == NULL || ev == NULL) {
+      free (buf); free (ev);
+      trace_unlock ();
+      return NULL;
+    }
+    (void) new ((void*) buf) trace_buffer ();
+    buf->tid = ++nr_buffers;
+    buf->main= main;
+    buf->head.store (0);
+    buf->ev  = ev;
+    buf->next= all_buffers;
+    all_buffers= buf;
+  }
+  buf->busy= true;
+  trace_unlock ();
+  return buf;
+}
+
+static void
+trace_register (trace_point* p) {
+  trace_lock ();
+  if (!p->known.load (std::memory_order_relaxed)) {
+    p->next= all_points;
+    all_points= p;
+    p->known.store (true, std::memory_order_release);
+  }
+  trace_unlock ();
+}
+
+trace_point*
+trace_points () {
+  trace_lock ();
+  trace_point* p= all_points;
+  trace_unlock ();
+  return p;
+}
+
+/******************************************************************************
+* Opening and closing spans
+******************************************************************************/
+
+DI
+trace_clock () {
+  using namespace std::chrono;
+  return (DI) duration_cast<nanoseconds>
+    (steady_clock::now ().time_since_epoch ()).count ();
+}
+
+void
+trace_enter (trace_point* p) {
+  trace_thread& th= this_thread;
+  if (th.depth < TRACE_DEPTH) th.open[th.depth]= p;
+  th.depth++;
+}
+
+void
+trace_leave (trace_point* p, DI start, DI arg) {
+  DI end= trace_clock ();
+  trace_thread& th= this_thread;
+  th.depth--;
+  bool outer= true;
+  int i, n= min (th.depth, TRACE_DEPTH);
+  for (i=0; i<n; i++)
+    if (th.open[i] == p) { outer= false; break; }
+  if (outer) {
+    p->count.fetch_add (1, std::memory_order_relaxed);
+    p->total.fetch_add (end - start, std::memory_order_relaxed);
+  }
+  if (!p->known.load (std::memory_order_acquire)) trace_register (p);
+
+  if (!trace_on.load (std::memory_order_relaxed)) return;
+  if (th.buf == NULL) th.buf= trace_acquire (false);
+  trace_buffer* buf= th.buf;
+  if (buf == NULL) return;
+  DI h= buf->head.load (std::memory_order_relaxed);
+  trace_event& ev= buf->ev[h % TRACE_BUFFER];
+  ev.p    = p;
+  ev.start= start;
+  ev.end  = end;
+  ev.arg  = arg;
+  buf->head.store (h + 1, std::memory_order_release);
+}
+
+/******************************************************************************
+* Switching tracing on and off
+******************************************************************************/
+
+void
+trace_start () {
+  if (trace_on.load ()) return;
+  if (trace_origin == 0) {
+    trace_origin= trace_clock ();
+    if (this_thread.buf == NULL) this_thread.buf= trace_acquire (true);
+  }
+  trace_on.store (true);
+}
+
+void
+trace_start (url u) {
+  // trace until TeXmacs quits and then export the events to u
+  trace_file= as_string (u);
+  trace_start ();
+}
+
+void
+trace_stop () {
+  trace_on.store (false);
+}
+
+bool
+trace_busy () {
+  return trace_on.load ();
+}
+
+void
+trace_finish () {
+  if (trace_file == "") return;
+  trace_stop ();
+  if (trace_export (url_system (trace_file)))
+    std_warning << "Could not write trace to " << trace_file << "\n";
+  trace_file= "";
+}
+
+/******************************************************************************
+* Exporting the events in the Chrome trace event format
+******************************************************************************/
+
+static void
+trace_quote (string& r, const char* s) {
+  r << '\"';
+  for (; *s != '\0'; s++) {
+    if (*s == '\"' || *s == '\\') r << '\\';
+    r << *s;
+  }
+  r << '\"';
+}
+
+string
+trace_events () {
+  // events which are recorded during the export may be garbled,
+  // so recording is suspended meanwhile
+  bool on= trace_on.exchange (false);
+  string r= "{\"traceEvents\":[";
+  bool first= true;
+  char buf[256];
+  trace_lock ();
+  for (trace_buffer* b= all_buffers; b != NULL; b= b->next) {
+    snprintf (buf, 256, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+              "\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+              first? "": ",", b->tid);
+    r << buf;
+    snprintf (buf, 256, b->main? "main": "worker %d", b->tid);
+    trace_quote (r, buf);
+    r << "}}";
+    first= false;
+    DI h= b->head.load (std::memory_order_acquire);
+    for (DI i= max (h - TRACE_BUFFER, (DI) 0); i<h; i++) {
+      trace_event& ev= b->ev[i % TRACE_BUFFER];
+      r << ",\n{\"name\":";
+      trace_quote (r, ev.p->name);
+      r << ",\"cat\":";
+      trace_quote (r, ev.p->category);
+      snprintf (buf, 256, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                "\"pid\":1,\"tid\":%d",
+                (ev.start - trace_origin) / 1000.0,
+                (ev.end - ev.start) / 1000.0, b->tid);
+      r << buf;
+      if (ev.arg >= 0) r << ",\"args\":{\"value\":" << as_string (ev.arg) << "}";
+      r << "}";
+    }
+  }
+  trace_unlock ();
+  r << "\n],\"displayTimeUnit\":\"ns\"}\n";
+  trace_on.store (on);
+  return r;
+}
+
+bool
+trace_export (url u) {
+  return save_string (u, trace_events ());
+}
+
+/******************************************************************************
+* Summary of the trace points for the benchmark suite
+*******************************************************************************
+* One entry for each trace point which has been used, with the mean
+* duration of its outermost spans in milliseconds, in the same format
+* as the results of the other benchmarks (see misc/benchmark).
+******************************************************************************/
+
+string
+trace_summary () {
+  string r= "[";
+  bool first= true;
+  char buf[256];
+  for (trace_point* p= trace_points (); p != NULL; p= p->next) {
+    DI nr= p->count.load (), ns= p->total.load ();
+    if (nr == 0) continue;
+    r << (first? "\n": ",\n") << "{\"group\":";
+    snprintf (buf, 256, "trace/%s", p->category);
+    trace_quote (r, buf);
+    r << ",\"name\":";
+    trace_quote (r, p->name);
+    snprintf (buf, 256, ",\"metric\":\"WalltimeMilliseconds\","
+              "\"value\":%.6f,\"iterations\":%lld}",
+              ns / (1000000.0 * nr), (long long) nr);
+    r << buf;
+    first= false;
+  }
+  r << "\n]\n";
+  return r;
+}
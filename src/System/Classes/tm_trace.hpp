@@ -0,0 +1,80 @@
+
+/******************************************************************************
+* MODULE     : tm_trace.hpp
+* DESCRIPTION: hierarchical tracing of the time spent in parts of TeXmacs
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef TM_TRACE_H
+#define TM_TRACE_H
+#include "string.hpp"
+#include <atomic>
+
+class url;
+
+/******************************************************************************
+* Trace points
+*******************************************************************************
+* A trace point is a static object for a place in the source code whose
+* running time we want to measure.  Each run opens a span on the trace
+* point, which is closed when the enclosing scope is left.  Spans nest,
+* also across different trace points.  The number of outermost spans of
+* a trace point and their cumulated duration are always accounted; they
+* are reported by bench_print.  While tracing is switched on, every span
+* is also recorded as an event in a ring buffer of the current thread;
+* these events can be exported in the Chrome trace event format, which
+* can be viewed with chrome://tracing or ui.perfetto.dev.
+******************************************************************************/
+
+struct trace_point {
+  const char*      category;
+  const char*      name;
+  std::atomic<DI>  count;    // number of outermost spans
+  std::atomic<DI>  total;    // cumulated duration of these spans in ns
+  std::atomic<bool> known;   // inserted in the list of all trace points?
+  trace_point*     next;     // next trace point in this list
+  constexpr trace_point (const char* c, const char* n):
+    category (c), name (n), count (0), total (0), known (false), next (NULL) {}
+};
+
+DI   trace_clock ();
+void trace_enter (trace_point* p);
+void trace_leave (trace_point* p, DI start, DI arg);
+
+class trace_span {
+  trace_point* p;
+  DI start;
+  DI arg;
+public:
+  inline trace_span (trace_point* p2):
+    p (p2), start (trace_clock ()), arg (-1) { trace_enter (p); }
+  inline ~trace_span () { trace_leave (p, start, arg); }
+  inline void set_arg (DI a) { arg= a; }
+};
+
+// At most one TRACE_SCOPE per block; TRACE_ARG attaches a number to the
+// event of the innermost TRACE_SCOPE, such as a size or a count.
+#define TRACE_SCOPE(category,name) \
+  static trace_point trace_point_here (category, name); \
+  trace_span trace_span_here (&trace_point_here)
+#define TRACE_ARG(x) trace_span_here.set_arg ((DI) (x))
+
+/******************************************************************************
+* Recording and exporting traces
+******************************************************************************/
+
+void   trace_start ();
+void   trace_start (url u);
+void   trace_stop ();
+bool   trace_busy ();
+string trace_events ();
+string trace_summary ();
+bool   trace_export (url u);
+void   trace_finish ();
+trace_point* trace_points ();
+
+#endif // defined TM_TRACE_H
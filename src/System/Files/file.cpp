@@ -30,6 +30,14 @@
 #include <sys/types.h>
 #include <string.h>  // strerror
 #include <dirent.h>
+#include <fcntl.h>
+#include <deque>
+#include <map>
+#include <string>
+
+#ifndef OS_MINGW
+#include <pthread.h>
+#endif
 
 #ifdef MACOSX_EXTENSIONS
 #include "MacOS/mac_images.h"
@@ -71,7 +79,7 @@ load_string (url u, string& s, bool fatal) {
     }
     // End caching
 
-    bench_start ("load file");
+    TRACE_SCOPE ("io", "load file");
 
     FILE* fin= texmacs_fopen (name, "r");
 
@@ -90,6 +98,8 @@ load_string (url u, string& s, bool fatal) {
       }
     }
     if (!err) {
+      TRACE_ARG (size);
+      s->reserve (size);
       s->resize (size);
       ssize_t readed= texmacs_fread (&(s[0]), size, fin);
       texmacs_fclose (fin);
@@ -98,8 +108,6 @@ load_string (url u, string& s, bool fatal) {
         std_warning << "Can't read " << name << "\n";
       }
     }
-    bench_cumul ("load file");
-
     // Cache file contents
     if (!err && (N(s) <= 10000 || currently_cached))
       if (file_flag || doc_flag)
@@ -119,6 +127,8 @@ load_string (url u, string& s, bool fatal) {
 
 bool
 save_string (url u, string s, bool fatal) {
+  TRACE_SCOPE ("io", "save file");
+  TRACE_ARG (N(s));
   if (is_rooted_tmfs (u)) {
     bool err= save_to_server (u, s);
     if (err && fatal) {
@@ -141,7 +151,7 @@ save_string (url u, string s, bool fatal) {
                     << strerror(errno) << "\n";
       }
       if (!err) {
-        int n= N(s);
+        DI n= N(s);
         ssize_t written = texmacs_fwrite (&s[0], n, fout);
         texmacs_fclose (fout);
         if (written != n) {
@@ -168,6 +178,282 @@ save_string (url u, string s, bool fatal) {
   return err;
 }
 
+/******************************************************************************
+* Streaming saves of TeXmacs documents
+******************************************************************************/
+
+#define SAVE_CHUNK 65536
+#define SAVE_CACHE 10000
+
+class save_ostream_rep: public tm_ostream_rep {
+public:
+  FILE*  file;
+  string buf;    // pending output, written by chunks of SAVE_CHUNK bytes
+  string head;   // start of the output, for caching small files
+  size_t total;  // number of bytes written so far
+  bool   err;    // error while writing
+
+public:
+  save_ostream_rep (FILE* file);
+  bool is_writable () const;
+  void write (const char* s, size_t n);
+  void flush ();
+};
+
+save_ostream_rep::save_ostream_rep (FILE* file2):
+  file (file2), buf (""), head (""), total (0), err (false) {}
+
+bool
+save_ostream_rep::is_writable () const {
+  return !err;
+}
+
+void
+save_ostream_rep::write (const char* s, size_t n) {
+  if (total <= SAVE_CACHE)
+    head << string (s, min ((DI) n, (DI) SAVE_CACHE + 1));
+  total += n;
+  buf << string (s, (DI) n);
+  if (N(buf) >= SAVE_CHUNK) flush ();
+}
+
+void
+save_ostream_rep::flush () {
+  DI n= N(buf);
+  if (n == 0) return;
+  if (!err && texmacs_fwrite (&buf[0], (size_t) n, file) != (ssize_t) n)
+    err= true;
+  buf= "";
+}
+
+bool
+save_texmacs (url u, tree doc, bool fatal) {
+  TRACE_SCOPE ("io", "save texmacs");
+  if (is_rooted_tmfs (u)) return save_string (u, tree_to_texmacs (doc), fatal);
+
+  url r= u;
+  if (!is_rooted_name (r)) r= resolve (r, "");
+  bool err= !is_rooted_name (r);
+  if (!err) {
+    string name= concretize (r);
+    string tmp = name * ".part";
+    string head;
+    size_t total= 0;
+    {
+      // write under a temporary name, so that an interrupted save
+      // never leaves a truncated document behind
+      FILE* fout = texmacs_fopen (tmp, "w");
+      if (fout == NULL) {
+        err= true;
+        std_warning << "Save error for " << name << ", "
+                    << strerror(errno) << "\n";
+      }
+      if (!err) {
+        save_ostream_rep* rep= tm_new<save_ostream_rep> (fout);
+        tm_ostream out (rep);
+        tree_to_texmacs (doc, out);
+        err  = rep->err;
+        head = rep->head;
+        total= rep->total;
+        texmacs_fclose (fout);
+        if (err) {
+          texmacs_remove (tmp);
+          std_warning << "Can't write to " << name << "\n";
+        }
+        else {
+#ifdef OS_MINGW
+          // renaming does not replace existing files on Windows
+          texmacs_remove (name);
+#endif
+          // keep the complete document if it cannot be moved in place
+          if (!texmacs_rename (tmp, name)) {
+            err= true;
+            std_warning << "Can't rename " << tmp << " to " << name << "\n";
+          }
+        }
+      }
+    }
+    // Cache file contents
+    bool file_flag= do_cache_file (name);
+    bool doc_flag= do_cache_doc (name);
+    string cache_type= doc_flag? string ("doc_cache"): string ("file_cache");
+    if (!err && total <= SAVE_CACHE)
+      if (file_flag || doc_flag)
+        cache_set (cache_type, name, head);
+    declare_out_of_date (url_parent (r));
+    // End caching
+  }
+
+  if (err && fatal) {
+    failed_error << "File name= " << as_string (u) << "\n";
+    FAILED ("file not writeable");
+  }
+  return err;
+}
+
+/******************************************************************************
+* Saving TeXmacs documents in the background
+*******************************************************************************
+* Trees and the kernel allocator are not thread safe.  Documents are
+* therefore serialized on the main thread, into memory which is allocated
+* by malloc, and only the writing and syncing of the file happen on a
+* worker thread.  The file is first written under a temporary name and
+* then moved in place, so that an interrupted save never leaves a
+* truncated file behind.  Small documents are saved at once, so that
+* they still go to the file cache.
+******************************************************************************/
+
+class std_string_ostream_rep: public tm_ostream_rep {
+public:
+  std::string* buf;
+
+public:
+  std_string_ostream_rep (std::string* buf2): buf (buf2) {}
+  bool is_writable () const { return true; }
+  void write (const char* s, size_t n) { buf->append (s, n); }
+};
+
+#if !defined (OS_MINGW) && !(defined (X11TEXMACS) && !defined (NO_FAST_ALLOC))
+// the fast allocator also serves operator new and is not thread-safe
+
+struct background_job {
+  std::string name;   // concrete name of the file
+  std::string data;   // contents of the file
+};
+
+static pthread_mutex_t background_lock= PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  background_work= PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  background_done= PTHREAD_COND_INITIALIZER;
+static std::deque<background_job*> background_queue;
+static std::map<std::string,int>  background_pending;
+static std::map<std::string,bool> background_failed;
+static bool background_started= false;
+
+static bool
+background_write (const std::string& name, const std::string& data) {
+  TRACE_SCOPE ("io", "background save");
+  TRACE_ARG (data.size ());
+  std::string tmp= name + ".part";
+  int fd= open (tmp.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) return true;
+  bool err= false;
+  size_t i= 0, n= data.size ();
+  while (i < n) {
+    ssize_t w= ::write (fd, data.data () + i, n - i);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) { err= true; break; }
+    i += (size_t) w;
+  }
+  if (!err && fsync (fd) != 0) err= true;
+  if (close (fd) != 0) err= true;
+  if (!err && rename (tmp.c_str (), name.c_str ()) != 0) err= true;
+  if (err) unlink (tmp.c_str ());
+  return err;
+}
+
+static void*
+background_worker (void*) {
+  pthread_mutex_lock (&background_lock);
+  while (true) {
+    while (background_queue.empty ())
+      pthread_cond_wait (&background_work, &background_lock);
+    background_job* job= background_queue.front ();
+    pthread_mutex_unlock (&background_lock);
+    bool err= background_write (job->name, job->data);
+    pthread_mutex_lock (&background_lock);
+    background_queue.pop_front ();
+    background_pending[job->name]--;
+    background_failed[job->name]= err;
+    delete job;
+    pthread_cond_broadcast (&background_done);
+  }
+  return NULL;
+}
+
+static bool
+background_submit (std::string name, std::string& data) {
+  // small files are written at once, unless an earlier save is pending
+  pthread_mutex_lock (&background_lock);
+  bool ok= data.size () > SAVE_CACHE || background_pending[name] > 0;
+  if (ok && !background_started) {
+    pthread_t id;
+    if (pthread_create (&id, NULL, background_worker, NULL) == 0) {
+      pthread_detach (id);
+      background_started= true;
+    }
+  }
+  ok= ok && background_started;
+  if (ok) {
+    background_job* job= new background_job ();
+    job->name= name;
+    job->data.swap (data);
+    background_queue.push_back (job);
+    background_pending[name]++;
+    pthread_cond_signal (&background_work);
+  }
+  else background_failed[name]= false;
+  pthread_mutex_unlock (&background_lock);
+  return ok;
+}
+
+static int
+background_status (std::string name) {
+  pthread_mutex_lock (&background_lock);
+  int r= 0;
+  if (background_pending[name] > 0) r= 1;
+  else if (background_failed[name]) r= -1;
+  pthread_mutex_unlock (&background_lock);
+  return r;
+}
+
+void
+background_save_wait () {
+  pthread_mutex_lock (&background_lock);
+  while (!background_queue.empty ())
+    pthread_cond_wait (&background_done, &background_lock);
+  pthread_mutex_unlock (&background_lock);
+}
+
+#else
+
+static bool background_submit (std::string, std::string&) { return false; }
+static int background_status (std::string) { return 0; }
+void background_save_wait () {}
+
+#endif
+
+bool
+background_save_texmacs (url u, tree doc) {
+  url r= u;
+  if (!is_rooted_name (r)) r= resolve (r, "");
+  if (is_rooted_tmfs (u) || !is_rooted_name (r))
+    return save_texmacs (u, doc);
+
+  std::string data;
+  {
+    tm_ostream out (tm_new<std_string_ostream_rep> (&data));
+    tree_to_texmacs (doc, out);
+  }
+  string name= concretize (r);
+  c_string name_c (name);
+  if (background_submit (std::string ((char*) name_c), data)) {
+    declare_out_of_date (url_parent (r));
+    return false;
+  }
+  return save_string (u, string (data.data (), (int) data.size ()));
+}
+
+int
+background_save_status (url u) {
+  url r= u;
+  if (!is_rooted_name (r)) r= resolve (r, "");
+  if (is_rooted_tmfs (u) || !is_rooted_name (r)) return 0;
+  c_string name_c (concretize (r));
+  int status= background_status (std::string ((char*) name_c));
+  if (status != 1) declare_out_of_date (url_parent (r));
+  return status;
+}
+
 bool
 append_string (url u, string s, bool fatal) {
   if (is_rooted_tmfs (u)) FAILED ("file not appendable");
@@ -186,7 +472,7 @@ append_string (url u, string s, bool fatal) {
                     << strerror(errno) << "\n";
       }
       if (!err) {
-        int n= N(s);
+        DI n= N(s);
         ssize_t written = texmacs_fwrite (&s[0], n, fout);
         if (written != n) {
           err= true;
@@ -242,10 +528,12 @@ get_attributes (url name, struct_stat* buf,
 
   //cout << "No cache" << LF;
 
-  bench_start ("stat");
-  bool flag = texmacs_stat (name_s, buf);
+  bool flag;
+  {
+    TRACE_SCOPE ("io", "stat");
+    flag= texmacs_stat (name_s, buf);
+  }
   (void) link_flag;
-  bench_cumul ("stat");
 
   // Cache stat results
   if (cache_flag) {
@@ -473,8 +761,8 @@ read_directory (url u, bool& error_flag) {
   // Directory contents in cache?
   if (is_cached ("dir_cache.scm", name) && is_up_to_date (u))
     return cache_dir_get (name);
-  bench_start ("read directory");
   // End caching
+  TRACE_SCOPE ("io", "read directory");
 
   TEXMACS_DIR dp;
   dp = texmacs_opendir (name);
@@ -493,7 +781,6 @@ read_directory (url u, bool& error_flag) {
   merge_sort (dir);
 
   // Caching of directory contents
-  bench_cumul ("read directory");
   if (do_cache_dir (name))
     cache_dir_set (name, dir);
   // End caching
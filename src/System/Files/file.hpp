@@ -23,6 +23,10 @@
  */
 bool load_string (url file_name, string& s, bool fatal);
 bool save_string (url file_name, string s, bool fatal=false);
+bool save_texmacs (url file_name, tree doc, bool fatal=false);
+bool background_save_texmacs (url file_name, tree doc);
+int  background_save_status (url file_name);
+void background_save_wait ();
 bool append_string (url u, string s, bool fatal= false);
 
 bool is_of_type (url name, string filter);
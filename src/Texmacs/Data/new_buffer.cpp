@@ -18,6 +18,10 @@
 #include "dictionary.hpp"
 #include "new_document.hpp"
 #include "merge_sort.hpp"
+#include "new_style.hpp"
+#ifdef PDF_RENDERER
+#include "Pdf/PDFWriter/MD5Generator.h"
+#endif
 
 array<tm_buffer> bufs;
 
@@ -475,24 +479,60 @@ buffer_load (url name) {
 }
 
 hashmap<string,tree> style_tree_cache ("");
+hashmap<string,string> style_tree_hash ("");
 
-tree
-load_style_tree (string package) {
-  if (style_tree_cache->contains (package))
-    return style_tree_cache [package];
+static url
+style_package_url (string package) {
   url name= url_none ();
   url styp= "$TEXMACS_STYLE_PATH";
   if (ends (package, ".ts")) name= package;
   else name= styp * (package * ".ts");
-  name= resolve (name);
+  return resolve (name);
+}
+
+static string
+style_contents_hash (string doc_s) {
+#ifdef PDF_RENDERER
+  MD5Generator md5;
+  if (N(doc_s) > 0) md5.Accumulate (std::string (&doc_s[0], N(doc_s)));
+  return md5.ToHexString().c_str();
+#else
+  return as_string (hash (doc_s)) * ":" * as_string (N(doc_s));
+#endif
+}
+
+string
+style_package_hash (string package) {
+  // hash of the contents of a style package, as loaded in this session
+  if (style_tree_hash->contains (package))
+    return style_tree_hash [package];
+  string doc_s;
+  string h= "none";
+  if (!load_string (style_package_url (package), doc_s, false))
+    h= style_contents_hash (doc_s);
+  style_tree_hash (package)= h;
+  return h;
+}
+
+tree
+load_style_tree (string package) {
+  if (style_tree_cache->contains (package)) {
+    style_note_package (package, style_tree_hash [package]);
+    return style_tree_cache [package];
+  }
+  url name= style_package_url (package);
   string doc_s;
   if (!load_string (name, doc_s, false)) {
     tree doc= texmacs_document_to_tree (doc_s);
     if (is_compound (doc)) doc= extract (doc, "body");
     style_tree_cache (package)= doc;
+    style_tree_hash (package)= style_contents_hash (doc_s);
+    style_note_package (package, style_tree_hash [package]);
     return doc;
   }
   style_tree_cache (package)= "";
+  style_tree_hash (package)= "none";
+  style_note_package (package, "none");
   return "";
 }
 
@@ -515,36 +555,30 @@ with_package_definitions (string package, tree body) {
 * Saving
 ******************************************************************************/
 
-bool
-export_tree (tree doc, url u, string fm) {
-  tree aux= doc;
+static tree
+export_hook (tree doc, url u, string fm) {
   // NOTE: hook for encryption
-  tree init= extract (aux, "initial");
+  tree init= extract (doc, "initial");
   if (fm == "texmacs")
     for (int i=0; i<N(init); i++)
-      if (is_func (init[i], ASSOCIATE, 2) && init[i][0] == "encryption") {
-        aux= as_tree (call ("tree-export-encrypted", u, aux));
-        break;
-      }
+      if (is_func (init[i], ASSOCIATE, 2) && init[i][0] == "encryption")
+        return as_tree (call ("tree-export-encrypted", u, doc));
   // END hook
+  return doc;
+}
+
+bool
+export_tree (tree doc, url u, string fm) {
+  tree aux= export_hook (doc, u, fm);
+  if (fm == "texmacs") return save_texmacs (u, aux);
   if (fm == "generic") fm= "verbatim";
   string s= tree_to_generic (aux, fm * "-document");
   if (s == "* error: unknown format *") return true;
   return save_string (u, s);
 }
 
-bool
-buffer_export (url name, url dest, string fm) {
-  tm_view vw= concrete_view (get_recent_view (name));
-  ASSERT (vw != NULL, "view expected");
-
-  if (fm == "postscript" || fm == "pdf") {
-    int old_stamp= last_modified (dest, false);
-    vw->ed->print_to_file (dest);
-    int new_stamp= last_modified (dest, false);
-    return new_stamp <= old_stamp;
-  }
-
+static tree
+buffer_document (tm_view vw, string fm) {
   tree body= subtree (the_et, vw->buf->rp);
   if (fm == "verbatim")
     body= vw->ed->exec_verbatim (body);
@@ -564,8 +598,31 @@ buffer_export (url name, url dest, string fm) {
   tree links= as_tree (call ("get-link-locations", arg1, arg2));
   if (N (links) != 0)
     doc << compound ("links", links);
-  
-  return export_tree (doc, dest, fm);
+  return doc;
+}
+
+bool
+buffer_export (url name, url dest, string fm) {
+  tm_view vw= concrete_view (get_recent_view (name));
+  ASSERT (vw != NULL, "view expected");
+
+  if (fm == "postscript" || fm == "pdf") {
+    int old_stamp= last_modified (dest, false);
+    vw->ed->print_to_file (dest);
+    int new_stamp= last_modified (dest, false);
+    return new_stamp <= old_stamp;
+  }
+
+  return export_tree (buffer_document (vw, fm), dest, fm);
+}
+
+bool
+buffer_autosave (url name, url dest) {
+  // serialize the buffer now and write it to dest in the background
+  tm_view vw= concrete_view (get_recent_view (name));
+  ASSERT (vw != NULL, "view expected");
+  tree doc= export_hook (buffer_document (vw, "texmacs"), dest, "texmacs");
+  return background_save_texmacs (dest, doc);
 }
 
 tree
@@ -100,11 +100,13 @@ bool buffer_has_name (url name);
 bool buffer_import (url name, url src, string fm);
 bool buffer_load (url name);
 bool buffer_export (url name, url dest, string fm);
+bool buffer_autosave (url name, url dest);
 bool buffer_save (url name);
 tree import_loaded_tree (string s, url u, string fm);
 tree import_tree (url u, string fm);
 bool export_tree (tree doc, url u, string fm);
 tree load_style_tree (string package);
+string style_package_hash (string package);
 tree with_package_definitions (string package, tree body);
 
 #endif // NEW_BUFFER_H
@@ -16,7 +16,9 @@
 #include "analyze.hpp"
 #include "dictionary.hpp"
 #include "tm_link.hpp"
+#include "file.hpp"
 #include "new_style.hpp"
+#include "tm_latency.hpp"
 #include "Database/database.hpp"
 
 server* the_server= NULL;
@@ -96,10 +98,11 @@ tm_server_rep::tm_server_rep (): def_zoomf (1.0) {
     tm_init_file= "$TEXMACS_PATH/progs/init-texmacs.scm";
   if (is_none (my_init_file))
     my_init_file= "$TEXMACS_HOME_PATH/progs/my-init-texmacs.scm";
-  bench_start ("initialize scheme");
-  if (exists (tm_init_file)) exec_file (tm_init_file);
-  if (exists (my_init_file)) exec_file (my_init_file);
-  bench_cumul ("initialize scheme");
+  {
+    TRACE_SCOPE ("boot", "initialize scheme");
+    if (exists (tm_init_file)) exec_file (tm_init_file);
+    if (exists (my_init_file)) exec_file (my_init_file);
+  }
   if (my_init_cmds != "") {
     my_init_cmds= "(begin" * my_init_cmds * ")";
     exec_delayed (scheme_cmd (my_init_cmds));
@@ -249,6 +252,9 @@ void
 tm_server_rep::quit () {
   close_all_pipes ();
   call ("quit-TeXmacs-scheme");
+  background_save_wait ();
+  trace_finish ();
+  latency_record_stop ();
   clear_pending_commands ();
 #ifdef QTTEXMACS
   del_obj_qt_renderer ();
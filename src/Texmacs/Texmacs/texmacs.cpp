@@ -359,6 +359,24 @@ TeXmacs_main (int argc, char** argv) {
             "(export-buffer " * scm_quote (as_string (out)) * ")";
         }
       }
+      else if (s == "-replay") {
+        i+=2;
+        if (i<argc) {
+          url doc  ("$PWD", argv[i-1]);
+          url keys ("$PWD", argv[ i ]);
+          my_init_cmds= my_init_cmds * " " *
+            "(latency-replay " * scm_quote (as_string (doc)) *
+            " " * scm_quote (as_string (keys)) * ")";
+        }
+      }
+      else if (s == "-bench") {
+        i++;
+        if (i<argc) {
+          url out ("$PWD", argv[i]);
+          my_init_cmds= my_init_cmds * " " *
+            "(bench-run " * scm_quote (as_string (out)) * ")";
+        }
+      }
       else if ((s == "-x") || (s == "-execute")) {
         i++;
         if (i<argc) my_init_cmds= (my_init_cmds * " ") * argv[i];
@@ -378,6 +396,7 @@ TeXmacs_main (int argc, char** argv) {
       }
       else if (s == "-server") start_server_flag= true;
       else if (s == "-log-file") i++;
+      else if (s == "-trace") i++;
       else if ((s == "-Oc") || (s == "-no-char-clipping")) char_clip= false;
       else if ((s == "+Oc") || (s == "-char-clipping")) char_clip= true;
       else if ((s == "-S") || (s == "-setup") ||
@@ -406,6 +425,8 @@ TeXmacs_main (int argc, char** argv) {
         cout << "\n";
         cout << "Options for TeXmacs:\n\n";
         cout << "  -b [file]  Specify scheme buffers initialization file\n";
+        cout << "  -bench [f] Run the benchmarks on the documentation and\n";
+        cout << "             save the results in JSON format to file 'f'\n";
         cout << "  -C [i] [o] Convert file 'i' into file 'o'\n";
         cout << "  -d         For debugging purposes\n";
         cout << "  -fn [font] Set the default TeX font\n";
@@ -416,8 +437,11 @@ TeXmacs_main (int argc, char** argv) {
         cout << "  -p         Get the TeXmacs path\n";
         cout << "  -q         Shortcut for -x \"(quit-TeXmacs)\"\n";
         cout << "  -r         Reverse video mode\n";
+        cout << "  -replay [d] [k] Replay the keys in 'k' on document 'd'\n";
+        cout << "             and report the latencies of the key presses\n";
         cout << "  -s         Suppress information messages\n";
         cout << "  -S         Rerun TeXmacs setup program before starting\n";
+        cout << "  -trace [f] Record a trace, written to file 'f' on exit\n";
         cout << "  -v         Display current TeXmacs version\n";
         cout << "  -V         Show some informative messages\n";
         cout << "  -W [i] [o] Recursively convert directory into website\n";
@@ -480,9 +504,10 @@ TeXmacs_main (int argc, char** argv) {
   // End user preferences
 
   if (DEBUG_STD) debug_boot << "Installing internal plug-ins...\n";
-  bench_start ("initialize plugins");
-  init_plugins ();
-  bench_cumul ("initialize plugins");
+  {
+    TRACE_SCOPE ("boot", "initialize plugins");
+    init_plugins ();
+  }
   if (DEBUG_STD) debug_boot << "Opening display...\n";
   
 #if defined(X11TEXMACS) && defined(MACOSX_EXTENSIONS)
@@ -511,13 +536,14 @@ TeXmacs_main (int argc, char** argv) {
     }
     if      ((s == "-c") || (s == "-convert") || (s == "-C") ||
 	     (s == "-W") || (s == "-build-website") ||
-	     (s == "-U") || (s == "-update-website")) i+=2;
+	     (s == "-U") || (s == "-update-website") ||
+             (s == "-replay")) i+=2;
     else if ((s == "-b") || (s == "-initialize-buffer") ||
              (s == "-fn") || (s == "-font") ||
              (s == "-i") || (s == "-initialize") ||
              (s == "-g") || (s == "-geometry") ||
              (s == "-x") || (s == "-execute") ||
-             (s == "-log-file") ||
+             (s == "-log-file") || (s == "-trace") || (s == "-bench") ||
              (s == "-build-manual") ||
              (s == "-reference-suite") || (s == "-test-suite")) {i++;}
   }
@@ -674,7 +700,8 @@ immediate_options (int argc, char** argv) {
 #ifdef QTTEXMACS
     else if (s == "-headless" || s == "-H" || s == "-C" ||
 	     s == "-build-website" || s == "-W" ||
-	     s == "-update-website" || s == "-U")
+	     s == "-update-website" || s == "-U" || s == "-replay" ||
+             s == "-bench")
       headless_mode= true;
 #endif
     else if (s == "-log-file" && i + 1 < argc) {
@@ -686,6 +713,10 @@ immediate_options (int argc, char** argv) {
       cout.redirect (logf);
       cerr.redirect (logf);
     }
+    else if (s == "-trace" && i + 1 < argc) {
+      i++;
+      trace_start (url_system (argv[i]));
+    }
   }
 }
 
@@ -748,9 +779,10 @@ texmacs_entrypoint (int argc, char** argv) {
   the_et     = tuple ();
   the_et->obs= ip_observer (path ());
   cache_initialize ();
-  bench_start ("initialize texmacs");
-  init_texmacs ();
-  bench_cumul ("initialize texmacs");
+  {
+    TRACE_SCOPE ("boot", "initialize texmacs");
+    init_texmacs ();
+  }
 #ifdef ENABLE_TESTS
   test_routines ();
 #endif
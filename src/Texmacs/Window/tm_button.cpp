@@ -56,7 +56,7 @@ initialize_environment (edit_env& env, tree doc, drd_info& drd) {
     if (!is_tuple (style)) FAILED ("tuple expected as style");
     H= get_style_env (style);
     drd= get_style_drd (style);
-    style_set_cache (style, H, drd->get_locals ());
+    style_set_cache (style, H, drd->get_locals (), get_style_deps (style));
     env->patch_env (H);
     drd->set_environment (H);
   }
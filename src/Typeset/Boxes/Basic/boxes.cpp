@@ -934,8 +934,8 @@ make_eps (url name, box b, int dpi) {
   tm_delete (ren);
 }
 
-void
-make_raster_image (url name, box b, double zoomf) {
+picture
+make_raster_picture (box b, double zoomf) {
   SI pixel= 5*PIXEL;
   SI w= b->x4 - b->x3;
   SI h= b->y4 - b->y3;
@@ -949,6 +949,11 @@ make_raster_image (url name, box b, double zoomf) {
   renderer ren= picture_renderer (pic, zoomf);
   rectangles rs;
   b->redraw (ren, path (0), rs);
-  save_picture (name, pic);
   tm_delete (ren);
+  return pic;
+}
+
+void
+make_raster_image (url name, box b, double zoomf) {
+  save_picture (name, make_raster_picture (b, zoomf));
 }
@@ -278,6 +278,7 @@ struct page_border_box_rep: change_box_rep {
   SI l, r, b, t, pixel;
   page_border_box_rep (path ip, box pb, color tmb,
                        SI l, SI r, SI b, SI t, SI pixel);
+  int get_type () { return PAGE_BORDER_BOX; }
   operator tree ();
   void pre_display (renderer& ren);
   void display_background (renderer ren);
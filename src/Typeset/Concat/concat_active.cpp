@@ -167,6 +167,7 @@ build_locus (edit_env env, tree t, list<string>& ids, string& col, string &ref,
   string current_col= env->get_string (COLOR);
   string locus_col= env->get_string (var);
   if (on_paper) visited= false;
+  if (preserve && locus_col != "preserve") env->printed_dep= true;
   if (locus_col == "preserve") col= current_col;
   else if (on_paper && preserve) col= current_col;
   else if (locus_col == "global") col= get_locus_rendering (var);
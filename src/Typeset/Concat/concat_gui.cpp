@@ -68,6 +68,7 @@ canvas_properties
 get_canvas_properties (edit_env env, tree t) {
   bool printed= (env->get_string (PAGE_PRINTED) == "true");
   SI   border = env->get_length (ORNAMENT_BORDER);
+  env->printed_dep= true;
   if (!printed) {
     SI pixel= env->pixel;
     border= max (pixel, ((border + pixel/2) / pixel) * pixel);
@@ -73,9 +73,9 @@ edit_env_rep::rewrite (tree t) {
       if (N(t) < 3 ||
 	  !(is_atomic (t[0]) && is_atomic (t[1]) && is_atomic (t[2])))
 	return tree (TMERROR, "invalid map arguments");
-      if (is_nil (macro_arg) || (!macro_arg->item->contains (t[2]->label)))
+      if (is_nil (macro_arg) || (!has_macro_arg (t[2]->label)))
 	return tree (TMERROR, "map arguments " * t[2]->label);
-      tree v= macro_arg->item [t[2]->label];
+      tree v= get_macro_arg (t[2]->label);
       if (is_atomic (v))
 	return tree (TMERROR, "map arguments " * t[2]->label);
       int start= 0, end= N(v);
@@ -84,6 +84,8 @@ edit_env_rep::rewrite (tree t) {
 
       list<hashmap<string,tree> > old_var= macro_arg;
       list<hashmap<string,path> > old_src= macro_src;
+      list<macro_frame> old_pos= macro_pos;
+      if (in_compiled_macro ()) macro_pos= macro_pos->next;
       if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
       if (!is_nil (macro_src)) macro_src= macro_src->next;
 
@@ -100,6 +102,7 @@ edit_env_rep::rewrite (tree t) {
 
       macro_arg= old_var;
       macro_src= old_src;
+      macro_pos= old_pos;
       return r;
     }
   case VAR_INCLUDE:
@@ -125,9 +128,9 @@ edit_env_rep::rewrite (tree t) {
       if ((!is_func (t[0], ARG)) ||
 	  is_compound (t[0][0]) ||
 	  is_nil (macro_arg) ||
-	  (!macro_arg->item->contains (t[0][0]->label)))
+	  (!has_macro_arg (t[0][0]->label)))
 	return tree (TMERROR, "invalid rewrite-inactive");
-      tree val= macro_arg->item [t[0][0]->label];
+      tree val= get_macro_arg (t[0][0]->label);
       int i, n= N(t[0]);
       for (i=1; i<n; i++) {
 	int j= as_int (t[0][i]);
@@ -670,27 +673,117 @@ edit_env_rep::exec_with (tree t) {
   return u;
 }
 
+/******************************************************************************
+* Compiled macros
+******************************************************************************/
+
+static hashmap<string,tree> compiled_arg (UNINIT);
+static hashmap<string,path> compiled_src (path (DECORATION));
+
+bool
+edit_env_rep::in_compiled_macro () {
+  return !is_nil (macro_arg) &&
+         macro_arg->item.operator -> () == compiled_arg.operator -> ();
+}
+
+bool
+edit_env_rep::has_macro_arg (string var) {
+  if (is_nil (macro_arg)) return false;
+  if (!in_compiled_macro ()) return macro_arg->item->contains (var);
+  array<string> vars= macro_pos->item->mac->var;
+  for (int k=0; k<N(vars); k++)
+    if (vars[k] == var) return true;
+  return false;
+}
+
+tree
+edit_env_rep::get_macro_arg (string var) {
+  if (is_nil (macro_arg)) return tree (UNINIT);
+  if (!in_compiled_macro ()) return macro_arg->item [var];
+  macro_frame fr= macro_pos->item;
+  for (int k=N(fr->mac->var)-1; k>=0; k--)
+    if (fr->mac->var[k] == var) return fr->arg[k];
+  return tree (UNINIT);
+}
+
+static void
+resolve_args (compiled_macro mac, tree t) {
+  if (is_atomic (t)) return;
+  if ((is_func (t, ARG) || is_func (t, QUOTE_ARG)) && is_atomic (t[0]))
+    for (int k=N(mac->var)-1; k>=0; k--)
+      if (mac->var[k] == t[0]->label) {
+        mac->slot ((pointer) inside (t))= k;
+        break;
+      }
+  for (int i=0; i<N(t); i++)
+    resolve_args (mac, t[i]);
+}
+
+compiled_macro
+edit_env_rep::compile_macro (string var, tree f) {
+  // Return the compiled form of the macro f which was defined as var
+  compiled_macro mac= macro_bin [var];
+  if (!is_nil (mac) && strong_equal (mac->def, f)) return mac;
+  int i, n= N(f)-1;
+  for (i=0; i<n; i++)
+    if (!is_atomic (f[i])) return compiled_macro ();
+  mac= compiled_macro (f);
+  for (i=0; i<n; i++) mac->var << f[i]->label;
+  resolve_args (mac, f[n]);
+  macro_bin (var)= mac;
+  return mac;
+}
+
+int
+edit_env_rep::compiled_slot (tree ref) {
+  // Position of the argument for an arg reference in the current macro
+  if (!in_compiled_macro ()) return -1;
+  return macro_pos->item->mac->slot [(pointer) inside (ref)];
+}
+
+/******************************************************************************
+* Macro expansion
+******************************************************************************/
+
 tree
 edit_env_rep::exec_compound (tree t) {
-  int d; tree f;
+  int d; tree f; string var;
   if (L(t) == COMPOUND) {
     if (N(t)<1) return tree (TMERROR, "bad compound");
     d= 1;
     f= t[0];
     if (is_compound (f)) f= exec (f);
     if (is_atomic (f)) {
-      string var= f->label;
+      var= f->label;
       if (!provides (var)) return tree (TMERROR, "compound " * var);
       f= read (var);
     }
   }
   else {
-    string var= as_string (L(t));
+    var= as_string (L(t));
     if (!provides (var)) return tree (TMERROR, "compound " * var);
     d= 0;
     f= read (var);
   }
 
+  if (is_func (f, MACRO) && N(var) != 0) {
+    compiled_macro mac= compile_macro (var, f);
+    if (!is_nil (mac)) {
+      int i, n=N(f)-1, m=N(t)-d;
+      macro_frame fr (mac, n);
+      for (i=0; i<n; i++)
+	fr->arg[i]= i<m? t[i+d]: tree (UNINIT);
+      macro_arg= list<hashmap<string,tree> > (compiled_arg, macro_arg);
+      macro_src= list<hashmap<string,path> > (compiled_src, macro_src);
+      macro_pos= list<macro_frame> (fr, macro_pos);
+      tree r= exec (f[n]);
+      macro_arg= macro_arg->next;
+      macro_src= macro_src->next;
+      macro_pos= macro_pos->next;
+      return r;
+    }
+  }
+
   if (is_applicable (f)) {
     int i, n=N(f)-1, m=N(t)-d;
     macro_arg= list<hashmap<string,tree> > (
@@ -886,11 +979,17 @@ edit_env_rep::exec_arg (tree t) {
   tree r= t[0];
   if (is_compound (r))
     return tree (TMERROR, "bad arg");
-  if (is_nil (macro_arg) || (!macro_arg->item->contains (r->label)))
-    return tree (TMERROR, "arg " * r->label);
-  r= macro_arg->item [r->label];
+  int k= compiled_slot (t);
+  if (k >= 0) r= macro_pos->item->arg[k];
+  else {
+    if (is_nil (macro_arg) || (!has_macro_arg (r->label)))
+      return tree (TMERROR, "arg " * r->label);
+    r= get_macro_arg (r->label);
+  }
   list<hashmap<string,tree> > old_var= macro_arg;
   list<hashmap<string,path> > old_src= macro_src;
+  list<macro_frame> old_pos= macro_pos;
+  if (in_compiled_macro ()) macro_pos= macro_pos->next;
   if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
   if (!is_nil (macro_src)) macro_src= macro_src->next;
   bool err= false;
@@ -908,6 +1007,7 @@ edit_env_rep::exec_arg (tree t) {
   else r= exec (r);
   macro_arg= old_var;
   macro_src= old_src;
+  macro_pos= old_pos;
   return r;
 }
 
@@ -919,9 +1019,13 @@ edit_env_rep::exec_quote_arg (tree t) {
   tree r= t[0];
   if (is_compound (r))
     return tree (TMERROR, "bad quote-arg");
-  if (is_nil (macro_arg) || (!macro_arg->item->contains (r->label)))
-    return tree (TMERROR, "quoted argument " * r->label);
-  r= macro_arg->item [r->label];
+  int k= compiled_slot (t);
+  if (k >= 0) r= macro_pos->item->arg[k];
+  else {
+    if (is_nil (macro_arg) || (!has_macro_arg (r->label)))
+      return tree (TMERROR, "quoted argument " * r->label);
+    r= get_macro_arg (r->label);
+  }
   if (N(t) > 1) {
     int i, n= N(t);
     for (i=1; i<n; i++) {
@@ -960,10 +1064,12 @@ tree
 edit_env_rep::exec_eval_args (tree t) {
   if (N(t)<1) return tree (TMERROR, "bad eval-args");
   if(is_nil(macro_arg)) return tree(TMERROR, "nil argument");
-  tree v= macro_arg->item [as_string (t[0])];
+  tree v= get_macro_arg (as_string (t[0]));
   if (is_atomic (v)) return tree (TMERROR, "eval arguments " * t[0]->label);
   list<hashmap<string,tree> > old_var= macro_arg;
   list<hashmap<string,path> > old_src= macro_src;
+  list<macro_frame> old_pos= macro_pos;
+  if (in_compiled_macro ()) macro_pos= macro_pos->next;
   if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
   if (!is_nil (macro_src)) macro_src= macro_src->next;
 
@@ -974,6 +1080,7 @@ edit_env_rep::exec_eval_args (tree t) {
 
   macro_arg= old_var;
   macro_src= old_src;
+  macro_pos= old_pos;
   return r;
 }
 
@@ -1770,16 +1877,19 @@ edit_env_rep::exec_arg_recursive (tree t) {
   tree r= t[0];
   if (is_compound (r))
     return tree (TMERROR, "bad arg");
-  if (is_nil (macro_arg) || (!macro_arg->item->contains (r->label)))
+  if (is_nil (macro_arg) || (!has_macro_arg (r->label)))
     return tree (TMERROR, "arg " * r->label);
-  r= macro_arg->item [r->label];
+  r= get_macro_arg (r->label);
   list<hashmap<string,tree> > old_var= macro_arg;
   list<hashmap<string,path> > old_src= macro_src;
+  list<macro_frame> old_pos= macro_pos;
+  if (in_compiled_macro ()) macro_pos= macro_pos->next;
   if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
   if (!is_nil (macro_src)) macro_src= macro_src->next;
   if (is_func (r, ARG, 1)) r= exec_arg_recursive (r);
   macro_arg= old_var;
   macro_src= old_src;
+  macro_pos= old_pos;
   return r;
 }
 
@@ -2743,12 +2853,14 @@ edit_env_rep::exec_until_arg (tree t, path p, string var, int level) {
   // cout << "  " << macro_arg << "\n";
   tree r= t[0];
   if (is_atomic (r) && (!is_nil (macro_arg)) &&
-      macro_arg->item->contains (r->label))
+      has_macro_arg (r->label))
     {
       bool found;
-      tree arg= macro_arg->item [r->label];
+      tree arg= get_macro_arg (r->label);
       list<hashmap<string,tree> > old_var= macro_arg;
       list<hashmap<string,path> > old_src= macro_src;
+      list<macro_frame> old_pos= macro_pos;
+      if (in_compiled_macro ()) macro_pos= macro_pos->next;
       if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
       if (!is_nil (macro_src)) macro_src= macro_src->next;
       if (level == 0) {
@@ -2772,6 +2884,7 @@ edit_env_rep::exec_until_arg (tree t, path p, string var, int level) {
       else found= exec_until (arg, p, var, level-1);
       macro_arg= old_var;
       macro_src= old_src;
+      macro_pos= old_pos;
       return found;
     }
   else return false;
@@ -2872,11 +2985,13 @@ edit_env_rep::expand (tree t, bool search_accessible) {
       return tree (TMERROR, "bad argument application");
     if (is_compound (t[0]))
       return tree (TMERROR, "bad argument application");
-    if (!macro_arg->item->contains (t[0]->label))
+    if (!has_macro_arg (t[0]->label))
       return tree (TMERROR, "argument " * t[0]->label);
-    tree r= macro_arg->item [t[0]->label];
+    tree r= get_macro_arg (t[0]->label);
     list<hashmap<string,tree> > old_var= macro_arg;
     list<hashmap<string,path> > old_src= macro_src;
+    list<macro_frame> old_pos= macro_pos;
+    if (in_compiled_macro ()) macro_pos= macro_pos->next;
     if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
     if (!is_nil (macro_src)) macro_src= macro_src->next;
     if (N(t) > 1) {
@@ -2893,6 +3008,7 @@ edit_env_rep::expand (tree t, bool search_accessible) {
       r= expand (r, search_accessible);
     macro_arg= old_var;
     macro_src= old_src;
+    macro_pos= old_pos;
     return r;
   }
   else if (is_func (t, EXPAND_AS, 2)) {
@@ -2933,16 +3049,19 @@ edit_env_rep::depends (tree t, string s, int level) {
       // like those encountered after rewritings (VAR_INCLUDE, EXTERN, etc.)
       tree v= (L(t) == MAP_ARGS? t[2]: t[0]);
       if (is_compound (v)) return false;
-      if (!macro_arg->item->contains (v->label)) return false;
+      if (!has_macro_arg (v->label)) return false;
       if (level == 0) return v->label == s;
-      tree r= macro_arg->item [v->label];
+      tree r= get_macro_arg (v->label);
       list<hashmap<string,tree> > old_var= macro_arg;
       list<hashmap<string,path> > old_src= macro_src;
+      list<macro_frame> old_pos= macro_pos;
+      if (in_compiled_macro ()) macro_pos= macro_pos->next;
       if (!is_nil (macro_arg)) macro_arg= macro_arg->next;
       if (!is_nil (macro_src)) macro_src= macro_src->next;
       bool dep= depends (r, s, level-1);
       macro_arg= old_var;
       macro_src= old_src;
+      macro_pos= old_pos;
       return dep;
     }
   else {
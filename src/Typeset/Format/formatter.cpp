@@ -92,6 +92,12 @@ void
 lazy_rep::propagate () {
 }
 
+void
+lazy_rep::prepare (lazy_type request, format fm) {
+  (void) request;
+  (void) fm;
+}
+
 void
 lazy_rep::append (lazy lz) {
   (void) lz;
@@ -23,6 +23,10 @@ array<path>
 line_breaks (array<line_item> a, int start, int end,
 	     SI line_width, SI large_width,
              SI first_spc, SI last_spc, bool ragged);
+void
+line_breaks_request (array<line_item> a, int start, int end,
+		     SI line_width, SI large_width,
+		     SI first_spc, SI last_spc);
 
 /******************************************************************************
 * Constructor
@@ -706,6 +710,51 @@ lazy_paragraph_rep::line_units (
   // cout << "    Done!\n";
 }
 
+/******************************************************************************
+* Decomposition of paragraphs into units and lines
+*******************************************************************************
+* A paragraph is cut into units at NEW_LINE items, and each unit into
+* lines which are broken independently at NEXT_LINE items.  The style
+* parameters for the indentation of the first line may change inside
+* each unit.  The decomposition is shared by format_paragraph and prepare,
+* which must announce exactly the line breaking problems met by the former.
+******************************************************************************/
+
+static bool
+paragraph_unit_end (array<line_item> a, int i) {
+  return i == N(a) || (a[i]->type == CONTROL_ITEM && a[i]->t == NEW_LINE);
+}
+
+static void
+paragraph_unit_style (array<line_item> a, int start, int end,
+                      hashmap<string,tree>& style) {
+  int j, k;
+  bool no_first= (style [PAR_NO_FIRST] == "true");
+  style (PAR_NO_FIRST)= "false";
+  if (no_first) style (PAR_FIRST)= "0cm";
+  for (j=start; j<end; j++)
+    if (a[j]->type == CONTROL_ITEM)
+      if (is_tuple (a[j]->t, "env_par")) {
+        if (a[j]->t[1]->label == PAR_FIRST) {
+          for (k=j-1; k>=start; k--)
+            if (a[k]->b->w () != 0) break;
+          if (k >= start) continue;
+        }
+        style (a[j]->t[1]->label)= a[j]->t[2];
+      }
+}
+
+static array<int>
+paragraph_unit_lines (array<line_item> a, int start, int end) {
+  // the boundaries of the lines of a unit, including start and end
+  array<int> r;
+  r << start;
+  for (int i=start; i<end; i++)
+    if (a[i]->type == CONTROL_ITEM && a[i]->t == NEXT_LINE) r << i;
+  r << end;
+  return r;
+}
+
 /******************************************************************************
 * Typesetting a paragraph
 ******************************************************************************/
@@ -713,21 +762,15 @@ lazy_paragraph_rep::line_units (
 void
 lazy_paragraph_rep::format_paragraph_unit (int the_start, int the_end) {
   // cout << "Paragraph unit " << the_start << ", " << the_end << "\n";
-  int i, start= the_start, end= the_start;
-  for (i=the_start; i<=the_end; i++)
-    if ((i==the_end) ||
-	((a[i]->type == CONTROL_ITEM) &&
-	 (a[i]->t == NEXT_LINE)))
-    {
-      start= end;
-      end  = i;
-      line_start ();
-      line_units (start, end, start==the_start, end==the_end,
-		  mode, hyphen,
-		  left, width, first, 0);
-      if (end<the_end) line_end (line_sep, 1);
-      else return;
-    }
+  array<int> lines= paragraph_unit_lines (a, the_start, the_end);
+  for (int i=0; i+1<N(lines); i++) {
+    int start= lines[i], end= lines[i+1];
+    line_start ();
+    line_units (start, end, start==the_start, end==the_end,
+		mode, hyphen,
+		left, width, first, 0);
+    if (end<the_end) line_end (line_sep, 1);
+  }
   // cout << "Unit done\n";
 }
 
@@ -735,31 +778,15 @@ void
 lazy_paragraph_rep::format_paragraph () {
   width -= right;
 
-  int start= 0, i, j, k;
+  int start= 0, i;
   // cout << "Typeset " << a << "\n";
   for (i=0; i<=N(a); i++) {
     // determine the next unit
-    if (i<N(a)) {
-      if (a[i]->type != CONTROL_ITEM) continue;
-      if (a[i]->t == NEW_LINE);
-      else continue;
-    }
+    if (!paragraph_unit_end (a, i)) continue;
 
     // determine the style parameters
+    paragraph_unit_style (a, start, i, style);
     bool no_first= (style [PAR_NO_FIRST] == "true");
-    style (PAR_NO_FIRST)= "false";
-    if (no_first) style (PAR_FIRST)= "0cm";
-    for (j=start; j<i; j++)
-      if (a[j]->type == CONTROL_ITEM)
-        if (is_tuple (a[j]->t, "env_par")) {
-          if (a[j]->t[1]->label == PAR_FIRST) {
-            for (k=j-1; k>=start; k--)
-              if (a[k]->b->w () != 0) break;
-            if (k >= start) continue;
-          }
-          style (a[j]->t[1]->label)= a[j]->t[2];
-        }
-    no_first= (style [PAR_NO_FIRST] == "true");
     if (no_first) env->monitored_write_update (PAR_NO_FIRST, "true");
     if (mode == "center") first= 0;
     else first= env->as_length (style [PAR_FIRST]);
@@ -943,6 +970,35 @@ lazy_paragraph_rep::produce (lazy_type request, format fm) {
   return lazy_rep::produce (request, fm);
 }
 
+void
+lazy_paragraph_rep::prepare (lazy_type request, format fm) {
+  // Announce the line breaking problems which will be met by produce,
+  // following the same decomposition into units as format_paragraph
+  if (request != LAZY_VSTREAM || fm->type != FORMAT_VSTREAM) return;
+  if (hyphen == "normal") return;
+  format_vstream fs= (format_vstream) fm;
+  array<line_item> b= a;
+  if (N (fs->before) != 0) b= join (fs->before, b);
+  if (N (fs->after ) != 0) b= join (b, fs->after );
+  SI line_width = fs->width - right - left;
+  SI large_width= (SI) (line_width / (1.0 - 0.5 * (kreduce + contraction)));
+
+  hashmap<string,tree> st (UNINIT);
+  st (PAR_FIRST)   = style [PAR_FIRST];
+  st (PAR_NO_FIRST)= style [PAR_NO_FIRST];
+  int start= 0, i, k;
+  for (i=0; i<=N(b); i++) {
+    if (!paragraph_unit_end (b, i)) continue;
+    paragraph_unit_style (b, start, i, st);
+    SI the_first= (mode == "center"? 0: env->as_length (st [PAR_FIRST]));
+    array<int> lines= paragraph_unit_lines (b, start, i);
+    for (k=0; k+1<N(lines); k++)
+      line_breaks_request (b, lines[k], lines[k+1],
+                           line_width, large_width, the_first, 0);
+    start= i;
+  }
+}
+
 void
 lazy_paragraph_rep::propagate () {
   style (PAR_NO_FIRST)= env->read (PAR_NO_FIRST);
@@ -103,6 +103,7 @@ public:
   lazy produce (lazy_type request, format fm);
   format query (lazy_type request, format fm);
   void propagate ();
+  void prepare (lazy_type request, format fm);
 
   friend array<page_item>
   typeset_stack (edit_env env, tree t, path ip, SI width,
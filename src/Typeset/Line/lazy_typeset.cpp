@@ -25,6 +25,9 @@ lazy make_lazy_table (edit_env env, tree t, path ip);
 lazy make_lazy_canvas (edit_env env, tree t, path ip);
 lazy make_lazy_ornament (edit_env env, tree t, path ip);
 lazy make_lazy_art_box (edit_env env, tree t, path ip);
+int  line_breaks_threads ();
+void line_breaks_prefetch ();
+void line_breaks_forget ();
 
 /******************************************************************************
 * Documents
@@ -60,6 +63,8 @@ lazy_document_rep::query (lazy_type request, format fm) {
   return lazy_rep::query (request, fm);
 }
 
+static bool line_breaks_batch= false;
+
 lazy
 lazy_document_rep::produce (lazy_type request, format fm) {
   if (request == type) return this;
@@ -74,6 +79,13 @@ lazy_document_rep::produce (lazy_type request, format fm) {
       before= fs->before;
       after = fs->after ;
     }
+    // break the lines of all paragraphs in parallel at the outermost level
+    bool batch= !line_breaks_batch && n >= 8 && line_breaks_threads () > 1;
+    if (batch) {
+      line_breaks_batch= true;
+      prepare (request, fm);
+      line_breaks_prefetch ();
+    }
     array<page_item> l;
     stack_border     sb;
     for (i=0; i<n; i++) {
@@ -89,6 +101,10 @@ lazy_document_rep::produce (lazy_type request, format fm) {
       }
       else merge_stack (l, sb, tmp_vs->l, tmp_vs->sb);
     }
+    if (batch) {
+      line_breaks_forget ();
+      line_breaks_batch= false;
+    }
     return lazy_vstream (ip, "", l, sb);
   }
   return lazy_rep::produce (request, fm);
@@ -99,6 +115,19 @@ lazy_document_rep::propagate () {
   if (N(par) > 0) par[0]->propagate ();
 }
 
+void
+lazy_document_rep::prepare (lazy_type request, format fm) {
+  if (request != LAZY_VSTREAM || fm->type != FORMAT_VSTREAM) return;
+  format_vstream fs= (format_vstream) fm;
+  int i, n= N(par);
+  for (i=0; i<n; i++) {
+    format tmp_fm= make_format_vstream (fs->width,
+      i==0  ? fs->before: array<line_item> (),
+      i==n-1? fs->after : array<line_item> ());
+    par[i]->prepare (request, tmp_fm);
+  }
+}
+
 /******************************************************************************
 * Surround
 ******************************************************************************/
@@ -168,6 +197,15 @@ lazy_surround_rep::propagate () {
   par->propagate ();
 }
 
+void
+lazy_surround_rep::prepare (lazy_type request, format fm) {
+  if (request != LAZY_VSTREAM || fm->type != FORMAT_VSTREAM) return;
+  format_vstream fs= (format_vstream) fm;
+  array<line_item> before= join (fs->before, a);
+  array<line_item> after = join (b, fs->after);
+  par->prepare (request, make_format_vstream (fs->width, before, after));
+}
+
 lazy
 add_markers (edit_env env, lazy par, path ip) {
   array<line_item> a= typeset_marker (env, descend (ip, 0));
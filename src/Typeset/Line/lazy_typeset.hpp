@@ -26,6 +26,7 @@ struct lazy_document_rep: public lazy_rep {
   lazy produce (lazy_type request, format fm);
   format query (lazy_type request, format fm);
   void propagate ();
+  void prepare (lazy_type request, format fm);
 };
 
 struct lazy_document {
@@ -50,6 +51,7 @@ struct lazy_surround_rep: public lazy_rep {
   lazy produce (lazy_type request, format fm);
   format query (lazy_type request, format fm);
   void propagate ();
+  void prepare (lazy_type request, format fm);
 };
 
 struct lazy_surround {
@@ -11,40 +11,61 @@
 
 #include "Boxes/construct.hpp"
 #include "Format/line_item.hpp"
+#include "boot.hpp"
+#include "iterator.hpp"
+#include <vector>
+#include <utility>
 #define PEN DI
 
+#ifndef OS_MINGW
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 /******************************************************************************
-* Information about the best line breaks
+* The states of the line breaking algorithm
+*******************************************************************************
+* The possible break positions are numbered by integers.  The position
+* just before the i-th line_item has number i, and positions inside
+* hyphenated strings get numbers beyond end, as they are encountered.
+* For each position, we store the best way to reach it, the width and
+* the length of the line_item which starts at it, and the hyphenation
+* candidates of this line_item.  Only plain C++ data are stored here,
+* so that the optimization can also run on a worker thread, as long as
+* it only needs line_items which have already been measured and
+* hyphenated on the main thread.
 ******************************************************************************/
 
-struct lb_info_rep: concrete_struct {
-  path prev;
-  int  pen;
-  PEN  pen_spc;
-
-  lb_info_rep (): prev (), pen (HYPH_INVALID), pen_spc ((PEN) 1000000000) {}
-};
-
-struct lb_info {
-  CONCRETE(lb_info);
-  lb_info () { rep= tm_new<lb_info_rep> (); }
-  operator tree () {
-    return tuple ((tree) rep->prev,
-		  as_string (rep->pen),
-		  as_string ((double) rep->pen_spc)); }
+struct lb_state {
+  int  item;      // index of the line_item
+  int  parent;    // position before hyphenation or -1
+  int  hyph;      // hyphenation position inside parent or -1
+  int  prev;      // previous break of the best way or -1
+  int  pen;       // penalty of the best way
+  PEN  pen_spc;   // spacing penalty of the best way
+  SI   w;         // width of the line_item starting at the position
+  int  len;       // length of its string (0 if none, -1 if unknown)
+  bool split;     // hyphenation candidates known?
+  std::vector<int> kids;   // hyphenated positions inside rest, by hyphenation
+  std::vector<int> hp;     // hyphenation penalties of rest
+  std::vector<SI>  left;   // widths of the hyphenated parts of rest
+  std::vector<SI>  right;  // widths of the remainders after hyphenation
+  std::vector<int> rlen;   // lengths of these remainders (-1 if unknown)
+  std::vector<int> glyph;  // ends of the glyphs in the string of rest
+  std::vector<SI>  xpos;   // horizontal positions of these ends
+
+  lb_state (int item2= 0, int parent2= -1, int hyph2= -1):
+    item (item2), parent (parent2), hyph (hyph2), prev (-1),
+    pen (HYPH_INVALID), pen_spc ((PEN) 1000000000),
+    w (0), len (-1), split (false) {}
 };
-CONCRETE_CODE(lb_info);
 
 tm_ostream&
-operator << (tm_ostream& out, lb_info hi) {
-  return out << "[ " << hi->prev << ", "
-	     << hi->pen << ", " << hi->pen_spc << " ]";
+operator << (tm_ostream& out, const lb_state& st) {
+  return out << "[ " << st.item << ", " << st.hyph << ", " << st.prev << ", "
+	     << st.pen << ", " << st.pen_spc << " ]";
 }
 
-// FIXME: explicit instantiation for broken g++
-#include "hashmap.hpp"
-template lb_info& hashmap_rep<list<int>, lb_info>::bracket_rw(list<int>);
-
 /******************************************************************************
 * The line_breaker class
 ******************************************************************************/
@@ -58,7 +79,18 @@ struct line_breaker_rep {
   SI  first_spc;
   SI  last_spc;
   int pass;
-  hashmap<path,lb_info> best;
+
+  bool detached;               // running without access to the line_items?
+  bool failed;                 // missing data while detached
+  std::vector<std::pair<int,int> > wanted;  // missing data, see want
+  bool solved;                 // optimization done?
+  std::vector<lb_state> st;    // the break positions
+  std::vector<int>  penalty;   // penalties of the line_items
+  std::vector<bool> brk;       // explicit line breaks
+  std::vector<DI>   sum_min;   // accumulated minimal spaces before line_items
+  std::vector<DI>   sum_def;   // accumulated default spaces before line_items
+  std::vector<DI>   sum_max;   // accumulated maximal spaces before line_items
+  array<line_item>  rest;      // line_items starting at the positions
 
   line_breaker_rep (array<line_item> a, int start, int end,
 		    SI line_width, SI large_width, SI first_spc, SI last_spc);
@@ -67,11 +99,24 @@ struct line_breaker_rep {
   path next_ragged_break (path pos);
   array<path> compute_ragged_breaks ();
 
-  void test_better (path new_pos, path old_pos, int penalty, PEN pen_spc);
-  bool propose_break (path new_pos, path old_pos, int penalty, space spc);
-  void break_string (line_item item, path pos, int i, space spc);
-  void process (path pos);
-  void get_breaks (array<path>& ap, path p);
+  int  get_state (int pos, int j);
+  line_item get_rest (int pos);
+  bool get_width (int pos);
+  bool get_hyphens (int pos);
+  SI   get_left (int pos, int j);
+  int  get_glyph_position (int pos, SI x);
+  void test_better (int pos, int j, int old_pos, int penalty, PEN pen_spc);
+  bool propose_break (int pos, int j, int old_pos, int penalty,
+                      SI spc_min, SI spc_def, SI spc_max);
+  void break_string (int src, int pos, SI spc_min, SI spc_def, SI spc_max);
+  bool want (int pos, int what);
+  void process (int pos);
+  void prepare ();
+  void complete ();
+  void solve ();
+  path get_path (int pos);
+  void get_breaks (array<path>& ap, int pos);
+  array<path> get_breaks ();
   array<path> compute_breaks ();
 };
 
@@ -81,7 +126,7 @@ line_breaker_rep::line_breaker_rep (
     a (a2), start (start2), end (end2),
     line_width (line_width2), large_width (large_width2),
     first_spc (first_spc2), last_spc (last_spc2),
-    best (lb_info ()) {}
+    detached (false), failed (false), solved (false) {}
 
 /******************************************************************************
 * Some subroutines
@@ -253,24 +298,155 @@ line_breaker_rep::compute_ragged_breaks () {
   return ap;
 }
 
+/******************************************************************************
+* Access to the break positions
+******************************************************************************/
+
+int
+line_breaker_rep::get_state (int pos, int j) {
+  // the position after the j-th hyphen of the line_item starting at pos
+  if (j < 0) return pos;
+  int k, n= (int) st[pos].kids.size ();
+  for (k=0; k<n; k++) {
+    int kid= st[pos].kids[k];
+    if (st[kid].hyph == j) return kid;
+    if (st[kid].hyph > j) break;
+  }
+  int kid= (int) st.size ();
+  lb_state s (st[pos].item, pos, j);
+  if (j < (int) st[pos].rlen.size () && st[pos].rlen[j] >= 0) {
+    s.w  = st[pos].right[j];
+    s.len= st[pos].rlen[j];
+  }
+  st.push_back (s);
+  if (!detached) rest << line_item ();
+  st[pos].kids.insert (st[pos].kids.begin () + k, kid);
+  return kid;
+}
+
+line_item
+line_breaker_rep::get_rest (int pos) {
+  if (is_nil (rest[pos])) {
+    if (st[pos].parent < 0) rest[pos]= a[st[pos].item];
+    else {
+      line_item item1, item2;
+      hyphenate (get_rest (st[pos].parent), st[pos].hyph, item1, item2);
+      rest[pos]= item2;
+    }
+  }
+  return rest[pos];
+}
+
+#define LB_WIDTH   -1
+#define LB_HYPHENS -2
+#define LB_GLYPHS  -3
+
+bool
+line_breaker_rep::want (int pos, int what) {
+  // while detached, remember which data at pos are missing:
+  // the width, the hyphens, the glyphs or the j-th left part (j >= 0)
+  if (!detached) return false;
+  failed= true;
+  wanted.push_back (std::pair<int,int> (pos, what));
+  return true;
+}
+
+bool
+line_breaker_rep::get_width (int pos) {
+  // make sure that the width and the length of the rest are known
+  if (st[pos].len >= 0) return true;
+  if (want (pos, LB_WIDTH)) return false;
+  line_item item= get_rest (pos);
+  st[pos].w  = item->b->w();
+  st[pos].len= (item->type == STRING_ITEM? N(item->b->get_leaf_string ()): 0);
+  return true;
+}
+
+bool
+line_breaker_rep::get_hyphens (int pos) {
+  // make sure that the hyphenation candidates of the rest are known
+  if (st[pos].split) return true;
+  if (want (pos, LB_HYPHENS)) return false;
+  line_item item= get_rest (pos);
+  string s= item->b->get_leaf_string ();
+  array<int> hp= item->lan->get_hyphens (s);
+  lb_state& cur= st[pos];
+  for (int j=0; j<N(hp); j++) {
+    cur.hp   .push_back (hp[j]);
+    cur.left .push_back (-1);
+    cur.right.push_back (0);
+    cur.rlen .push_back (-1);
+  }
+  cur.split= true;
+  return true;
+}
+
+SI
+line_breaker_rep::get_left (int pos, int j) {
+  // width of the part before the j-th hyphen of the line_item at pos
+  // or -1 if it is unknown while detached
+  if (st[pos].left[j] < 0) {
+    if (want (pos, j)) return -1;
+    line_item item1, item2;
+    hyphenate (get_rest (pos), j, item1, item2);
+    st[pos].left [j]= item1->b->w();
+    st[pos].right[j]= item2->b->w();
+    st[pos].rlen [j]= N(item2->b->get_leaf_string ());
+  }
+  return st[pos].left[j];
+}
+
+int
+line_breaker_rep::get_glyph_position (int pos, SI x) {
+  // position of the glyph in the rest at pos which is closest to x
+  // or -1 if the positions of the glyphs are unknown while detached
+  if (st[pos].glyph.size () == 0) {
+    if (want (pos, LB_GLYPHS)) return -1;
+    line_item item= get_rest (pos);
+    string s= item->b->get_leaf_string ();
+    int i=0, n=N(s);
+    STACK_NEW_ARRAY (xpos, SI, n+1);
+    item->b->get_leaf_font ()->get_xpositions (s, xpos);
+    while (i<n) {
+      if (s[i]=='<') {
+	while ((i<n) && (s[i]!='>')) i++;
+	if (i<n) i++;
+      }
+      else i++;
+      st[pos].glyph.push_back (i);
+      st[pos].xpos .push_back (xpos[i]);
+    }
+    STACK_DELETE_ARRAY (xpos);
+  }
+  lb_state& cur= st[pos];
+  int k, n= (int) cur.glyph.size (), prev_i= 0, prev_x= 0;
+  for (k=0; k<n; k++) {
+    int m= (prev_x + cur.xpos[k]) >> 1;
+    if (x<m) return prev_i;
+    prev_i= cur.glyph[k];
+    prev_x= cur.xpos[k];
+  }
+  return prev_i;
+}
+
 /******************************************************************************
 * Test whether we found a better break
 ******************************************************************************/
 
 void
-line_breaker_rep::test_better (path new_pos, path old_pos,
+line_breaker_rep::test_better (int pos, int j, int old_pos,
 			       int pen, PEN pen_spc)
 {
-  if (!best->contains (new_pos)) best (new_pos)= lb_info ();
-  lb_info cur= best [new_pos];
+  int new_pos= get_state (pos, j);
+  lb_state& cur= st[new_pos];
   //cout << "Test " << new_pos << " vs " << old_pos
-  //     << ", " << pen << " vs " << cur->pen
-  //     << ", " << pen_spc << " vs " << cur->pen_spc << "\n";
-  if ((pen < cur->pen) ||
-      ((pen == cur->pen) && (pen_spc < cur->pen_spc))) {
-    cur->prev   = old_pos;
-    cur->pen    = pen;
-    cur->pen_spc= min (pen_spc, (PEN) 1000000000);
+  //     << ", " << pen << " vs " << cur.pen
+  //     << ", " << pen_spc << " vs " << cur.pen_spc << "\n";
+  if ((pen < cur.pen) ||
+      ((pen == cur.pen) && (pen_spc < cur.pen_spc))) {
+    cur.prev   = old_pos;
+    cur.pen    = pen;
+    cur.pen_spc= min (pen_spc, (PEN) 1000000000);
     //cout << "  Better\n";
   }
 }
@@ -278,41 +454,42 @@ line_breaker_rep::test_better (path new_pos, path old_pos,
 inline PEN square (PEN i) { return i*i; }
 
 bool
-line_breaker_rep::propose_break (path new_pos, path old_pos,
-				 int pen, space spc)
+line_breaker_rep::propose_break (int pos, int j, int old_pos, int pen,
+				 SI spc_min, SI spc_def, SI spc_max)
 {
-  lb_info cur= best[old_pos];
-
-  if ((spc->min <= line_width) &&
-      ((spc->max >= line_width) || (new_pos->item==end))) {
-    SI d= max (line_width- spc->def, spc->def- line_width);
-    if (new_pos->item==end) d=0;
-    test_better (new_pos, old_pos, min (HYPH_INVALID, cur->pen + pen),
-		 cur->pen_spc + (cur->pen == HYPH_INVALID?
-                                 ((PEN) 0): square ((PEN) (d / PIXEL))));
+  int     new_item= st[pos].item;
+  int     cur_pen = st[old_pos].pen;
+  PEN     cur_spc = st[old_pos].pen_spc;
+
+  if ((spc_min <= line_width) &&
+      ((spc_max >= line_width) || (new_item==end))) {
+    SI d= max (line_width- spc_def, spc_def- line_width);
+    if (new_item==end) d=0;
+    test_better (pos, j, old_pos, min (HYPH_INVALID, cur_pen + pen),
+		 cur_spc + (cur_pen == HYPH_INVALID?
+                            ((PEN) 0): square ((PEN) (d / PIXEL))));
   }
 
   if (pass==2) {
-    if (spc->max < line_width)
-      test_better (new_pos, old_pos, HYPH_INVALID,
-		   (cur->pen == HYPH_INVALID? cur->pen_spc: ((PEN) 0)) +
-		   square ((PEN) ((line_width - spc->max)/PIXEL)) +
-		   (new_pos->item==old_pos->item?
-		    square ((PEN) (line_width / PIXEL)): ((PEN) 0)));
-    else if (spc->min > large_width)
-      test_better (new_pos, old_pos, HYPH_INVALID,
-		   (cur->pen == HYPH_INVALID? cur->pen_spc: ((PEN) 0)) +
-		   square ((PEN) ((spc->min - line_width) / PIXEL)) +
+    bool same= (new_item == st[old_pos].item);
+    if (spc_max < line_width)
+      test_better (pos, j, old_pos, HYPH_INVALID,
+		   (cur_pen == HYPH_INVALID? cur_spc: ((PEN) 0)) +
+		   square ((PEN) ((line_width - spc_max)/PIXEL)) +
+		   (same? square ((PEN) (line_width / PIXEL)): ((PEN) 0)));
+    else if (spc_min > large_width)
+      test_better (pos, j, old_pos, HYPH_INVALID,
+		   (cur_pen == HYPH_INVALID? cur_spc: ((PEN) 0)) +
+		   square ((PEN) ((spc_min - line_width) / PIXEL)) +
 		   square ((PEN) (4*line_width / PIXEL)));
-    else if (spc->min > line_width)
-      test_better (new_pos, old_pos, HYPH_INVALID,
-		   (cur->pen == HYPH_INVALID? cur->pen_spc: ((PEN) 0)) +
-		   square ((PEN) ((spc->min - line_width) / PIXEL)) +
-		   (new_pos->item==old_pos->item?
-                    square ((PEN) (line_width / PIXEL)): ((PEN) 0)));
+    else if (spc_min > line_width)
+      test_better (pos, j, old_pos, HYPH_INVALID,
+		   (cur_pen == HYPH_INVALID? cur_spc: ((PEN) 0)) +
+		   square ((PEN) ((spc_min - line_width) / PIXEL)) +
+		   (same? square ((PEN) (line_width / PIXEL)): ((PEN) 0)));
   }
 
-  return spc->min > large_width;
+  return spc_min > large_width;
 }
 
 /******************************************************************************
@@ -320,122 +497,182 @@ line_breaker_rep::propose_break (path new_pos, path old_pos,
 ******************************************************************************/
 
 void
-line_breaker_rep::break_string (line_item item, path pos, int i, space spc) {
+line_breaker_rep::break_string (int src, int pos,
+                                SI spc_min, SI spc_def, SI spc_max) {
+  // src is the position at which the hyphenated line_item starts
   int j;
-  string item_s= item->b->get_leaf_string ();
-  array<int> hp= item->lan->get_hyphens (item_s);
-
-  if ((item->b->w() > line_width) || (!is_atom (pos))) {
-    j= get_position (item->b->get_leaf_font (), item_s, line_width- spc->def);
-    for (j= min (j+2, N(hp)-1); j>=0; j--)
-      if (hp[j] < HYPH_INVALID) {
-	line_item item1, item2;
-	hyphenate (item, j, item1, item2);
-	path next= (i==pos->item)? pos * j: path (i, j);
-	space spc_hyph= spc+ space (item1->b->w());
-	if (spc_hyph->min <= line_width) {
-	  propose_break (next, pos, hp[j], spc_hyph->min);
+  if (!get_hyphens (src)) return;
+  int n= (int) st[src].hp.size ();
+
+  if ((st[src].w > line_width) || (st[pos].parent >= 0)) {
+    j= get_glyph_position (src, line_width- spc_def);
+    if (j < 0) return;
+    for (j= min (j+2, n-1); j>=0; j--)
+      if (st[src].hp[j] < HYPH_INVALID) {
+	SI w= get_left (src, j);
+	if (w < 0) continue;
+	if (spc_min + w <= line_width) {
+	  SI m= spc_min + w;
+	  propose_break (src, j, pos, st[src].hp[j], m, m, m);
 	  break;
 	}
       }
   }
   else {
-    for (j=0; j<N(hp); j++)
-      if (hp[j] < HYPH_INVALID) {
-	line_item item1, item2;
-	hyphenate (item, j, item1, item2);
-	path next= (i==pos->item)? pos * j: path (i, j);
-	space spc_hyph= spc+ space (item1->b->w());
-	(void) propose_break (next, pos, hp[j], spc_hyph);
+    for (j=0; j<n; j++)
+      if (st[src].hp[j] < HYPH_INVALID) {
+	SI w= get_left (src, j);
+	if (w < 0) continue;
+	(void) propose_break (src, j, pos, st[src].hp[j],
+			      spc_min + w, spc_def + w, spc_max + w);
       }
   }
 }
 
 void
-line_breaker_rep::process (path pos) {
-  int i;
-  space spc;
-  line_item first;
-
-  first= a[pos->item];
-  if (pos == path (start)) spc= space (first_spc+ first->b->w());
-  else {
-    path p= pos;
-    while (!is_atom (p)) {
-      line_item item1, item2;
-      p= p->next;
-      hyphenate (first, p->item, item1, item2);
-      first= item2;
-    }
-    spc= space (first->b->w());
-  }
-
-  if ((pass>1) || (best[pos]->pen < HYPH_INVALID)) {
-    // cout << "Process " << pos << ": " << first << "\n";
-    for (i=pos->item; i<end; i++) {
-      line_item item= a[i];
-      if (i == pos->item) item= first;
-      else spc= spc+ a[i-1]->spc+ space (item->b->w());
-      if ((spc->max > line_width) &&
-	  (item->type == STRING_ITEM) &&
-	  (N(item->b->get_leaf_string ())>4))
-	break_string (item, pos, i, spc+ space (-item->b->w()));
-      if (item->penalty < HYPH_INVALID)
-	if (propose_break (path (i+1), pos, item->penalty, spc))
+line_breaker_rep::process (int pos) {
+  int i, k, it= st[pos].item;
+  if (!get_width (pos)) return;
+  SI w= st[pos].w;
+  SI base= (pos == start? first_spc + w: w);
+  SI spc_min= base, spc_def= base, spc_max= base;
+
+  if ((pass>1) || (st[pos].pen < HYPH_INVALID)) {
+    // cout << "Process " << get_path (pos) << "\n";
+    for (i=it; i<end; i++) {
+      int src= (i == it? pos: i);
+      if (i != it) {
+	spc_min= base + (SI) (sum_min[i] - sum_min[it]);
+	spc_def= base + (SI) (sum_def[i] - sum_def[it]);
+	spc_max= base + (SI) (sum_max[i] - sum_max[it]);
+      }
+      SI item_w= st[src].w;
+      if ((spc_max > line_width) && (st[src].len > 4)) {
+	break_string (src, pos,
+		      spc_min - item_w, spc_def - item_w, spc_max - item_w);
+      }
+      if (penalty[i] < HYPH_INVALID)
+	if (propose_break (i+1, -1, pos, penalty[i],
+			   spc_min, spc_def, spc_max))
 	  break;
-      if ((item->type == CONTROL_ITEM) &&
-	  (item->t == LINE_BREAK) &&
-	  (spc->min < line_width))
-	if (propose_break (path (i+1), pos, 0, space (line_width)))
+      if (brk[i] && (spc_min < line_width))
+	if (propose_break (i+1, -1, pos, 0,
+			   line_width, line_width, line_width))
 	  break;
     }
     if (i==end) {
       line_width -= last_spc;
-      propose_break (path (i), pos, 0, spc);
+      propose_break (i, -1, pos, 0, spc_min, spc_def, spc_max);
       line_width += last_spc;
     }
   }
 
-  if (first->type == STRING_ITEM) {
-    string first_s= first->b->get_leaf_string ();
-    int n= N(first_s);
-    if (n>4)
-      for (i=0; i<n-1; i++)
-	if (best-> contains (pos * i))
-	  process (pos * i);
-  }
+  int n= st[pos].len;
+  if (n>4)
+    for (k=0; k<(int) st[pos].kids.size (); k++) {
+      int kid= st[pos].kids[k];
+      if (st[kid].hyph < n-1) process (kid);
+    }
 }
 
 /******************************************************************************
-* Hyphenate an array of line_items
+* Optimization of the line breaks
 ******************************************************************************/
 
 void
-line_breaker_rep::get_breaks (array<path>& ap, path p) {
-  if (is_nil (p)) return;
-  lb_info cur= best[p];
-  get_breaks (ap, cur->prev);
-  ap << p;
+line_breaker_rep::prepare () {
+  int i;
+  st     .assign (end+1, lb_state ());
+  penalty.assign (end+1, HYPH_INVALID);
+  brk    .assign (end+1, false);
+  sum_min.assign (end+1, 0);
+  sum_def.assign (end+1, 0);
+  sum_max.assign (end+1, 0);
+  rest= array<line_item> (end+1);
+  for (i=0; i<=end; i++) st[i].item= i;
+  for (i=start; i<end; i++) {
+    line_item item= a[i];
+    st[i].w   = item->b->w();
+    st[i].len = (item->type == STRING_ITEM?
+		 N(item->b->get_leaf_string ()): 0);
+    penalty[i]= item->penalty;
+    brk[i]    = (item->type == CONTROL_ITEM) && (item->t == LINE_BREAK);
+  }
+  st[end].len= 0;
+  for (i=start+1; i<=end; i++) {
+    space spc= a[i-1]->spc;
+    SI w= (i<end? st[i].w: 0);
+    sum_min[i]= sum_min[i-1] + spc->min + w;
+    sum_def[i]= sum_def[i-1] + spc->def + w;
+    sum_max[i]= sum_max[i-1] + spc->max + w;
+  }
 }
 
-array<path>
-line_breaker_rep::compute_breaks () {
+void
+line_breaker_rep::complete () {
+  // After a detached optimization which missed some data,
+  // compute exactly these data and reset the optimization
+  int i, n= (int) st.size ();
+  rest->resize (n);
+  for (i=0; i<(int) wanted.size (); i++) {
+    int pos= wanted[i].first, what= wanted[i].second;
+    if (what == LB_WIDTH) (void) get_width (pos);
+    else if (what == LB_HYPHENS) (void) get_hyphens (pos);
+    else if (what == LB_GLYPHS) (void) get_glyph_position (pos, 0);
+    else (void) get_left (pos, what);
+  }
+  wanted.clear ();
+  for (i=0; i<n; i++) {
+    st[i].prev   = -1;
+    st[i].pen    = HYPH_INVALID;
+    st[i].pen_spc= (PEN) 1000000000;
+  }
+  failed= solved= false;
+}
+
+void
+line_breaker_rep::solve () {
+  // may run on a worker thread; trace points are thread-safe
+  TRACE_SCOPE ("typeset", "line breaking");
+  TRACE_ARG (end - start);
   int i;
-  test_better (path (start), path (), 0, 0);
+  test_better (start, -1, -1, 0, 0);
 
   pass= 1;
   for (i=start; i<end; i++)
-    process (path (i));
+    process (i);
 
   pass= 2;
-  if (best [path (end)]->pen == HYPH_INVALID)
+  if (st[end].pen == HYPH_INVALID && !failed)
     for (i=start; i<end; i++)
-      process (path (i));
+      process (i);
+
+  test_better (end, -1, start, HYPH_INVALID, (PEN) 999999999);
+  solved= true;
+}
+
+/******************************************************************************
+* Hyphenate an array of line_items
+******************************************************************************/
+
+path
+line_breaker_rep::get_path (int pos) {
+  if (st[pos].parent < 0) return path (st[pos].item);
+  return get_path (st[pos].parent) * st[pos].hyph;
+}
 
-  test_better (path (end), path (start), HYPH_INVALID, (PEN) 999999999);
+void
+line_breaker_rep::get_breaks (array<path>& ap, int pos) {
+  if (pos < 0) return;
+  get_breaks (ap, st[pos].prev);
+  ap << get_path (pos);
+}
 
+array<path>
+line_breaker_rep::get_breaks () {
+  int i;
   array<path> ap (0);
-  get_breaks (ap, path (end));
+  get_breaks (ap, end);
 
   // Finish with fix for disallowing last lines with only empty boxes
   if (N(ap) <= 2 || !is_atom (ap[N(ap)-2])) return ap;
@@ -447,6 +684,163 @@ line_breaker_rep::compute_breaks () {
   return ap;
 }
 
+array<path>
+line_breaker_rep::compute_breaks () {
+  prepare ();
+  solve ();
+  return get_breaks ();
+}
+
+/******************************************************************************
+* Breaking several paragraphs on worker threads
+*******************************************************************************
+* When many paragraphs are formatted at once, for instance after a change
+* of the page width, the caller first announces the line breaking problems
+* using line_breaks_request.  line_breaks_prefetch then runs the
+* optimizations on a small pool of worker threads, which only touch the
+* plain C++ data of the solvers.  Only the widths of the line_items are
+* known in advance: the words which an optimization wants to hyphenate
+* are collected, hyphenated and measured on the main thread, after which
+* the optimization is run again.  This is repeated a few times; the
+* words involved are those near the ends of the lines, as in the
+* sequential algorithm.  The results are picked up by line_breaks, which
+* checks that it is asked exactly the same question, and which finishes
+* the optimizations that still missed some data on the main thread.
+******************************************************************************/
+
+#define LB_ROUNDS 16
+
+static hashmap<pointer,pointer> lb_prefetched (NULL);
+static array<pointer> lb_requested;
+
+static SI
+tolerant_width (SI line_width) {
+  // extra tolerance of 5tmpt avoid rounding errors when
+  // the widths of the boxes sum up to precisely 1par
+  return line_width + 5;
+}
+
+int
+line_breaks_threads () {
+#if defined (OS_MINGW) || (defined (X11TEXMACS) && !defined (NO_FAST_ALLOC))
+  // the fast allocator also serves operator new and is not thread-safe
+  return 1;
+#else
+  if (get_user_preference ("parallel line breaking", "on") == "off") return 1;
+  int nr= (int) sysconf (_SC_NPROCESSORS_ONLN);
+  if (nr < 1) nr= 1;
+  if (nr > 8) nr= 8;
+  return nr;
+#endif
+}
+
+void
+line_breaks_request (array<line_item> a, int start, int end,
+		     SI line_width, SI large_width,
+		     SI first_spc, SI last_spc)
+{
+  if (start >= end) return;
+  pointer key= (pointer) a[start].operator -> ();
+  if (lb_prefetched->contains (key)) return;
+  line_breaker_rep* H=
+    tm_new<line_breaker_rep> (a, start, end, tolerant_width (line_width),
+			      large_width, first_spc, last_spc);
+  H->prepare ();
+  lb_prefetched (key)= (pointer) H;
+  lb_requested << (pointer) H;
+}
+
+#ifndef OS_MINGW
+struct lb_pool {
+  std::vector<line_breaker_rep*> jobs;
+  size_t          next;
+  pthread_mutex_t lock;
+};
+
+static void*
+lb_worker (void* arg) {
+  lb_pool* pool= (lb_pool*) arg;
+  while (true) {
+    pthread_mutex_lock (&pool->lock);
+    size_t i= pool->next++;
+    pthread_mutex_unlock (&pool->lock);
+    if (i >= pool->jobs.size ()) break;
+    pool->jobs[i]->solve ();
+  }
+  return NULL;
+}
+#endif
+
+void
+line_breaks_prefetch () {
+  int i, n= N(lb_requested);
+  int nr= min (line_breaks_threads (), n);
+#ifndef OS_MINGW
+  std::vector<line_breaker_rep*> jobs;
+  if (nr > 1)
+    for (i=0; i<n; i++)
+      jobs.push_back ((line_breaker_rep*) lb_requested[i]);
+  for (int round=0; round<LB_ROUNDS && jobs.size () != 0; round++) {
+    lb_pool pool;
+    pool.next= 0;
+    pool.jobs= jobs;
+    for (i=0; i<(int) jobs.size (); i++) jobs[i]->detached= true;
+    pthread_mutex_init (&pool.lock, NULL);
+    std::vector<pthread_t> ids;
+    nr= min (nr, (int) jobs.size ());
+    for (i=1; i<nr; i++) {
+      pthread_t id;
+      if (pthread_create (&id, NULL, lb_worker, (void*) &pool) == 0)
+	ids.push_back (id);
+    }
+    lb_worker ((void*) &pool);
+    for (i=0; i<(int) ids.size (); i++)
+      pthread_join (ids[i], NULL);
+    pthread_mutex_destroy (&pool.lock);
+    jobs.clear ();
+    for (i=0; i<(int) pool.jobs.size (); i++) {
+      line_breaker_rep* H= pool.jobs[i];
+      H->detached= false;
+      if (H->failed) {
+        H->complete ();
+        jobs.push_back (H);
+      }
+    }
+  }
+#endif
+  lb_requested= array<pointer> ();
+}
+
+void
+line_breaks_forget () {
+  iterator<pointer> it= iterate (lb_prefetched);
+  while (it->busy ())
+    tm_delete ((line_breaker_rep*) lb_prefetched [it->next ()]);
+  lb_prefetched= hashmap<pointer,pointer> (NULL);
+  lb_requested = array<pointer> ();
+}
+
+static line_breaker_rep*
+line_breaks_prefetched (array<line_item> a, int start, int end,
+			SI line_width, SI large_width,
+			SI first_spc, SI last_spc)
+{
+  if (N(lb_prefetched) == 0 || start >= end) return NULL;
+  pointer key= (pointer) a[start].operator -> ();
+  if (!lb_prefetched->contains (key)) return NULL;
+  line_breaker_rep* H= (line_breaker_rep*) lb_prefetched [key];
+  lb_prefetched->reset (key);
+  bool ok=
+    H->end - H->start == end - start &&
+    H->line_width == line_width && H->large_width == large_width &&
+    H->first_spc == first_spc && H->last_spc == last_spc;
+  for (int i=0; ok && i < end - start; i++)
+    ok= (H->a[H->start + i].operator -> () == a[start + i].operator -> ());
+  if (ok) return H;
+  tm_delete (H);
+  return NULL;
+}
+
 /******************************************************************************
 * The exported line breaking routine
 *******************************************************************************
@@ -463,11 +857,19 @@ line_breaks (array<line_item> a, int start, int end,
 	     SI line_width, SI large_width,
              SI first_spc, SI last_spc, bool ragged)
 {
-  int tol= 5;         // extra tolerance of 5tmpt avoid rounding errors when
-  line_width += tol;  // the widths of the boxes sum up to precisely 1par
-  line_breaker_rep* H=
-    tm_new<line_breaker_rep> (a, start, end, line_width, large_width,
-                              first_spc, last_spc);
+  line_width= tolerant_width (line_width);
+  line_breaker_rep* H= NULL;
+  if (!ragged)
+    H= line_breaks_prefetched (a, start, end, line_width, large_width,
+			       first_spc, last_spc);
+  if (H != NULL) {
+    if (!H->solved) H->solve ();
+    array<path> ap= H->get_breaks ();
+    tm_delete (H);
+    return ap;
+  }
+  H= tm_new<line_breaker_rep> (a, start, end, line_width, large_width,
+			       first_spc, last_spc);
   array<path> ap= ragged? H->compute_ragged_breaks (): H->compute_breaks ();
   tm_delete (H);
   return ap;
@@ -31,6 +31,7 @@
 #define TEXT_BOX      5
 #define SHORTER_BOX   6
 #define BIG_OP_BOX    7
+#define PAGE_BORDER_BOX 8
 
 class player;
 
@@ -103,6 +104,8 @@ tree as_tree (gr_selections sels);
 ******************************************************************************/
 
 class box_rep;
+class box;
+template<> struct relocatable<box> { static const bool value= true; };
 struct lazy;
 typedef array<double> point;
 
@@ -266,6 +269,7 @@ public:
   friend struct effect_box_rep;
   friend void make_eps (url dest, box b, int dpi);
   friend void make_raster_image (url dest, box b, double zoom);
+  friend picture make_raster_picture (box b, double zoom);
 };
 ABSTRACT_NULL_CODE(box);
 
@@ -296,6 +300,7 @@ SI   get_delta (SI x, SI x1, SI x2);
 bool outside (SI x, SI delta, SI x1, SI x2);
 void make_eps (url dest, box b, int dpi= 600);
 void make_raster_image (url dest, box b, double zoom);
+picture make_raster_picture (box b, double zoom);
 path find_innermost_scroll (box b, path p);
 path find_scrolled_tree_path (box b, path sp, SI x, SI y, SI delta);
 void find_canvas_info (box b, path sp, SI& x, SI& y, SI& sx, SI& sy,
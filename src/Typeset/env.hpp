@@ -119,6 +119,45 @@
 #define INFO_PAPER         4
 #define INFO_SHORT_PAPER   5
 
+/******************************************************************************
+* Compiled macros
+*******************************************************************************
+* When exec expands a macro, its arguments are stored in an array instead
+* of a hashmap.  The arg references in the body of the macro are resolved
+* to argument positions when the macro is expanded for the first time after
+* its (re)definition.  On the stack macro_arg of the environment, the frames
+* of such macros are represented by a shared empty hashmap and their actual
+* arguments are found on the stack macro_pos.  Such frames only exist during
+* calls of exec, so the typesetter never encounters them.
+******************************************************************************/
+
+struct compiled_macro_rep: concrete_struct {
+  tree                 def;   // the compiled macro
+  array<string>        var;   // the names of the arguments
+  hashmap<pointer,int> slot;  // the positions of arguments of arg references
+  inline compiled_macro_rep (tree def2): def (def2), slot (-1) {}
+};
+
+struct compiled_macro {
+  CONCRETE_NULL(compiled_macro);
+  inline compiled_macro (tree def):
+    rep (tm_new<compiled_macro_rep> (def)) {}
+};
+CONCRETE_NULL_CODE(compiled_macro);
+
+struct macro_frame_rep: concrete_struct {
+  compiled_macro mac;   // the macro being expanded
+  array<tree>    arg;   // its arguments
+  inline macro_frame_rep (compiled_macro mac2, int n): mac (mac2), arg (n) {}
+};
+
+struct macro_frame {
+  CONCRETE(macro_frame);
+  inline macro_frame (compiled_macro mac, int n):
+    rep (tm_new<macro_frame_rep> (mac, n)) {}
+};
+CONCRETE_CODE(macro_frame);
+
 /******************************************************************************
 * The edit environment
 ******************************************************************************/
@@ -136,6 +175,8 @@ public:
   hashmap<string,path>         src;
   list<hashmap<string,tree> >  macro_arg;
   list<hashmap<string,path> >  macro_src;
+  list<macro_frame>            macro_pos;   // frames of compiled macros
+  hashmap<string,compiled_macro> macro_bin; // compiled macros
   array<box>                   decorated_boxes;
 
   hashmap<string,int>&         var_type;
@@ -150,6 +191,7 @@ public:
   hashmap<string,tree>&        global_att;
   bool                         complete;    // typeset complete document ?
   bool                         read_only;   // write-protected ?
+  bool                         printed_dep; // layout depends on page-printed ?
   hashmap<string,tree>         missing;     // missing refs
   array<tree>                  redefined;   // redefined labels
   hashmap<string,bool>         touched;     // touched refs
@@ -410,6 +452,10 @@ private:
   tree exec_frame_direct (tree t);
   tree exec_frame_inverse (tree t);
 
+  bool in_compiled_macro ();
+  int  compiled_slot (tree ref);
+  compiled_macro compile_macro (string var, tree f);
+
   tree exec_rewrite (tree t);
   bool exec_until_rewrite (tree t, path p, string var, int level);
   tree rewrite_inactive_arg (tree t, tree var, int i, bool bl, bool fl);
@@ -443,6 +489,8 @@ public:
   void   exec_until (tree t, path p);
   bool   exec_until (tree t, path p, string var, int level);
   string exec_string (tree t);        /* should be inline */
+  bool   has_macro_arg (string var);
+  tree   get_macro_arg (string var);
   tree   expand (tree t, bool search_accessible= false);
   bool   depends (tree t, string s, int level);
   tree   rewrite (tree t);
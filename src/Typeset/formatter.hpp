@@ -84,6 +84,9 @@ struct lazy_rep: public abstract_struct {
     // before production of a lazy structure of type 'request'
   virtual void propagate ();
     // hack to propagate environment properties such as 'no_indent_after'
+  virtual void prepare (lazy_type request, format fm);
+    // announce a forthcoming production of type 'request' using 'fm',
+    // so that part of the work can be done in advance
 };
 
 struct lazy {
@@ -0,0 +1,110 @@
+
+/******************************************************************************
+* MODULE     : new_style_test.cpp
+* DESCRIPTION: Tests for the persistent cache of style environments
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "new_style.hpp"
+#include "new_buffer.hpp"
+#include "file.hpp"
+#include "sys_utils.hpp"
+
+static url  cache_dir;
+static url  package;
+static url  cache_entry;
+static tree style= tuple ("cache-test");
+
+static hashmap<string,tree>
+sample_env () {
+  hashmap<string,tree> H (UNINIT);
+  H ("cache-test-var")= "1";
+  return H;
+}
+
+static void
+restart (string saved) {
+  // forget the caches in memory, as in a new session, but keep the entry
+  style_invalidate_cache ();
+  QVERIFY (!save_string (cache_entry, saved));
+}
+
+class TestNewStyle: public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase ();
+  void test_reuse ();
+  void test_invalidate ();
+  void test_no_dependencies ();
+};
+
+void
+TestNewStyle::initTestCase () {
+  url dir= url_temp ("");
+  mkdir (dir);
+  set_env ("TEXMACS_HOME_PATH", as_string (dir));
+  set_env ("TEXMACS_STYLE_PATH", as_string (dir));
+  cache_dir= dir * "system" * "cache";
+  mkdir (dir * "system");
+  mkdir (cache_dir);
+  package= dir * "cache-test.ts";
+  cache_entry= cache_dir * "__cache-test__";
+}
+
+void
+TestNewStyle::test_reuse () {
+  QVERIFY (!save_string (package, "<assign|cache-test-var|1>"));
+  style_invalidate_cache ();
+  tree deps= tuple (tuple ("cache-test", style_package_hash ("cache-test")));
+  style_set_cache (style, sample_env (), tree (COLLECTION), deps);
+  string saved;
+  QVERIFY (!load_string (cache_entry, saved, false));
+
+  restart (saved);
+  hashmap<string,tree> H;
+  tree t;
+  bool ok;
+  style_get_cache (style, H, t, ok);
+  QVERIFY (ok);
+  QVERIFY (H ["cache-test-var"] == "1");
+}
+
+void
+TestNewStyle::test_invalidate () {
+  QVERIFY (!save_string (package, "<assign|cache-test-var|1>"));
+  style_invalidate_cache ();
+  tree deps= tuple (tuple ("cache-test", style_package_hash ("cache-test")));
+  style_set_cache (style, sample_env (), tree (COLLECTION), deps);
+  string saved;
+  QVERIFY (!load_string (cache_entry, saved, false));
+
+  // a modification of the package, which keeps its length
+  QVERIFY (!save_string (package, "<assign|cache-test-var|2>"));
+  restart (saved);
+  hashmap<string,tree> H;
+  tree t;
+  bool ok;
+  style_get_cache (style, H, t, ok);
+  QVERIFY (!ok);
+}
+
+void
+TestNewStyle::test_no_dependencies () {
+  style_invalidate_cache ();
+  style_set_cache (style, sample_env (), tree (COLLECTION), tree (TUPLE));
+  QVERIFY (!exists (cache_entry));
+  hashmap<string,tree> H;
+  tree t;
+  bool ok;
+  style_get_cache (style, H, t, ok);
+  QVERIFY (!ok);
+}
+
+QTEST_MAIN(TestNewStyle)
+#include "new_style_test.moc"
@@ -0,0 +1,74 @@
+
+/******************************************************************************
+* MODULE     : drd_info_test.cpp
+* DESCRIPTION: Tests for data relation descriptions
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "drd_info.hpp"
+
+class TestDrdInfo: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_set_get ();
+  void test_derived ();
+  void test_extern ();
+  void test_freeze ();
+};
+
+void
+TestDrdInfo::test_set_get () {
+  drd_info drd ("test");
+  QCOMPARE (drd->get_type (CONCAT), TYPE_REGULAR);
+  drd->set_type (CONCAT, TYPE_BOOLEAN);
+  QCOMPARE (drd->get_type (CONCAT), TYPE_BOOLEAN);
+  drd->set_type (CONCAT, TYPE_INTEGER);
+  QCOMPARE (drd->get_type (CONCAT), TYPE_INTEGER);
+}
+
+void
+TestDrdInfo::test_derived () {
+  drd_info base ("base");
+  base->set_type (WITH, TYPE_BOOLEAN);
+  drd_info derived ("derived", base);
+  QCOMPARE (derived->get_type (WITH), TYPE_BOOLEAN);
+  base->set_type (WITH, TYPE_INTEGER);
+  QCOMPARE (derived->get_type (WITH), TYPE_INTEGER);
+  derived->set_type (WITH, TYPE_STRING);
+  QCOMPARE (derived->get_type (WITH), TYPE_STRING);
+  QCOMPARE (base->get_type (WITH), TYPE_INTEGER);
+}
+
+void
+TestDrdInfo::test_extern () {
+  drd_info drd ("extern");
+  tree t (EXTERN, "drd-info-test", "x");
+  drd->set_type (EXTERN, TYPE_BOOLEAN);
+  QCOMPARE ((int) drd->lookup (t)->pi.type, TYPE_BOOLEAN);
+  QVERIFY (drd->contains ("extern:drd-info-test"));
+}
+
+void
+TestDrdInfo::test_freeze () {
+  drd_info base ("base");
+  base->freeze_type (CONCAT);
+  base->set_type (CONCAT, TYPE_BOOLEAN);
+  QCOMPARE (base->get_type (CONCAT), TYPE_REGULAR);
+  drd_info derived ("derived", base);
+  derived->freeze_type (CONCAT);
+  derived->set_type (CONCAT, TYPE_BOOLEAN);
+  QCOMPARE (derived->get_type (CONCAT), TYPE_REGULAR);
+  base= drd_info ("other");
+  derived->set_type (WITH, TYPE_STRING);
+  QCOMPARE (derived->get_type (WITH), TYPE_STRING);
+  QCOMPARE (derived->get_type (CONCAT), TYPE_REGULAR);
+}
+
+QTEST_MAIN(TestDrdInfo)
+#include "drd_info_test.moc"
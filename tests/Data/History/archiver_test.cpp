@@ -0,0 +1,110 @@
+
+/******************************************************************************
+* MODULE     : archiver_test.cpp
+* DESCRIPTION: Tests for undo and redo through the compacted history
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "archiver.hpp"
+#include "boot.hpp"
+
+extern tree the_et;
+
+static string
+noise (int i) {
+  // hardly compressible text, so that the history exceeds the memory limit
+  unsigned int x= 2654435761u * (i + 1);
+  string s (4096);
+  for (int j=0; j<N(s); j++) {
+    x= x * 1103515245u + 12345u;
+    s[j]= (char) ('a' + ((x >> 16) % 26));
+  }
+  return s;
+}
+
+static void
+modify (int from, int to) {
+  for (int i=from; i<to; i++) {
+    insert (path (0, i), tree (DOCUMENT, noise (i)));
+    global_confirm ();
+  }
+}
+
+static int
+undo_all (archiver arch, int n= -1) {
+  int nr= 0;
+  while (nr != n && arch->undo_possibilities () != 0) {
+    arch->undo (0);
+    nr++;
+  }
+  return nr;
+}
+
+static int
+redo_all (archiver arch, int n= -1) {
+  int nr= 0;
+  while (nr != n && arch->redo_possibilities () != 0) {
+    arch->redo (0);
+    nr++;
+  }
+  return nr;
+}
+
+class TestArchiver: public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase ();
+  void test_undo_redo ();
+};
+
+void
+TestArchiver::initTestCase () {
+  the_et= tuple ();
+  the_et->obs= ip_observer (path ());
+  set_user_preference ("undo memory limit", "1");
+  set_author (new_author ());
+}
+
+void
+TestArchiver::test_undo_redo () {
+  insert (path (0), tuple (tree (DOCUMENT)));
+  tree empty= copy (subtree (the_et, path (0)));
+  archiver arch (get_author (), path (0));
+
+  // about 2.4 megabytes of history, so that part of it is spilled to disk
+  modify (0, 600);
+  tree full= copy (subtree (the_et, path (0)));
+  QCOMPARE (N(full), 600);
+
+  for (int round=0; round<2; round++) {
+    QCOMPARE (undo_all (arch), 600);
+    QVERIFY (subtree (the_et, path (0)) == empty);
+    QCOMPARE (redo_all (arch), 600);
+    QVERIFY (subtree (the_et, path (0)) == full);
+  }
+
+  // partial undo and redo around the boundary of the spilled segments
+  QCOMPARE (undo_all (arch, 450), 450);
+  QCOMPARE (redo_all (arch, 200), 200);
+  QCOMPARE (undo_all (arch, 100), 100);
+  QVERIFY (subtree (the_et, path (0)) == full (0, 250));
+  QCOMPARE (redo_all (arch), 350);
+  QVERIFY (subtree (the_et, path (0)) == full);
+
+  // spill again on top of segments which have already been read back
+  modify (600, 900);
+  tree more= copy (subtree (the_et, path (0)));
+  QCOMPARE (undo_all (arch), 900);
+  QVERIFY (subtree (the_et, path (0)) == empty);
+  QCOMPARE (redo_all (arch), 900);
+  QVERIFY (subtree (the_et, path (0)) == more);
+}
+
+QTEST_MAIN(TestArchiver)
+#include "archiver_test.moc"
@@ -0,0 +1,87 @@
+
+/******************************************************************************
+* MODULE     : history_store_test.cpp
+* DESCRIPTION: Tests for the compact storage of the undo history
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "history_store.hpp"
+
+static patch
+sample_patch (int i) {
+  tree t (CONCAT, "Some inserted text ", as_string (i), tree (WITH, "a", "b"));
+  modification m= mod_insert (path (0, 1), i, t);
+  modification inv= mod_remove (path (0, 1), i, N(t));
+  patch p1 (m, inv);
+  patch p2 (mod_assign (path (0, 2, 3), "x"), mod_assign (path (0, 2, 3), "y"));
+  patch p3 (1.5, true);
+  return patch (2.5, patch (p1, patch (p2, p3)));
+}
+
+class TestHistoryStore: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_encode_patch ();
+  void test_compress_bytes ();
+  void test_push_pop ();
+  void test_limit ();
+};
+
+void
+TestHistoryStore::test_encode_patch () {
+  patch p= sample_patch (3);
+  QVERIFY (decode_patch (encode_patch (p)) == p);
+  array<patch> a;
+  a << sample_patch (1) << sample_patch (2);
+  patch q (true, a);
+  QVERIFY (decode_patch (encode_patch (q)) == q);
+}
+
+void
+TestHistoryStore::test_compress_bytes () {
+  QVERIFY (decompress_bytes (compress_bytes ("")) == "");
+  QVERIFY (decompress_bytes (compress_bytes ("abc")) == "abc");
+  string s;
+  for (int i=0; i<1000; i++) s << "repeated text " << as_string (i % 7);
+  string c= compress_bytes (s);
+  QVERIFY (N(c) < N(s) / 4);
+  QVERIFY (decompress_bytes (c) == s);
+}
+
+void
+TestHistoryStore::test_push_pop () {
+  history_store store;
+  QVERIFY (store->is_empty ());
+  for (int i=0; i<10; i++) store->push (sample_patch (i));
+  QVERIFY (!store->is_empty ());
+  for (int i=9; i>=0; i--)
+    QVERIFY (store->pop () == sample_patch (i));
+  QVERIFY (store->is_empty ());
+}
+
+void
+TestHistoryStore::test_limit () {
+  history_store store;
+  for (int i=0; i<200; i++) store->push (sample_patch (i));
+  store->limit (4096);
+  QVERIFY (store->disk_segments () > 0);
+  QVERIFY (store->memory_size () <= 4096);
+  int spilled= store->disk_segments ();
+  for (int i=200; i<400; i++) store->push (sample_patch (i));
+  store->limit (4096);
+  QVERIFY (store->disk_segments () > spilled);
+  QVERIFY (store->memory_size () <= 4096);
+  for (int i=399; i>=0; i--)
+    QVERIFY (store->pop () == sample_patch (i));
+  QVERIFY (store->is_empty ());
+  QCOMPARE (store->disk_segments (), 0);
+}
+
+QTEST_MAIN(TestHistoryStore)
+#include "history_store_test.moc"
@@ -30,6 +30,10 @@ private slots:
   void test_starts ();
   void test_ends ();
   void test_read_word ();
+  void test_search_forwards ();
+  void test_search_backwards ();
+  void test_replace ();
+  void test_tokenize ();
 };
 
 void
@@ -139,5 +143,53 @@ TestAnalyze::test_read_word () {
   QCOMPARE (i, 0);
 }
 
+void
+TestAnalyze::test_search_forwards () {
+  string s= "the quick brown fox jumps over the lazy dog, the end";
+  QCOMPARE (search_forwards ("the", s), 0);
+  QCOMPARE (search_forwards ("the", 1, s), 31);
+  QCOMPARE (search_forwards ("the", 32, s), 45);
+  QCOMPARE (search_forwards ("end", s) == N(s) - 3, true);
+  QCOMPARE (search_forwards ("cat", s), -1);
+  QCOMPARE (search_forwards ("", 7, s), 7);
+  QCOMPARE (search_forwards ("x", s), 18);
+  QCOMPARE (search_forwards (array<string> ("lazy", "fox"), 0, s), 16);
+  QCOMPARE (search_forwards (array<string> ("cat", "mouse"), 0, s), -1);
+  QVERIFY (occurs ("dog", s));
+  QVERIFY (!occurs ("dogs", s));
+  QCOMPARE (count_occurrences ("the", s), 3);
+}
+
+void
+TestAnalyze::test_search_backwards () {
+  string s= "the quick brown fox jumps over the lazy dog, the end";
+  QCOMPARE (search_backwards ("the", s), 45);
+  QCOMPARE (search_backwards ("the", 44, s), 31);
+  QCOMPARE (search_backwards ("the", 30, s), 0);
+  QCOMPARE (search_backwards ("cat", s), -1);
+  QCOMPARE (search_backwards ("t", s), 45);
+}
+
+void
+TestAnalyze::test_replace () {
+  QCOMPARE (as_charp (replace ("a-b-c", "-", "+")), "a+b+c");
+  QCOMPARE (as_charp (replace ("aaaa", "aa", "b")), "bb");
+  QCOMPARE (as_charp (replace ("abc", "x", "y")), "abc");
+  QCOMPARE (as_charp (replace ("", "x", "y")), "");
+  QCOMPARE (as_charp (replace ("abc", "", "y")), "abc");
+}
+
+void
+TestAnalyze::test_tokenize () {
+  array<string> a= tokenize ("a, b,, c", ",");
+  QCOMPARE (N(a) == 4, true);
+  QCOMPARE (as_charp (a[0]), "a");
+  QCOMPARE (as_charp (a[1]), " b");
+  QCOMPARE (as_charp (a[2]), "");
+  QCOMPARE (as_charp (a[3]), " c");
+  QCOMPARE (N(tokenize ("", ",")) == 1, true);
+  QCOMPARE (N(tokenize ("a::b", "::")) == 2, true);
+}
+
 QTEST_MAIN(TestAnalyze)
 #include "analyze_test.moc"
@@ -17,12 +17,22 @@ class TestConverter: public QObject {
 
 private slots:
   void test_utf8_to_cork();
+  void test_cork_to_utf8();
 };
 
 void TestConverter::test_utf8_to_cork() {
   QCOMPARE (as_charp (utf8_to_cork ("中")), "<#4E2D>");
   QCOMPARE (as_charp (utf8_to_cork ("“")), "\x10");
   QCOMPARE (as_charp (utf8_to_cork("”")), "\x11");
+  QCOMPARE (as_charp (utf8_to_cork ("plain ascii text of some length, “中”")),
+            "plain ascii text of some length, \x10<#4E2D>\x11");
+}
+
+void TestConverter::test_cork_to_utf8() {
+  QCOMPARE (as_charp (cork_to_utf8 ("<#4E2D>")), "中");
+  QCOMPARE (as_charp (cork_to_utf8 ("\x10quoted\x11")), "“quoted”");
+  QCOMPARE (as_charp (cork_to_utf8 ("a long run of ascii text <#4E2D> and more")),
+            "a long run of ascii text 中 and more");
 }
 
 QTEST_MAIN(TestConverter)
@@ -0,0 +1,112 @@
+
+/******************************************************************************
+* MODULE     : glyph_shrink_test.cpp
+* DESCRIPTION: Tests for shrinking glyphs
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "bitmap_font.hpp"
+
+glyph shrink (glyph gl, int xfactor, int yfactor,
+              int dx, int dy, int tx, int ty, SI& xo, SI& yo);
+
+static glyph
+sample_glyph (int c) {
+  int w= 1 + (c * 7) % 61, h= 1 + (c * 11) % 53;
+  glyph gl (w, h, c % 5 - 2, (c * 3) % (h + 1));
+  for (int j=0; j<h; j++)
+    for (int i=0; i<w; i++)
+      if (((i * 13 + j * 29 + c * 7) % 37) < 15 + c % 10 ||
+          (i > w/3 && i < w/2))
+        gl->set_1 (i, j, 1);
+  return gl;
+}
+
+static int
+floor_div (int a, int b) {
+  return a >= 0? a / b: -((b - 1 - a) / b);
+}
+
+static glyph
+reference_shrink (glyph gl, int f, int dx, int dy, int tx, int ty) {
+  // straightforward pixel by pixel box filter over the dilated glyph
+  int X1= floor_div (dx - gl->xoff, f);
+  int X2= floor_div (dx - gl->xoff + gl->width + tx + f - 1, f);
+  int Y1= floor_div (dy + gl->yoff + 1 - gl->height, f);
+  int Y2= floor_div (dy + gl->yoff + 1 + ty + f - 1, f);
+  int nr= f * f, depth= 1;
+  while ((1 << (depth - 1)) < nr && depth < 8) depth++;
+  glyph r (X2 - X1, Y2 - Y1, -X1, Y2 - 1, depth);
+  for (int Y=Y1; Y<Y2; Y++)
+    for (int X=X1; X<X2; X++) {
+      int sum= 0;
+      for (int y=Y*f; y<(Y+1)*f; y++)
+        for (int x=X*f; x<(X+1)*f; x++) {
+          bool on= false;
+          for (int j=0; j<=ty && !on; j++)
+            for (int i=0; i<=tx && !on; i++) {
+              int gx= x - i - dx + gl->xoff, gy= dy + gl->yoff - (y - j);
+              on= gl->get_x (gx, gy) != 0;
+            }
+          if (on) sum++;
+        }
+      if (nr >= 64) sum= (64 * sum) / nr;
+      r->set (X, Y, sum);
+    }
+  return r;
+}
+
+class TestGlyphShrink: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_box_filter ();
+  void test_large_factor ();
+  void test_unaligned_rows ();
+};
+
+static void
+compare_shrink (glyph gl, int f, int dx, int dy, int tx, int ty) {
+  SI xo, yo;
+  glyph r= shrink (gl, f, f, dx, dy, tx, ty, xo, yo);
+  glyph e= reference_shrink (gl, f, dx, dy, tx, ty);
+  QCOMPARE (r->width, e->width);
+  QCOMPARE (r->height, e->height);
+  QCOMPARE (r->xoff, e->xoff);
+  QCOMPARE (r->yoff, e->yoff);
+  for (int j=0; j<r->height; j++)
+    for (int i=0; i<r->width; i++)
+      QCOMPARE (r->get_x (i, j), e->get_x (i, j));
+}
+
+void
+TestGlyphShrink::test_box_filter () {
+  for (int c=0; c<40; c++)
+    for (int f=1; f<=5; f++)
+      compare_shrink (sample_glyph (c), f, c % f, (c / 2) % f, c % 3, c % 2);
+}
+
+void
+TestGlyphShrink::test_large_factor () {
+  for (int c=0; c<10; c++)
+    compare_shrink (sample_glyph (c), 9, c % 9, 0, 3, 3);
+}
+
+void
+TestGlyphShrink::test_unaligned_rows () {
+  // rows of odd width do not start at byte boundaries of the raster
+  glyph gl (13, 9, 0, 8);
+  for (int j=0; j<9; j++)
+    for (int i=0; i<13; i++)
+      if ((i + j) % 3 != 0) gl->set_1 (i, j, 1);
+  for (int f=2; f<=4; f++)
+    compare_shrink (gl, f, 1, 1, 1, 1);
+}
+
+QTEST_MAIN(TestGlyphShrink)
+#include "glyph_shrink_test.moc"
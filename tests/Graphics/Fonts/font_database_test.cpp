@@ -0,0 +1,99 @@
+
+/******************************************************************************
+* MODULE     : font_database_test.cpp
+* DESCRIPTION: Tests for the incremental building of the font database
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "font.hpp"
+#include "file.hpp"
+
+static hashmap<string,bool>
+referenced (url u, tree stamp) {
+  hashmap<string,bool> r (false);
+  r (as_string (tail (u)) * ":" * as_string (stamp[0]))= true;
+  return r;
+}
+
+class TestFontDatabase: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_stamp ();
+  void test_up_to_date ();
+  void test_rescan ();
+  void test_unnamed ();
+};
+
+void
+TestFontDatabase::test_stamp () {
+  url u= url_temp (".ttf");
+  QVERIFY (!save_string (u, "0123456789"));
+  tree s1= font_file_stamp (u);
+  QVERIFY (is_tuple (s1) && N(s1) == 2);
+  QCOMPARE (as_string (s1[0]), string ("10"));
+  QVERIFY (font_file_stamp (u) == s1);
+  QVERIFY (!save_string (u, "0123456789abcdef"));
+  QVERIFY (font_file_stamp (u) != s1);
+  remove (u);
+}
+
+void
+TestFontDatabase::test_up_to_date () {
+  url u= url_temp (".ttf");
+  QVERIFY (!save_string (u, "0123456789"));
+  tree stamp= font_file_stamp (u);
+  hashmap<tree,tree> stamps (UNINIT);
+  stamps (as_string (u))= stamp;
+  QVERIFY (!font_file_outdated (u, stamp, stamps, referenced (u, stamp)));
+  remove (u);
+}
+
+void
+TestFontDatabase::test_rescan () {
+  url u= url_temp (".ttf");
+  QVERIFY (!save_string (u, "0123456789"));
+  tree stamp= font_file_stamp (u);
+  hashmap<tree,tree> stamps (UNINIT);
+  stamps (as_string (u))= stamp;
+
+  // new files
+  hashmap<tree,tree> none (UNINIT);
+  QVERIFY (font_file_outdated (u, stamp, none, referenced (u, stamp)));
+
+  // files which no longer occur in the database
+  hashmap<string,bool> unused (false);
+  QVERIFY (font_file_outdated (u, stamp, stamps, unused));
+
+  // modified files
+  QVERIFY (!save_string (u, "0123456789abcdef"));
+  tree changed= font_file_stamp (u);
+  QVERIFY (font_file_outdated (u, changed, stamps, referenced (u, stamp)));
+  QVERIFY (font_file_outdated (u, changed, stamps, referenced (u, changed)));
+  remove (u);
+}
+
+void
+TestFontDatabase::test_unnamed () {
+  // files without font names are never referenced by the database
+  url u= url_temp (".ttf");
+  QVERIFY (!save_string (u, "0123456789"));
+  tree stamp= font_file_stamp (u);
+  hashmap<tree,tree> stamps (UNINIT);
+  stamps (as_string (u))= tuple (stamp[0], stamp[1], "unnamed");
+  hashmap<string,bool> unused (false);
+  QVERIFY (!font_file_outdated (u, stamp, stamps, unused));
+
+  QVERIFY (!save_string (u, "0123456789abcdef"));
+  tree changed= font_file_stamp (u);
+  QVERIFY (font_file_outdated (u, changed, stamps, unused));
+  remove (u);
+}
+
+QTEST_MAIN(TestFontDatabase)
+#include "font_database_test.moc"
@@ -40,6 +40,7 @@ private slots:
   void test_append ();
   void test_reverse ();
   void test_contains ();
+  void test_capacity ();
 };
 
 void
@@ -78,15 +79,15 @@ TestArray::test_range () {
 
 void
 TestArray::test_size () {
-  QCOMPARE (N (zero_elem), 0);
-  QCOMPARE (N (one_elem), 1);
-  QCOMPARE (N (two_elem), 2);
-  QCOMPARE (N (three_elem), 3);
-  QCOMPARE (N (four_elem), 4);
-  QCOMPARE (N (five_elem), 5);
+  QCOMPARE (N (zero_elem) == 0, true);
+  QCOMPARE (N (one_elem) == 1, true);
+  QCOMPARE (N (two_elem) == 2, true);
+  QCOMPARE (N (three_elem) == 3, true);
+  QCOMPARE (N (four_elem) == 4, true);
+  QCOMPARE (N (five_elem) == 5, true);
   for (auto i=6; i<200; i++){
     auto array_test= gen_array (i);
-    QCOMPARE ( N (array_test), i);
+    QCOMPARE (N (array_test) == i, true);
   }
 }
 
@@ -135,5 +136,27 @@ TestArray::test_contains() {
   QCOMPARE (contains (3, five_elem), true);
 }
 
+void
+TestArray::test_capacity () {
+  auto a= gen_array (100);
+  QVERIFY (a->capacity () >= 100);
+  a->resize (3);
+  a->shrink ();
+  QCOMPARE (a->capacity () == 3, true);
+  QCOMPARE (a, three_elem);
+  a->reserve (50);
+  QCOMPARE (a->capacity () == 50, true);
+  for (auto i=4; i<=50; i++) a << i;
+  QCOMPARE (a->capacity () == 50, true);
+  QCOMPARE (a, gen_array (50));
+
+  auto b= array<string> ();
+  for (auto i=0; i<100; i++) b << as_string (i);
+  b->resize (2);
+  QCOMPARE (b, array<string> ("0", "1"));
+  b->resize (0);
+  QCOMPARE (b->capacity () == 0, true);
+}
+
 QTEST_MAIN(TestArray)
 #include "array_test.moc"
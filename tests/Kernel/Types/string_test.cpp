@@ -22,6 +22,8 @@ private slots:
   void slice ();
   void concat ();
   void append ();
+  void capacity ();
+  void bench_small_strings ();
 
   void test_as_bool ();
   void test_as_string_bool ();
@@ -96,6 +98,34 @@ TestString::append () {
   QVERIFY (str == string("xyz"));
 }
 
+void
+TestString::capacity () {
+  string str;
+  for (int i=0; i<1000; i++) str << 'x';
+  QVERIFY (str->capacity () >= 1000);
+  str->resize (3);
+  str->shrink ();
+  QCOMPARE (str->capacity () == 3, true);
+  QVERIFY (str == string("xxx"));
+  str->reserve (10);
+  str << string("abcdefg");
+  QCOMPARE (str->capacity () == 10, true);
+  QVERIFY (str == string("xxxabcdefg"));
+}
+
+void
+TestString::bench_small_strings () {
+  int total= 0;
+  QBENCHMARK {
+    for (int i=0; i<1000; i++) {
+      string s ("mode");
+      s << '-' << string ("math");
+      if (s == "mode-math") total += N(s);
+    }
+  }
+  QVERIFY (total > 0);
+}
+
 /******************************************************************************
 * Conversions
 ******************************************************************************/
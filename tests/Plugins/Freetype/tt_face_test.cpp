@@ -0,0 +1,86 @@
+
+/******************************************************************************
+* MODULE     : tt_face_test.cpp
+* DESCRIPTION: Tests for the tables of True Type metrics and glyphs
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "config.h"
+#include "Freetype/tt_face.hpp"
+
+class TestTtFace: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_table_unicode ();
+  void test_table_indices ();
+  void test_table_far_codes ();
+  void test_table_metrics ();
+};
+
+void
+TestTtFace::test_table_unicode () {
+  tt_table<int> t;
+  QVERIFY (!t.contains (65));
+  QVERIFY (t.page (65) == NULL);
+  t (65)= 7;
+  t (0x10FFFF)= 9;
+  QVERIFY (t.contains (65));
+  QVERIFY (!t.contains (66));
+  QVERIFY (t.contains (0x10FFFF));
+  QCOMPARE (t [65], 7);
+  QCOMPARE (t [0x10FFFF], 9);
+  QVERIFY (t.page (0x4E00) == NULL);
+}
+
+void
+TestTtFace::test_table_indices () {
+  tt_table<int> t;
+  t (0xc000000 + 3)= 1;
+  t (3)= 2;
+  QVERIFY (t.contains (0xc000000 + 3));
+  QVERIFY (!t.contains (0xc000000 + 4));
+  QCOMPARE (t [0xc000000 + 3], 1);
+  QCOMPARE (t [3], 2);
+  t (0xc00ffff)= 5;
+  QCOMPARE (t [0xc00ffff], 5);
+  QCOMPARE (t [0xc000000 + 3], 1);
+}
+
+void
+TestTtFace::test_table_far_codes () {
+  tt_table<int> t;
+  t (-5)= 1;
+  t (0x7000000)= 2;
+  t (0xc010000)= 3;
+  QVERIFY (t.contains (-5));
+  QVERIFY (!t.contains (-6));
+  QVERIFY (t.contains (0x7000000));
+  QVERIFY (t.contains (0xc010000));
+  QCOMPARE (t [-5], 1);
+  QCOMPARE (t [0x7000000], 2);
+  QCOMPARE (t [0xc010000], 3);
+}
+
+void
+TestTtFace::test_table_metrics () {
+  tt_table<metric> t;
+  for (int c=0; c<1000; c++) {
+    metric& m= t (c * 37);
+    m->x1= c;
+    m->y2= -c;
+  }
+  for (int c=0; c<1000; c++) {
+    QVERIFY (t.contains (c * 37));
+    QCOMPARE ((int) t [c * 37]->x1, c);
+    QCOMPARE ((int) t [c * 37]->y2, -c);
+  }
+}
+
+QTEST_MAIN(TestTtFace)
+#include "tt_face_test.moc"
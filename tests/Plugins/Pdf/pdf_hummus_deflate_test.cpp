@@ -0,0 +1,103 @@
+
+/******************************************************************************
+* MODULE     : pdf_hummus_deflate_test.cpp
+* DESCRIPTION: Tests for the compression of pdf streams on worker threads
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "Pdf/pdf_hummus_deflate.hpp"
+#include "zlib.h"
+#include <string>
+
+static std::string
+sample_contents (int i) {
+  std::string r;
+  for (int j=0; j < 200 + 37 * i; j++)
+    r += "q 1 0 0 1 " + std::to_string (i * j) + " 0 cm BT (x) Tj ET Q\r\n";
+  return r;
+}
+
+static std::string
+inflate_string (const char* data, size_t n, size_t expected) {
+  std::string r (expected, '\0');
+  uLongf len= (uLongf) expected;
+  if (uncompress ((Bytef*) &r[0], &len, (const Bytef*) data, (uLong) n) != Z_OK)
+    return "";
+  r.resize (len);
+  return r;
+}
+
+class TestPdfDeflate: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_round_trip_sequential ();
+  void test_round_trip_threads ();
+  void test_no_wait ();
+};
+
+static void
+check_queue (int nr_threads) {
+  pdf_deflate_queue q (nr_threads);
+  int i, n= 40, got= 0;
+  for (i=0; i<n; i++) {
+    std::string s= sample_contents (i);
+    q.submit (100 + i, s.c_str (), s.size ());
+  }
+  QCOMPARE (q.pending (), n);
+  unsigned long key;
+  const char* data;
+  size_t len;
+  bool packed;
+  while (q.retrieve (key, data, len, packed, true)) {
+    QCOMPARE (key, (unsigned long) (100 + got));
+    QVERIFY (packed);
+    std::string s= sample_contents (got);
+    QVERIFY (len > 0 && len < s.size ());
+    QVERIFY (inflate_string (data, len, s.size ()) == s);
+    got++;
+  }
+  QCOMPARE (got, n);
+  QCOMPARE (q.pending (), 0);
+
+  // the queue can be reused after it has been emptied
+  std::string s= sample_contents (3);
+  q.submit (7, s.c_str (), s.size ());
+  QVERIFY (q.retrieve (key, data, len, packed, true));
+  QVERIFY (packed);
+  QCOMPARE (key, (unsigned long) 7);
+  QVERIFY (inflate_string (data, len, s.size ()) == s);
+}
+
+void
+TestPdfDeflate::test_round_trip_sequential () {
+  check_queue (1);
+}
+
+void
+TestPdfDeflate::test_round_trip_threads () {
+  check_queue (4);
+}
+
+void
+TestPdfDeflate::test_no_wait () {
+  pdf_deflate_queue q (2);
+  unsigned long key;
+  const char* data;
+  size_t len;
+  bool packed;
+  QVERIFY (!q.retrieve (key, data, len, packed, false));
+  std::string s= sample_contents (1);
+  q.submit (1, s.c_str (), s.size ());
+  while (!q.retrieve (key, data, len, packed, false)) {}
+  QCOMPARE (key, (unsigned long) 1);
+  QCOMPARE (q.pending (), 0);
+}
+
+QTEST_MAIN(TestPdfDeflate)
+#include "pdf_hummus_deflate_test.moc"
@@ -0,0 +1,116 @@
+
+/******************************************************************************
+* MODULE     : qt_glyph_atlas_test.cpp
+* DESCRIPTION: Tests for the cache of glyph coverage masks
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "qt_glyph_atlas.hpp"
+#include "qt_renderer.hpp"
+#include "bitmap_font.hpp"
+
+static glyph
+sample_glyph (int c) {
+  int w= 10 + c % 30, h= 12 + c % 17;
+  glyph gl (w, h, 0, 0, 4);
+  for (int j=0; j<h; j++)
+    for (int i=0; i<w; i++)
+      gl->set_x (i, j, (i + j + c) % 9);
+  return gl;
+}
+
+static font_glyphs
+sample_font () {
+  static glyph* gs= NULL;
+  if (gs == NULL) {
+    gs= tm_new_array<glyph> (128);
+    for (int c=0; c<128; c++) gs[c]= sample_glyph (c);
+  }
+  return std_font_glyphs ("atlas-test", gs, 0, 127);
+}
+
+class TestQtGlyphAtlas: public QObject {
+  Q_OBJECT
+
+private slots:
+  void init () { atlas_clear (); atlas_set_budget (2 << 20); }
+  void test_insert_lookup ();
+  void test_color_independent ();
+  void test_eviction ();
+  void test_large_glyph ();
+};
+
+void
+TestQtGlyphAtlas::test_insert_lookup () {
+  font_glyphs fng;
+  atlas_start_run ();
+  qt_atlas_key xc ('a', fng, 3, 100);
+  QVERIFY (is_nil (atlas_lookup (xc)));
+  glyph gl= sample_glyph ('a');
+  qt_atlas_glyph g= atlas_insert (xc, gl, 1, 2);
+  QVERIFY (!is_nil (g));
+  QCOMPARE (g->w, gl->width);
+  QCOMPARE (g->h, gl->height);
+  QCOMPARE ((int) g->xo, 1);
+  QCOMPARE ((int) g->yo, 2);
+  qt_atlas_glyph g2= atlas_lookup (xc);
+  QVERIFY (!is_nil (g2));
+  QImage* im= atlas_sheet (g2->sheet);
+  for (int j=0; j<gl->height; j++)
+    for (int i=0; i<gl->width; i++)
+      QCOMPARE (qAlpha (im->pixel (g2->x + i, g2->y + j)),
+                (255 * gl->get_x (i, j)) / 9);
+}
+
+void
+TestQtGlyphAtlas::test_color_independent () {
+  QImage target (200, 200, QImage::Format_ARGB32_Premultiplied);
+  QPainter painter;
+#if QT_VERSION >= 0x060000
+  qt_renderer_rep ren (&painter, 1.0, 200, 200);
+#else
+  qt_renderer_rep ren (&painter, 200, 200);
+#endif
+  font_glyphs fng= sample_font ();
+  ren.begin (&target);
+  ren.set_pencil (pencil (rgb_color (255, 0, 0)));
+  ren.draw ('b', fng, 0, 0);
+  QCOMPARE (atlas_entries (), 1);
+  int mem= atlas_memory ();
+  QVERIFY (mem > 0);
+  ren.set_pencil (pencil (rgb_color (0, 0, 255)));
+  ren.draw ('b', fng, 0, 0);
+  ren.end ();
+  QCOMPARE (atlas_entries (), 1);
+  QCOMPARE (atlas_memory (), mem);
+}
+
+void
+TestQtGlyphAtlas::test_eviction () {
+  font_glyphs fng;
+  for (int c=0; c<20000; c++) {
+    atlas_start_run ();
+    qt_atlas_key xc (c, fng, 3, 100);
+    QVERIFY (!is_nil (atlas_insert (xc, sample_glyph (c), 0, 0)));
+  }
+  QVERIFY (atlas_memory () <= (2 << 20));
+  atlas_start_run ();
+  QVERIFY (is_nil (atlas_lookup (qt_atlas_key (0, fng, 3, 100))));
+  QVERIFY (!is_nil (atlas_lookup (qt_atlas_key (19999, fng, 3, 100))));
+}
+
+void
+TestQtGlyphAtlas::test_large_glyph () {
+  font_glyphs fng;
+  atlas_start_run ();
+  glyph gl (4000, 10, 0, 0, 4);
+  QVERIFY (is_nil (atlas_insert (qt_atlas_key (1, fng, 3, 100), gl, 0, 0)));
+}
+
+QTEST_MAIN(TestQtGlyphAtlas)
+#include "qt_glyph_atlas_test.moc"
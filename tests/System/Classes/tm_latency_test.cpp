@@ -0,0 +1,80 @@
+
+/******************************************************************************
+* MODULE     : tm_latency_test.cpp
+* DESCRIPTION: Tests for the histograms of key press latencies
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "tm_latency.hpp"
+#include "analyze.hpp"
+
+class TestTmLatency: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_buckets ();
+  void test_phases ();
+  void test_report ();
+};
+
+void
+TestTmLatency::test_buckets () {
+  QCOMPARE (latency_bucket (0), 0);
+  QCOMPARE (latency_bucket (7), 7);
+  QCOMPARE (latency_bucket (8), 8);
+  QCOMPARE (latency_bucket (15), 15);
+  QCOMPARE (latency_bucket (16), 16);
+  QCOMPARE (latency_bucket (17), 16);
+  QCOMPARE (latency_bucket (((DI) 1) << 40), LATENCY_BUCKETS - 1);
+  for (int i=0; i+1<LATENCY_BUCKETS; i++) {
+    DI lim= latency_bucket_limit (i);
+    QCOMPARE (latency_bucket (lim - 1), i);
+    QCOMPARE (latency_bucket (lim), i+1);
+  }
+}
+
+void
+TestTmLatency::test_phases () {
+  latency_reset ();
+  latency_key ("a");
+  latency_mark (LATENCY_MODIFY);
+  latency_key ("b");
+  latency_mark (LATENCY_MODIFY);
+  latency_mark (LATENCY_TYPESET);
+  latency_mark (LATENCY_REPAINT);
+  latency_mark (LATENCY_REPAINT);
+  latency_key ("left");
+  latency_mark (LATENCY_MODIFY);
+  latency_mark (LATENCY_REPAINT);
+  QCOMPARE (latency_count ("modify"), 2);
+  QCOMPARE (latency_count ("typeset"), 1);
+  QCOMPARE (latency_count ("repaint"), 2);
+  QCOMPARE (latency_count ("unknown"), 0);
+  QVERIFY (latency_percentile ("repaint", 0.5) >= 0.0);
+  QVERIFY (latency_percentile ("repaint", 0.99) < 1000.0);
+  array<int> h= latency_histogram ("repaint");
+  int sum= 0;
+  for (int i=0; i<N(h); i++) sum += h[i];
+  QCOMPARE (sum, 2);
+  QCOMPARE ((int) N(latency_bucket_limits ()), LATENCY_BUCKETS);
+  latency_reset ();
+  QCOMPARE (latency_count ("repaint"), 0);
+}
+
+void
+TestTmLatency::test_report () {
+  latency_reset ();
+  string r= latency_report ();
+  QVERIFY (starts (r, "phase"));
+  QVERIFY (occurs ("modify", r));
+  QVERIFY (occurs ("typeset", r));
+  QVERIFY (occurs ("repaint", r));
+}
+
+QTEST_MAIN(TestTmLatency)
+#include "tm_latency_test.moc"
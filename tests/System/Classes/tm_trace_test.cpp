@@ -0,0 +1,84 @@
+
+/******************************************************************************
+* MODULE     : tm_trace_test.cpp
+* DESCRIPTION: Tests for the trace points and the export of traces
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "tm_trace.hpp"
+#include "tm_timer.hpp"
+#include "analyze.hpp"
+
+class TestTmTrace: public QObject {
+  Q_OBJECT
+
+private slots:
+  void test_outermost ();
+  void test_events ();
+  void test_summary ();
+};
+
+static trace_point*
+find_point (const char* name) {
+  for (trace_point* p= trace_points (); p != NULL; p= p->next)
+    if (string (name) == p->name) return p;
+  return NULL;
+}
+
+static void
+recursive_span (int n) {
+  TRACE_SCOPE ("test", "recursive");
+  if (n > 0) recursive_span (n-1);
+}
+
+void
+TestTmTrace::test_outermost () {
+  recursive_span (5);
+  recursive_span (3);
+  trace_point* p= find_point ("recursive");
+  QVERIFY (p != NULL);
+  QVERIFY (p->count.load () == 2);
+  QVERIFY (p->total.load () >= 0);
+}
+
+void
+TestTmTrace::test_events () {
+  QVERIFY (!trace_busy ());
+  trace_start ();
+  QVERIFY (trace_busy ());
+  {
+    TRACE_SCOPE ("test", "outer \"quoted\"");
+    TRACE_ARG (42);
+    { TRACE_SCOPE ("test", "inner"); }
+  }
+  trace_stop ();
+  { TRACE_SCOPE ("test", "untraced"); }
+  string s= trace_events ();
+  QVERIFY (starts (s, "{\"traceEvents\":["));
+  QVERIFY (occurs ("\"name\":\"inner\",\"cat\":\"test\",\"ph\":\"X\"", s));
+  QVERIFY (occurs ("\"name\":\"outer \\\"quoted\\\"\"", s));
+  QVERIFY (occurs ("\"args\":{\"value\":42}", s));
+  QVERIFY (occurs ("\"args\":{\"name\":\"main\"}", s));
+  QVERIFY (!occurs ("untraced", s));
+  QVERIFY (ends (s, "\"displayTimeUnit\":\"ns\"}\n"));
+}
+
+void
+TestTmTrace::test_summary () {
+  recursive_span (2);
+  string s= trace_summary ();
+  QVERIFY (starts (s, "[\n{\"group\":"));
+  QVERIFY (occurs ("{\"group\":\"trace/test\",\"name\":\"recursive\","
+                   "\"metric\":\"WalltimeMilliseconds\"", s));
+  QVERIFY (ends (s, "}\n]\n"));
+  bench_reset ();
+  QCOMPARE (trace_summary (), string ("[\n]\n"));
+}
+
+QTEST_MAIN(TestTmTrace)
+#include "tm_trace_test.moc"
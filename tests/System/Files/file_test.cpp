@@ -0,0 +1,107 @@
+
+/******************************************************************************
+* MODULE     : file_test.cpp
+* DESCRIPTION: Tests for the streaming saves of TeXmacs documents
+* COPYRIGHT  : (C) 2026  the TeXmacs team
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include <QtTest/QtTest>
+#include "file.hpp"
+#include "convert.hpp"
+#include "drd_std.hpp"
+
+static tree
+sample_document () {
+  // a document of about 100kb, with lines which are longer than the
+  // chunks of the writer and with many trailing spaces and escapes
+  tree body (DOCUMENT);
+  body << tree (CONCAT, "Some text with a ",
+                tree (WITH, "font-series", "bold", "bold"), " word.");
+  body << "A line with trailing spaces   ";
+  body << "   Leading spaces, \\ backslashes, <less> and \"quotes\"";
+  body << compound ("equation", tree (CONCAT, "x", tree (RSUP, "2"), "+y"));
+  tree items (DOCUMENT);
+  for (int i=0; i<50; i++)
+    items << tree (CONCAT, compound ("item"), "Item ", as_string (i));
+  body << compound ("itemize", items);
+  string long_line;
+  for (int i=0; i<3000; i++) long_line << "word" << as_string (i % 7) << "  ";
+  body << long_line;
+  string spaces;
+  for (int i=0; i<20000; i++) spaces << ' ';
+  body << tree (CONCAT, "x", spaces, "y", spaces);
+  string raw;
+  for (int i=0; i<256; i++) raw << (char) i;
+  body << tree (RAW_DATA, raw);
+  body << compound ("verbatim", "int\n  main ()   \n{\n}\n");
+  tree tab (TABLE);
+  for (int i=0; i<5; i++) {
+    tree row (ROW);
+    for (int j=0; j<5; j++) row << tree (CELL, as_string (i * j));
+    tab << row;
+  }
+  body << compound ("tabular", tree (TFORMAT, tab));
+  body << "";
+  tree doc (DOCUMENT);
+  doc << compound ("TeXmacs", "2.1");
+  doc << compound ("style", tree (TUPLE, "generic"));
+  doc << compound ("body", body);
+  doc << compound ("initial",
+                   tree (COLLECTION, tree (ASSOCIATE, "page-medium", "paper")));
+  return doc;
+}
+
+class TestFile: public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase () { init_std_drd (); }
+  void test_tree_to_texmacs ();
+  void test_save_texmacs ();
+  void test_save_texmacs_replace ();
+};
+
+void
+TestFile::test_tree_to_texmacs () {
+  // output of the former string serializer
+  tree doc (DOCUMENT, "Trailing spaces  ",
+            tree (CONCAT, "a ", compound ("strong", "b"), " <c>\\"));
+  doc << compound ("quote-env", tree (DOCUMENT, "x", "  y")) << "";
+  QCOMPARE (tree_to_texmacs (doc),
+            string ("Trailing spaces \\ \n\n"
+                    "a <strong|b> \\<c\\>\\\\\n\n"
+                    "<\\quote-env>\n  x\n\n  \\ \\ y\n</quote-env>\n\n\\;"));
+}
+
+void
+TestFile::test_save_texmacs () {
+  tree doc= sample_document ();
+  string s= tree_to_texmacs (doc);
+  QVERIFY (N(s) > 100000);
+  url u= url_temp (".tm");
+  QVERIFY (!save_texmacs (u, doc));
+  string r;
+  QVERIFY (!load_string (u, r, false));
+  QVERIFY (r == s);
+  QVERIFY (!is_regular (url_system (concretize (u) * ".part")));
+  remove (u);
+}
+
+void
+TestFile::test_save_texmacs_replace () {
+  url u= url_temp (".tm");
+  QVERIFY (!save_texmacs (u, sample_document ()));
+  tree doc (DOCUMENT, compound ("TeXmacs", "2.1"), "A short document");
+  QVERIFY (!save_texmacs (u, doc));
+  string r;
+  QVERIFY (!load_string (u, r, false));
+  QVERIFY (r == tree_to_texmacs (doc));
+  remove (u);
+}
+
+QTEST_MAIN(TestFile)
+#include "file_test.moc"